@@ -75,10 +75,9 @@ void UMenu::OnCreateSession(bool bWasSuccessful)
 {
 	if (bWasSuccessful)
 	{
-		UWorld* World = GetWorld();
-		if (World)
+		if (MultiplayerSessionsSubsystem)
 		{
-			World->ServerTravel(PathToLobby);
+			MultiplayerSessionsSubsystem->TravelToLobby(PathToLobby);
 		}
 	}
 	else
@@ -96,46 +95,29 @@ void UMenu::OnCreateSession(bool bWasSuccessful)
 	}
 }
 
-void UMenu::OnFindSessions(const TArray<FOnlineSessionSearchResult>& SessionResults, bool bWasSuccessful)
+void UMenu::OnFindSessions(TArrayView<const FOnlineSessionSearchResult> SessionResults, bool bWasSuccessful)
 {
 	if (MultiplayerSessionsSubsystem == nullptr)
 	{
 		return;
 	}
 
-	for (auto Result : SessionResults)
+	// The subsystem only hands us sessions of our match type
+	if (bWasSuccessful && SessionResults.Num() > 0)
 	{
-		FString SettingsValue;
-		Result.Session.SessionSettings.Get(FName("MatchType"), SettingsValue);
-		if (SettingsValue == MatchType)
-		{
-			MultiplayerSessionsSubsystem->JoinSession(Result);
-			return;
-		}
-	}
-	if (!bWasSuccessful || SessionResults.Num() == 0)
-	{
-		JoinButton->SetIsEnabled(true);
+		MultiplayerSessionsSubsystem->JoinSession(SessionResults[0]);
+		return;
 	}
+
+	JoinButton->SetIsEnabled(true);
 }
 
 void UMenu::OnJoinSession(EOnJoinSessionCompleteResult::Type Result)
 {
-	IOnlineSubsystem* Subsystem = IOnlineSubsystem::Get();
-	if (Subsystem)
+	// The subsystem resolves the address and travels, timing both
+	if (Result != EOnJoinSessionCompleteResult::Success || MultiplayerSessionsSubsystem == nullptr || !MultiplayerSessionsSubsystem->TravelToJoinedSession())
 	{
-		IOnlineSessionPtr SessionInterface = Subsystem->GetSessionInterface();
-		if (SessionInterface.IsValid())
-		{
-			FString Address;
-			SessionInterface->GetResolvedConnectString(NAME_GameSession, Address);
-
-			APlayerController* PlayerController = GetGameInstance()->GetFirstLocalPlayerController();
-			if (PlayerController)
-			{
-				PlayerController->ClientTravel(Address, ETravelType::TRAVEL_Absolute);
-			}
-		}
+		JoinButton->SetIsEnabled(true);
 	}
 }
 
@@ -161,7 +143,7 @@ void UMenu::JoinButtonClicked()
 	JoinButton->SetIsEnabled(false);
 	if (MultiplayerSessionsSubsystem)
 	{
-		MultiplayerSessionsSubsystem->FindSessions(10000);
+		MultiplayerSessionsSubsystem->FindSessions(10000, MatchType);
 	}
 }
 
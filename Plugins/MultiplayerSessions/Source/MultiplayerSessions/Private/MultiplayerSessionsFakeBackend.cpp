@@ -0,0 +1,654 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsFakeBackend.h"
+#include "MultiplayerSessions.h"
+
+static const FName FakeHostIdSettingName(TEXT("FakeHostId"));
+
+//
+// Backend
+//
+
+FMultiplayerSessionsFakeBackend::FMultiplayerSessionsFakeBackend(const FMultiplayerSessionsFakeBackendSettings& InSettings) :
+	Settings(InSettings),
+	Random(InSettings.RandomSeed)
+{
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FMultiplayerSessionsFakeBackend::Tick));
+}
+
+FMultiplayerSessionsFakeBackend::~FMultiplayerSessionsFakeBackend()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+}
+
+TSharedRef<FMultiplayerSessionsFakeBackend> FMultiplayerSessionsFakeBackend::GetShared()
+{
+	// Lives as long as some game instance still uses it
+	static TWeakPtr<FMultiplayerSessionsFakeBackend> SharedBackend;
+
+	TSharedPtr<FMultiplayerSessionsFakeBackend> Backend = SharedBackend.Pin();
+	if (!Backend.IsValid())
+	{
+		Backend = MakeShared<FMultiplayerSessionsFakeBackend>();
+		SharedBackend = Backend;
+	}
+	return Backend.ToSharedRef();
+}
+
+void FMultiplayerSessionsFakeBackend::Schedule(TFunction<void(bool bWasSuccessful)>&& Completion)
+{
+	const float LatencyMs = Random.FRandRange(Settings.MinLatencyMs, FMath::Max(Settings.MinLatencyMs, Settings.MaxLatencyMs));
+
+	FPendingRequest& Request = PendingRequests.AddDefaulted_GetRef();
+	Request.DueTime = FPlatformTime::Seconds() + LatencyMs / 1000.0;
+	Request.bSucceeds = Random.FRand() >= Settings.FailureRate;
+	Request.Completion = MoveTemp(Completion);
+}
+
+bool FMultiplayerSessionsFakeBackend::Tick(float DeltaTime)
+{
+	// A completion may release the last session, and with it the last reference to us
+	const TSharedRef<FMultiplayerSessionsFakeBackend> KeepAlive = AsShared();
+
+	const double Now = FPlatformTime::Seconds();
+
+	// Completions usually send the next request, so take the due ones out before running any
+	TArray<FPendingRequest> DueRequests;
+	for (int32 i = PendingRequests.Num() - 1; i >= 0; --i)
+	{
+		if (PendingRequests[i].DueTime <= Now)
+		{
+			DueRequests.Add(MoveTemp(PendingRequests[i]));
+			PendingRequests.RemoveAtSwap(i, EAllowShrinking::No);
+		}
+	}
+
+	// In the order they were due, like a service answering
+	DueRequests.Sort([](const FPendingRequest& A, const FPendingRequest& B) { return A.DueTime < B.DueTime; });
+
+	for (FPendingRequest& Request : DueRequests)
+	{
+		Request.Completion(Request.bSucceeds);
+	}
+	return true;
+}
+
+int32 FMultiplayerSessionsFakeBackend::AdvertiseSession(FOnlineSessionSettings& SessionSettings)
+{
+	const int32 HostId = NextHostId++;
+
+	// Stamped on the host's own settings too, so it can take the session down again
+	SessionSettings.Set(FakeHostIdSettingName, HostId, EOnlineDataAdvertisementType::ViaOnlineService);
+
+	FAdvertisedSession& Session = AdvertisedSessions.Add(HostId);
+	Session.Settings = SessionSettings;
+	Session.OpenSlots = SessionSettings.NumPublicConnections;
+	return HostId;
+}
+
+void FMultiplayerSessionsFakeBackend::RemoveSession(int32 HostId)
+{
+	AdvertisedSessions.Remove(HostId);
+}
+
+EOnJoinSessionCompleteResult::Type FMultiplayerSessionsFakeBackend::ClaimSlot(int32 HostId)
+{
+	FAdvertisedSession* Session = AdvertisedSessions.Find(HostId);
+	if (Session == nullptr)
+	{
+		return EOnJoinSessionCompleteResult::SessionDoesNotExist;
+	}
+	if (Session->OpenSlots <= 0)
+	{
+		return EOnJoinSessionCompleteResult::SessionIsFull;
+	}
+
+	--Session->OpenSlots;
+	return EOnJoinSessionCompleteResult::Success;
+}
+
+void FMultiplayerSessionsFakeBackend::ReleaseSlot(int32 HostId)
+{
+	if (FAdvertisedSession* Session = AdvertisedSessions.Find(HostId))
+	{
+		Session->OpenSlots = FMath::Min(Session->OpenSlots + 1, Session->Settings.NumPublicConnections);
+	}
+}
+
+void FMultiplayerSessionsFakeBackend::Search(const FOnlineSessionSearch& SearchSettings, TArray<FOnlineSessionSearchResult>& OutResults) const
+{
+	for (const TPair<int32, FAdvertisedSession>& Entry : AdvertisedSessions)
+	{
+		if (OutResults.Num() >= SearchSettings.MaxSearchResults)
+		{
+			break;
+		}
+
+		const FAdvertisedSession& Session = Entry.Value;
+		if (Session.OpenSlots <= 0)
+		{
+			continue;
+		}
+
+		// Query settings the session doesn't carry, like SEARCH_LOBBIES, only pick the kind of search on a real service
+		bool bMatches = true;
+		for (const TPair<FName, FOnlineSessionSearchParam>& Param : SearchSettings.QuerySettings.SearchParams)
+		{
+			const FOnlineSessionSetting* Setting = Session.Settings.Settings.Find(Param.Key);
+			if (Setting && Param.Value.ComparisonOp == EOnlineComparisonOp::Equals && !(Setting->Data == Param.Value.Data))
+			{
+				bMatches = false;
+				break;
+			}
+		}
+
+		if (bMatches)
+		{
+			FOnlineSessionSearchResult& Result = OutResults.AddDefaulted_GetRef();
+			Result.Session.SessionSettings = Session.Settings;
+			Result.Session.NumOpenPublicConnections = Session.OpenSlots;
+			Result.Session.OwningUserName = FString::Printf(TEXT("FakeHost%d"), Entry.Key);
+			Result.PingInMs = FMath::RoundToInt32(Settings.MinLatencyMs);
+		}
+	}
+}
+
+int32 FMultiplayerSessionsFakeBackend::GetHostId(const FOnlineSessionSettings& SessionSettings)
+{
+	int32 HostId = 0;
+	SessionSettings.Get(FakeHostIdSettingName, HostId);
+	return HostId;
+}
+
+//
+// Session interface
+//
+
+FMultiplayerSessionsFakeOnlineSession::FMultiplayerSessionsFakeOnlineSession(const TSharedRef<FMultiplayerSessionsFakeBackend>& InBackend) :
+	Backend(InBackend)
+{
+}
+
+FMultiplayerSessionsFakeOnlineSession::~FMultiplayerSessionsFakeOnlineSession()
+{
+	// Sessions of a player that went away stop being advertised
+	for (const TUniquePtr<FNamedOnlineSession>& Session : Sessions)
+	{
+		const int32 HostId = FMultiplayerSessionsFakeBackend::GetHostId(Session->SessionSettings);
+		if (Session->bHosting)
+		{
+			Backend->RemoveSession(HostId);
+		}
+		else
+		{
+			Backend->ReleaseSlot(HostId);
+		}
+	}
+}
+
+int32 FMultiplayerSessionsFakeOnlineSession::GetNumBoundDelegates() const
+{
+	return (OnCreateSessionCompleteDelegates.IsBound() ? 1 : 0) +
+		(OnStartSessionCompleteDelegates.IsBound() ? 1 : 0) +
+		(OnEndSessionCompleteDelegates.IsBound() ? 1 : 0) +
+		(OnDestroySessionCompleteDelegates.IsBound() ? 1 : 0) +
+		(OnFindSessionsCompleteDelegates.IsBound() ? 1 : 0) +
+		(OnJoinSessionCompleteDelegates.IsBound() ? 1 : 0);
+}
+
+FNamedOnlineSession* FMultiplayerSessionsFakeOnlineSession::AddNamedSession(FName SessionName, const FOnlineSessionSettings& SessionSettings)
+{
+	return Sessions.Add_GetRef(MakeUnique<FNamedOnlineSession>(SessionName, SessionSettings)).Get();
+}
+
+FNamedOnlineSession* FMultiplayerSessionsFakeOnlineSession::AddNamedSession(FName SessionName, const FOnlineSession& Session)
+{
+	return Sessions.Add_GetRef(MakeUnique<FNamedOnlineSession>(SessionName, Session)).Get();
+}
+
+FUniqueNetIdPtr FMultiplayerSessionsFakeOnlineSession::CreateSessionIdFromString(const FString& SessionIdStr)
+{
+	return nullptr;
+}
+
+FNamedOnlineSession* FMultiplayerSessionsFakeOnlineSession::GetNamedSession(FName SessionName)
+{
+	for (const TUniquePtr<FNamedOnlineSession>& Session : Sessions)
+	{
+		if (Session->SessionName == SessionName)
+		{
+			return Session.Get();
+		}
+	}
+	return nullptr;
+}
+
+void FMultiplayerSessionsFakeOnlineSession::RemoveNamedSession(FName SessionName)
+{
+	Sessions.RemoveAll([SessionName](const TUniquePtr<FNamedOnlineSession>& Session) { return Session->SessionName == SessionName; });
+}
+
+EOnlineSessionState::Type FMultiplayerSessionsFakeOnlineSession::GetSessionState(FName SessionName) const
+{
+	for (const TUniquePtr<FNamedOnlineSession>& Session : Sessions)
+	{
+		if (Session->SessionName == SessionName)
+		{
+			return Session->SessionState;
+		}
+	}
+	return EOnlineSessionState::NoSession;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::HasPresenceSession()
+{
+	return Sessions.ContainsByPredicate([](const TUniquePtr<FNamedOnlineSession>& Session) { return Session->SessionSettings.bUsesPresence; });
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::CreateSession(int32 HostingPlayerNum, FName SessionName, const FOnlineSessionSettings& NewSessionSettings)
+{
+	if (GetNamedSession(SessionName) != nullptr)
+	{
+		UE_LOG(LogMultiplayerSessions, Warning, TEXT("Fake backend: can't create %s, it already exists"), *SessionName.ToString());
+		return false;
+	}
+
+	FNamedOnlineSession* Session = AddNamedSession(SessionName, NewSessionSettings);
+	Session->SessionState = EOnlineSessionState::Creating;
+	Session->bHosting = true;
+	Session->HostingPlayerNum = HostingPlayerNum;
+	Session->NumOpenPublicConnections = NewSessionSettings.NumPublicConnections;
+
+	Backend->Schedule([WeakThis = TWeakPtr<FMultiplayerSessionsFakeOnlineSession>(AsShared()), SessionName](bool bWasSuccessful)
+	{
+		TSharedPtr<FMultiplayerSessionsFakeOnlineSession> This = WeakThis.Pin();
+		if (!This.IsValid())
+		{
+			return;
+		}
+
+		FNamedOnlineSession* Session = This->GetNamedSession(SessionName);
+		if (Session == nullptr)
+		{
+			This->TriggerOnCreateSessionCompleteDelegates(SessionName, false);
+			return;
+		}
+
+		if (bWasSuccessful)
+		{
+			Session->SessionState = EOnlineSessionState::Pending;
+			if (Session->SessionSettings.bShouldAdvertise)
+			{
+				This->Backend->AdvertiseSession(Session->SessionSettings);
+			}
+		}
+		else
+		{
+			This->RemoveNamedSession(SessionName);
+		}
+
+		This->TriggerOnCreateSessionCompleteDelegates(SessionName, bWasSuccessful);
+	});
+	return true;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::CreateSession(const FUniqueNetId& HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings)
+{
+	return CreateSession(0, SessionName, NewSessionSettings);
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::StartSession(FName SessionName)
+{
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	if (Session == nullptr || (Session->SessionState != EOnlineSessionState::Pending && Session->SessionState != EOnlineSessionState::Ended))
+	{
+		return false;
+	}
+
+	const EOnlineSessionState::Type PreviousState = Session->SessionState;
+	Session->SessionState = EOnlineSessionState::Starting;
+
+	Backend->Schedule([WeakThis = TWeakPtr<FMultiplayerSessionsFakeOnlineSession>(AsShared()), SessionName, PreviousState](bool bWasSuccessful)
+	{
+		TSharedPtr<FMultiplayerSessionsFakeOnlineSession> This = WeakThis.Pin();
+		if (!This.IsValid())
+		{
+			return;
+		}
+
+		FNamedOnlineSession* Session = This->GetNamedSession(SessionName);
+		if (Session && Session->SessionState == EOnlineSessionState::Starting)
+		{
+			Session->SessionState = bWasSuccessful ? EOnlineSessionState::InProgress : PreviousState;
+		}
+
+		This->TriggerOnStartSessionCompleteDelegates(SessionName, bWasSuccessful && Session != nullptr);
+	});
+	return true;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::EndSession(FName SessionName)
+{
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	if (Session == nullptr || Session->SessionState != EOnlineSessionState::InProgress)
+	{
+		return false;
+	}
+
+	Session->SessionState = EOnlineSessionState::Ending;
+
+	Backend->Schedule([WeakThis = TWeakPtr<FMultiplayerSessionsFakeOnlineSession>(AsShared()), SessionName](bool bWasSuccessful)
+	{
+		TSharedPtr<FMultiplayerSessionsFakeOnlineSession> This = WeakThis.Pin();
+		if (!This.IsValid())
+		{
+			return;
+		}
+
+		FNamedOnlineSession* Session = This->GetNamedSession(SessionName);
+		if (Session && Session->SessionState == EOnlineSessionState::Ending)
+		{
+			Session->SessionState = bWasSuccessful ? EOnlineSessionState::Ended : EOnlineSessionState::InProgress;
+		}
+
+		This->TriggerOnEndSessionCompleteDelegates(SessionName, bWasSuccessful && Session != nullptr);
+	});
+	return true;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::DestroySession(FName SessionName, const FOnDestroySessionCompleteDelegate& CompletionDelegate)
+{
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	if (Session == nullptr || Session->SessionState == EOnlineSessionState::Destroying)
+	{
+		return false;
+	}
+
+	const EOnlineSessionState::Type PreviousState = Session->SessionState;
+	Session->SessionState = EOnlineSessionState::Destroying;
+
+	Backend->Schedule([WeakThis = TWeakPtr<FMultiplayerSessionsFakeOnlineSession>(AsShared()), SessionName, PreviousState, CompletionDelegate](bool bWasSuccessful)
+	{
+		TSharedPtr<FMultiplayerSessionsFakeOnlineSession> This = WeakThis.Pin();
+		if (!This.IsValid())
+		{
+			return;
+		}
+
+		if (FNamedOnlineSession* Session = This->GetNamedSession(SessionName))
+		{
+			if (bWasSuccessful)
+			{
+				const int32 HostId = FMultiplayerSessionsFakeBackend::GetHostId(Session->SessionSettings);
+				if (Session->bHosting)
+				{
+					This->Backend->RemoveSession(HostId);
+				}
+				else
+				{
+					This->Backend->ReleaseSlot(HostId);
+				}
+				This->RemoveNamedSession(SessionName);
+			}
+			else
+			{
+				Session->SessionState = PreviousState;
+			}
+		}
+
+		CompletionDelegate.ExecuteIfBound(SessionName, bWasSuccessful);
+		This->TriggerOnDestroySessionCompleteDelegates(SessionName, bWasSuccessful);
+	});
+	return true;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::IsPlayerInSession(FName SessionName, const FUniqueNetId& UniqueId)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::StartMatchmaking(const TArray<FUniqueNetIdRef>& LocalPlayers, FName SessionName, const FOnlineSessionSettings& NewSessionSettings, TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::CancelMatchmaking(int32 SearchingPlayerNum, FName SessionName)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::CancelMatchmaking(const FUniqueNetId& SearchingPlayerId, FName SessionName)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::FindSessions(int32 SearchingPlayerNum, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	if (CurrentSessionSearch.IsValid())
+	{
+		UE_LOG(LogMultiplayerSessions, Warning, TEXT("Fake backend: ignoring a search while another is in progress"));
+		return false;
+	}
+
+	CurrentSessionSearch = SearchSettings;
+	SearchSettings->SearchResults.Reset();
+	SearchSettings->SearchState = EOnlineAsyncTaskState::InProgress;
+
+	Backend->Schedule([WeakThis = TWeakPtr<FMultiplayerSessionsFakeOnlineSession>(AsShared()), SearchSettings](bool bWasSuccessful)
+	{
+		TSharedPtr<FMultiplayerSessionsFakeOnlineSession> This = WeakThis.Pin();
+
+		// Cancelled searches don't complete
+		if (!This.IsValid() || This->CurrentSessionSearch != SearchSettings)
+		{
+			return;
+		}
+
+		This->CurrentSessionSearch.Reset();
+
+		if (bWasSuccessful)
+		{
+			This->Backend->Search(*SearchSettings, SearchSettings->SearchResults);
+		}
+		SearchSettings->SearchState = bWasSuccessful ? EOnlineAsyncTaskState::Done : EOnlineAsyncTaskState::Failed;
+
+		This->TriggerOnFindSessionsCompleteDelegates(bWasSuccessful);
+	});
+	return true;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::FindSessions(const FUniqueNetId& SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	return FindSessions(0, SearchSettings);
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::FindSessionById(const FUniqueNetId& SearchingUserId, const FUniqueNetId& SessionId, const FUniqueNetId& FriendId, const FOnSingleSessionResultCompleteDelegate& CompletionDelegate)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::CancelFindSessions()
+{
+	if (!CurrentSessionSearch.IsValid())
+	{
+		return false;
+	}
+
+	CurrentSessionSearch->SearchState = EOnlineAsyncTaskState::Failed;
+	CurrentSessionSearch.Reset();
+
+	TriggerOnCancelFindSessionsCompleteDelegates(true);
+	return true;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::PingSearchResults(const FOnlineSessionSearchResult& SearchResult)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::JoinSession(int32 LocalUserNum, FName SessionName, const FOnlineSessionSearchResult& DesiredSession)
+{
+	if (GetNamedSession(SessionName) != nullptr)
+	{
+		UE_LOG(LogMultiplayerSessions, Warning, TEXT("Fake backend: can't join into %s, it already exists"), *SessionName.ToString());
+		return false;
+	}
+
+	FNamedOnlineSession* Session = AddNamedSession(SessionName, DesiredSession.Session);
+	Session->SessionState = EOnlineSessionState::Creating;
+	Session->bHosting = false;
+	Session->HostingPlayerNum = LocalUserNum;
+
+	Backend->Schedule([WeakThis = TWeakPtr<FMultiplayerSessionsFakeOnlineSession>(AsShared()), SessionName](bool bWasSuccessful)
+	{
+		TSharedPtr<FMultiplayerSessionsFakeOnlineSession> This = WeakThis.Pin();
+		if (!This.IsValid())
+		{
+			return;
+		}
+
+		FNamedOnlineSession* Session = This->GetNamedSession(SessionName);
+
+		EOnJoinSessionCompleteResult::Type Result = EOnJoinSessionCompleteResult::UnknownError;
+		if (Session && bWasSuccessful)
+		{
+			Result = This->Backend->ClaimSlot(FMultiplayerSessionsFakeBackend::GetHostId(Session->SessionSettings));
+		}
+
+		if (Result == EOnJoinSessionCompleteResult::Success)
+		{
+			Session->SessionState = EOnlineSessionState::Pending;
+		}
+		else
+		{
+			This->RemoveNamedSession(SessionName);
+		}
+
+		This->TriggerOnJoinSessionCompleteDelegates(SessionName, Result);
+	});
+	return true;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::JoinSession(const FUniqueNetId& LocalUserId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession)
+{
+	return JoinSession(0, SessionName, DesiredSession);
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::FindFriendSession(int32 LocalUserNum, const FUniqueNetId& Friend)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::FindFriendSession(const FUniqueNetId& LocalUserId, const FUniqueNetId& Friend)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::FindFriendSession(const FUniqueNetId& LocalUserId, const TArray<FUniqueNetIdRef>& FriendList)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::SendSessionInviteToFriend(int32 LocalUserNum, FName SessionName, const FUniqueNetId& Friend)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::SendSessionInviteToFriend(const FUniqueNetId& LocalUserId, FName SessionName, const FUniqueNetId& Friend)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::SendSessionInviteToFriends(int32 LocalUserNum, FName SessionName, const TArray<FUniqueNetIdRef>& Friends)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::SendSessionInviteToFriends(const FUniqueNetId& LocalUserId, FName SessionName, const TArray<FUniqueNetIdRef>& Friends)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::GetResolvedConnectString(FName SessionName, FString& ConnectInfo, FName PortType)
+{
+	// Every fake host runs in this process or on this machine
+	if (GetNamedSession(SessionName) == nullptr)
+	{
+		return false;
+	}
+
+	ConnectInfo = TEXT("127.0.0.1");
+	return true;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo)
+{
+	if (FMultiplayerSessionsFakeBackend::GetHostId(SearchResult.Session.SessionSettings) == 0)
+	{
+		return false;
+	}
+
+	ConnectInfo = TEXT("127.0.0.1");
+	return true;
+}
+
+FOnlineSessionSettings* FMultiplayerSessionsFakeOnlineSession::GetSessionSettings(FName SessionName)
+{
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	return Session ? &Session->SessionSettings : nullptr;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::RegisterPlayer(FName SessionName, const FUniqueNetId& PlayerId, bool bWasInvited)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::RegisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasInvited)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::UnregisterPlayer(FName SessionName, const FUniqueNetId& PlayerId)
+{
+	return false;
+}
+
+bool FMultiplayerSessionsFakeOnlineSession::UnregisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players)
+{
+	return false;
+}
+
+void FMultiplayerSessionsFakeOnlineSession::RegisterLocalPlayer(const FUniqueNetId& PlayerId, FName SessionName, const FOnRegisterLocalPlayerCompleteDelegate& Delegate)
+{
+	Delegate.ExecuteIfBound(PlayerId, EOnJoinSessionCompleteResult::Success);
+}
+
+void FMultiplayerSessionsFakeOnlineSession::UnregisterLocalPlayer(const FUniqueNetId& PlayerId, FName SessionName, const FOnUnregisterLocalPlayerCompleteDelegate& Delegate)
+{
+	Delegate.ExecuteIfBound(PlayerId, true);
+}
+
+void FMultiplayerSessionsFakeOnlineSession::RemovePlayerFromSession(int32 LocalUserNum, FName SessionName, const FUniqueNetId& TargetPlayerId)
+{
+}
+
+int32 FMultiplayerSessionsFakeOnlineSession::GetNumSessions()
+{
+	return Sessions.Num();
+}
+
+void FMultiplayerSessionsFakeOnlineSession::DumpSessionState()
+{
+	for (const TUniquePtr<FNamedOnlineSession>& Session : Sessions)
+	{
+		UE_LOG(LogMultiplayerSessions, Display, TEXT("Fake backend: %s %s, host id %d, %s"),
+			*Session->SessionName.ToString(), EOnlineSessionState::ToString(Session->SessionState),
+			FMultiplayerSessionsFakeBackend::GetHostId(Session->SessionSettings), Session->bHosting ? TEXT("hosting") : TEXT("joined"));
+	}
+}
@@ -0,0 +1,397 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsLoadTest.h"
+#include "MultiplayerSessionsSubsystem.h"
+#include "MultiplayerSessionsFakeBackend.h"
+#include "Engine/GameInstance.h"
+#include "Subsystems/SubsystemCollection.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/GCObject.h"
+#include "MultiplayerSessions.h"
+
+static const FString LoadTestMatchType(TEXT("LoadTest"));
+static constexpr int32 LoadTestPublicConnections = 4;
+static constexpr int32 LoadTestMaxAttempts = 20;
+static constexpr double LoadTestRetryDelay = 0.1;
+
+void UMultiplayerSessionsLoadTestClient::Setup(const TSharedRef<FMultiplayerSessionsFakeBackend>& Backend, bool bInHost, float InDuplicateRequestRate)
+{
+	bHost = bInHost;
+	DuplicateRequestRate = InDuplicateRequestRate;
+
+	// Every client gets its own stream off the seeded backend, so a run can be replayed
+	Random.Initialize(Backend->GetRandom().GetUnsignedInt());
+
+	// Subsystems only live inside a game instance. This one never gets a world or a local player
+	UGameInstance* GameInstance = NewObject<UGameInstance>(this);
+	Subsystem = NewObject<UMultiplayerSessionsSubsystem>(GameInstance);
+
+	FakeSession = MakeShared<FMultiplayerSessionsFakeOnlineSession>(Backend);
+	Subsystem->SetSessionInterfaceOverride(FakeSession);
+
+	// Go through the same Initialize and Deinitialize as a real game instance would
+	FSubsystemCollection<UGameInstanceSubsystem> Collection;
+	Subsystem->Initialize(Collection);
+
+	Subsystem->MultiplayerOnCreateSessionComplete.AddDynamic(this, &ThisClass::OnCreateSession);
+	Subsystem->MultiplayerOnStartSessionComplete.AddDynamic(this, &ThisClass::OnStartSession);
+	Subsystem->MultiplayerOnDestroySessionComplete.AddDynamic(this, &ThisClass::OnDestroySession);
+	Subsystem->MultiplayerOnFindSessionsComplete.AddUObject(this, &ThisClass::OnFindSessions);
+	Subsystem->MultiplayerOnJoinSessionComplete.AddUObject(this, &ThisClass::OnJoinSession);
+}
+
+void UMultiplayerSessionsLoadTestClient::Begin()
+{
+	StartTime = FPlatformTime::Seconds();
+	NumAttempts = 1;
+
+	if (bHost)
+	{
+		Subsystem->CreateSession(LoadTestPublicConnections, LoadTestMatchType);
+	}
+	else
+	{
+		FindSessions();
+	}
+}
+
+void UMultiplayerSessionsLoadTestClient::Retry(double Now)
+{
+	if (RetryTime < 0.0 || Now < RetryTime)
+	{
+		return;
+	}
+
+	RetryTime = -1.0;
+
+	if (NumAttempts >= LoadTestMaxAttempts)
+	{
+		Finish(false);
+		return;
+	}
+
+	++NumAttempts;
+
+	if (!bHost)
+	{
+		FindSessions();
+	}
+	else if (Subsystem->GetSessionState() == EMultiplayerSessionState::Pending)
+	{
+		Subsystem->StartSession();
+	}
+	else
+	{
+		Subsystem->CreateSession(LoadTestPublicConnections, LoadTestMatchType);
+	}
+}
+
+void UMultiplayerSessionsLoadTestClient::TearDown()
+{
+	Subsystem->DestroySession();
+}
+
+void UMultiplayerSessionsLoadTestClient::Deinitialize()
+{
+	if (!bDeinitialized)
+	{
+		bDeinitialized = true;
+		Subsystem->Deinitialize();
+	}
+}
+
+void UMultiplayerSessionsLoadTestClient::FindSessions()
+{
+	// Whatever was cached is what we failed to join last time
+	Subsystem->InvalidateSessionResultsCache();
+	Subsystem->FindSessions(50, LoadTestMatchType);
+
+	if (Random.FRand() < DuplicateRequestRate)
+	{
+		Subsystem->FindSessions(50, LoadTestMatchType);
+	}
+}
+
+void UMultiplayerSessionsLoadTestClient::Finish(bool bWasSuccessful)
+{
+	bDone = true;
+	bSucceeded = bWasSuccessful;
+	FinishTime = FPlatformTime::Seconds();
+}
+
+void UMultiplayerSessionsLoadTestClient::OnCreateSession(bool bWasSuccessful)
+{
+	if (bWasSuccessful)
+	{
+		Subsystem->StartSession();
+	}
+	else
+	{
+		RetryTime = FPlatformTime::Seconds() + LoadTestRetryDelay;
+	}
+}
+
+void UMultiplayerSessionsLoadTestClient::OnStartSession(bool bWasSuccessful)
+{
+	if (bWasSuccessful)
+	{
+		Finish(true);
+	}
+	else
+	{
+		RetryTime = FPlatformTime::Seconds() + LoadTestRetryDelay;
+	}
+}
+
+void UMultiplayerSessionsLoadTestClient::OnDestroySession(bool bWasSuccessful)
+{
+	// Keep trying while there's still a session to take down
+	if (!bWasSuccessful && FakeSession->GetNumSessions() > 0 && ++NumTearDownAttempts < LoadTestMaxAttempts)
+	{
+		Subsystem->DestroySession();
+		return;
+	}
+
+	bTornDown = true;
+}
+
+void UMultiplayerSessionsLoadTestClient::OnFindSessions(TArrayView<const FOnlineSessionSearchResult> SessionResults, bool bWasSuccessful)
+{
+	if (bDone)
+	{
+		return;
+	}
+
+	if (SessionResults.Num() > 0)
+	{
+		// Spread out over the sessions, instead of everyone queuing for the first one
+		Subsystem->JoinSession(SessionResults[Random.RandHelper(SessionResults.Num())]);
+	}
+	else
+	{
+		RetryTime = FPlatformTime::Seconds() + LoadTestRetryDelay;
+	}
+}
+
+void UMultiplayerSessionsLoadTestClient::OnJoinSession(EOnJoinSessionCompleteResult::Type Result)
+{
+	if (Result == EOnJoinSessionCompleteResult::Success)
+	{
+		Finish(true);
+	}
+	else
+	{
+		RetryTime = FPlatformTime::Seconds() + LoadTestRetryDelay;
+	}
+}
+
+//
+// Runs every simulated player to completion, then tears all sessions down and reports
+//
+class FMultiplayerSessionsLoadTest : public FGCObject
+{
+public:
+	FMultiplayerSessionsLoadTest(int32 NumHosts, int32 NumJoiners, const FMultiplayerSessionsFakeBackendSettings& Settings, float DuplicateRequestRate, double InTimeout) :
+		Backend(MakeShared<FMultiplayerSessionsFakeBackend>(Settings)),
+		Timeout(InTimeout)
+	{
+		for (int32 i = 0; i < NumHosts + NumJoiners; ++i)
+		{
+			UMultiplayerSessionsLoadTestClient* Client = NewObject<UMultiplayerSessionsLoadTestClient>();
+			Client->Setup(Backend, i < NumHosts, DuplicateRequestRate);
+			Clients.Add(Client);
+		}
+
+		// Joiners start right away too, and keep searching until the hosts are up
+		StartTime = FPlatformTime::Seconds();
+		for (UMultiplayerSessionsLoadTestClient* Client : Clients)
+		{
+			Client->Begin();
+		}
+	}
+
+	virtual ~FMultiplayerSessionsLoadTest()
+	{
+		// Let the backend go now rather than when the subsystems are collected
+		for (UMultiplayerSessionsLoadTestClient* Client : Clients)
+		{
+			Client->Deinitialize();
+			Client->Subsystem->SetSessionInterfaceOverride(nullptr);
+			Client->FakeSession.Reset();
+		}
+	}
+
+	// Returns false once the report is out
+	bool Tick(float DeltaTime)
+	{
+		const double Now = FPlatformTime::Seconds();
+
+		if (TearDownTime < 0.0)
+		{
+			bool bAllDone = true;
+			for (UMultiplayerSessionsLoadTestClient* Client : Clients)
+			{
+				Client->Retry(Now);
+				bAllDone &= Client->bDone;
+			}
+
+			if (!bAllDone && Now - StartTime < Timeout)
+			{
+				return true;
+			}
+
+			TearDownTime = Now;
+			for (UMultiplayerSessionsLoadTestClient* Client : Clients)
+			{
+				Client->TearDown();
+			}
+			return true;
+		}
+
+		const bool bAllTornDown = !Clients.ContainsByPredicate([](const UMultiplayerSessionsLoadTestClient* Client) { return !Client->bTornDown; });
+		if ((!bAllTornDown || Backend->GetNumPendingRequests() > 0) && Now - TearDownTime < Timeout)
+		{
+			return true;
+		}
+
+		// The leak check below is only worth something if it runs after the subsystems' own cleanup
+		for (UMultiplayerSessionsLoadTestClient* Client : Clients)
+		{
+			Client->Deinitialize();
+		}
+
+		Report();
+		return false;
+	}
+
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override
+	{
+		Collector.AddReferencedObjects(Clients);
+	}
+
+	virtual FString GetReferencerName() const override
+	{
+		return TEXT("FMultiplayerSessionsLoadTest");
+	}
+
+private:
+	static double GetPercentile(const TArray<double>& SortedMs, double Percentile)
+	{
+		if (SortedMs.Num() == 0)
+		{
+			return 0.0;
+		}
+		return SortedMs[FMath::Clamp(FMath::CeilToInt32(Percentile * SortedMs.Num()) - 1, 0, SortedMs.Num() - 1)];
+	}
+
+	void Report() const
+	{
+		TArray<double> HostMs;
+		TArray<double> JoinMs;
+		int32 NumHosts = 0;
+		int32 NumAttempts = 0;
+		int32 NumLeakedDelegates = 0;
+		int32 NumLeftoverSessions = 0;
+		FMultiplayerSessionsLatencyHistogram PhaseLatency[static_cast<int32>(EMultiplayerSessionPhase::Count)];
+
+		for (const UMultiplayerSessionsLoadTestClient* Client : Clients)
+		{
+			NumHosts += Client->bHost ? 1 : 0;
+			NumAttempts += Client->bHost ? 0 : Client->NumAttempts;
+
+			if (Client->bSucceeded)
+			{
+				(Client->bHost ? HostMs : JoinMs).Add((Client->FinishTime - Client->StartTime) * 1000.0);
+			}
+
+			NumLeakedDelegates += Client->FakeSession->GetNumBoundDelegates();
+			NumLeftoverSessions += Client->FakeSession->GetNumSessions();
+
+			for (int32 PhaseIndex = 0; PhaseIndex < static_cast<int32>(EMultiplayerSessionPhase::Count); ++PhaseIndex)
+			{
+				PhaseLatency[PhaseIndex].Append(Client->Subsystem->GetPhaseLatency(static_cast<EMultiplayerSessionPhase>(PhaseIndex)));
+			}
+		}
+
+		HostMs.Sort();
+		JoinMs.Sort();
+
+		const int32 NumJoiners = Clients.Num() - NumHosts;
+		const double FlowSeconds = FMath::Max(TearDownTime - StartTime, UE_DOUBLE_SMALL_NUMBER);
+
+		UE_LOG(LogMultiplayerSessions, Display, TEXT("Load test: %d/%d hosts up, %d/%d joiners in (%d searches) in %.2f s, %.1f players/s"),
+			HostMs.Num(), NumHosts, JoinMs.Num(), NumJoiners, NumAttempts, FlowSeconds, (HostMs.Num() + JoinMs.Num()) / FlowSeconds);
+		UE_LOG(LogMultiplayerSessions, Display, TEXT("Load test: host to started p50 %.1f ms, p99 %.1f ms, max %.1f ms"),
+			GetPercentile(HostMs, 0.5), GetPercentile(HostMs, 0.99), GetPercentile(HostMs, 1.0));
+		UE_LOG(LogMultiplayerSessions, Display, TEXT("Load test: search to joined p50 %.1f ms, p99 %.1f ms, max %.1f ms"),
+			GetPercentile(JoinMs, 0.5), GetPercentile(JoinMs, 0.99), GetPercentile(JoinMs, 1.0));
+
+		for (EMultiplayerSessionPhase Phase : { EMultiplayerSessionPhase::Create, EMultiplayerSessionPhase::Find, EMultiplayerSessionPhase::Join })
+		{
+			UE_LOG(LogMultiplayerSessions, Display, TEXT("Load test: %s: %s"), *UEnum::GetValueAsString(Phase), *PhaseLatency[static_cast<int32>(Phase)].ToString());
+		}
+
+		// Every request has completed by now, so anything still bound or still around was leaked
+		const bool bClean = NumLeakedDelegates == 0 && NumLeftoverSessions == 0 && Backend->GetNumAdvertisedSessions() == 0;
+		if (bClean)
+		{
+			UE_LOG(LogMultiplayerSessions, Display, TEXT("Load test: no leaked delegates or sessions"));
+		}
+		else
+		{
+			UE_LOG(LogMultiplayerSessions, Warning, TEXT("Load test: %d completion delegate lists still bound, %d sessions and %d advertised sessions left after teardown"),
+				NumLeakedDelegates, NumLeftoverSessions, Backend->GetNumAdvertisedSessions());
+		}
+	}
+
+	TSharedRef<FMultiplayerSessionsFakeBackend> Backend;
+	TArray<TObjectPtr<UMultiplayerSessionsLoadTestClient>> Clients;
+	double StartTime{ 0.0 };
+	double TearDownTime{ -1.0 };
+	double Timeout{ 60.0 };
+};
+
+static TUniquePtr<FMultiplayerSessionsLoadTest> ActiveLoadTest;
+
+//
+// Hundreds of hosts and joiners against the fake backend, each with its own subsystem
+//
+static FAutoConsoleCommand MultiplayerSessionsLoadTestCommand(
+	TEXT("MultiplayerSessions.LoadTest"),
+	TEXT("Hosts and joins sessions on an in-process fake backend, then reports throughput, tail latency and leaked delegates. Usage: MultiplayerSessions.LoadTest [Hosts=200] [Joiners=600] [MinLatencyMs=20] [MaxLatencyMs=200] [FailureRate=0.05] [DuplicateRate=0.1]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (ActiveLoadTest.IsValid())
+		{
+			UE_LOG(LogMultiplayerSessions, Warning, TEXT("Load test: already running"));
+			return;
+		}
+
+		const int32 NumHosts = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 200;
+		const int32 NumJoiners = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 0) : 600;
+
+		FMultiplayerSessionsFakeBackendSettings Settings;
+		Settings.MinLatencyMs = Args.Num() > 2 ? FMath::Max(FCString::Atof(*Args[2]), 0.f) : 20.f;
+		Settings.MaxLatencyMs = Args.Num() > 3 ? FMath::Max(FCString::Atof(*Args[3]), Settings.MinLatencyMs) : 200.f;
+		Settings.FailureRate = Args.Num() > 4 ? FMath::Clamp(FCString::Atof(*Args[4]), 0.f, 0.9f) : 0.05f;
+		Settings.RandomSeed = 1234;
+
+		const float DuplicateRequestRate = Args.Num() > 5 ? FMath::Clamp(FCString::Atof(*Args[5]), 0.f, 1.f) : 0.1f;
+
+		UE_LOG(LogMultiplayerSessions, Display, TEXT("Load test: %d hosts, %d joiners, %.0f-%.0f ms latency, %.0f%% failures"),
+			NumHosts, NumJoiners, Settings.MinLatencyMs, Settings.MaxLatencyMs, Settings.FailureRate * 100.f);
+
+		ActiveLoadTest = MakeUnique<FMultiplayerSessionsLoadTest>(NumHosts, NumJoiners, Settings, DuplicateRequestRate, 60.0);
+
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([](float DeltaTime)
+		{
+			if (ActiveLoadTest.IsValid() && ActiveLoadTest->Tick(DeltaTime))
+			{
+				return true;
+			}
+
+			ActiveLoadTest.Reset();
+			return false;
+		}));
+	}));
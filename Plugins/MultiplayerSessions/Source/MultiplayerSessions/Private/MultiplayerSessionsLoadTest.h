@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Interfaces/OnlineSessionInterface.h"
+
+#include "MultiplayerSessionsLoadTest.generated.h"
+
+class UMultiplayerSessionsSubsystem;
+class FMultiplayerSessionsFakeBackend;
+class FMultiplayerSessionsFakeOnlineSession;
+
+//
+// One simulated player in MultiplayerSessions.LoadTest, driving its own subsystem on the fake backend.
+// Hosts create and start a session, joiners search until they get into one
+//
+UCLASS(Transient)
+class UMultiplayerSessionsLoadTestClient : public UObject
+{
+	GENERATED_BODY()
+public:
+	void Setup(const TSharedRef<FMultiplayerSessionsFakeBackend>& Backend, bool bInHost, float InDuplicateRequestRate);
+	void Begin();
+	void Retry(double Now);
+	void TearDown();
+	void Deinitialize();
+
+	UPROPERTY()
+	TObjectPtr<UMultiplayerSessionsSubsystem> Subsystem;
+
+	TSharedPtr<FMultiplayerSessionsFakeOnlineSession> FakeSession;
+
+	bool bHost{ false };
+	bool bDone{ false };
+	bool bSucceeded{ false };
+	bool bTornDown{ false };
+	bool bDeinitialized{ false };
+	int32 NumAttempts{ 0 };
+	double StartTime{ 0.0 };
+	double FinishTime{ 0.0 };
+	double RetryTime{ -1.0 };
+
+private:
+	void FindSessions();
+	void Finish(bool bWasSuccessful);
+
+	UFUNCTION()
+	void OnCreateSession(bool bWasSuccessful);
+	UFUNCTION()
+	void OnStartSession(bool bWasSuccessful);
+	UFUNCTION()
+	void OnDestroySession(bool bWasSuccessful);
+	void OnFindSessions(TArrayView<const FOnlineSessionSearchResult> SessionResults, bool bWasSuccessful);
+	void OnJoinSession(EOnJoinSessionCompleteResult::Type Result);
+
+	int32 NumTearDownAttempts{ 0 };
+
+	// Chance of sending every search twice, like an impatient click on Join
+	float DuplicateRequestRate{ 0.f };
+
+	FRandomStream Random;
+};
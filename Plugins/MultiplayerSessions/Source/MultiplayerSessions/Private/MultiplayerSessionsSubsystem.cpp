@@ -5,17 +5,109 @@
 #include "OnlineSubsystem.h"
 #include "OnlineSessionSettings.h"
 #include "Online/OnlineSessionNames.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/LocalPlayer.h"
+#include "Misc/CommandLine.h"
+#include "MultiplayerSessionsFakeBackend.h"
+#include "UObject/UObjectGlobals.h"
+#include "MultiplayerSessions.h"
+
+static const FName MatchTypeSettingName(TEXT("MatchType"));
+
+static bool MatchesMatchType(const FOnlineSessionSearchResult& Result, const FString& MatchType)
+{
+	FString SettingsValue;
+	Result.Session.SessionSettings.Get(MatchTypeSettingName, SettingsValue);
+	return SettingsValue == MatchType;
+}
+
+static void FilterByMatchType(TArray<FOnlineSessionSearchResult>& Results, const FString& MatchType)
+{
+	if (!MatchType.IsEmpty())
+	{
+		Results.RemoveAll([&MatchType](const FOnlineSessionSearchResult& Result) { return !MatchesMatchType(Result, MatchType); });
+	}
+}
 
 UMultiplayerSessionsSubsystem::UMultiplayerSessionsSubsystem():
 	CreateSessionCompleteDelegate(FOnCreateSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnCreateSessionComplete)),
 	FindSessionsCompleteDelegate(FOnFindSessionsCompleteDelegate::CreateUObject(this, &ThisClass::OnFindSessionsComplete)),
 	JoinSessionCompleteDelegate(FOnJoinSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnJoinSessionComplete)),
 	DestroySessionCompleteDelegate(FOnDestroySessionCompleteDelegate::CreateUObject(this, &ThisClass::OnDestroySessionComplete)),
-	StartSessionCompleteDelegate(FOnStartSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnStartSessionComplete))
+	StartSessionCompleteDelegate(FOnStartSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnStartSessionComplete)),
+	EndSessionCompleteDelegate(FOnEndSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnEndSessionComplete))
 {
 	
 }
 
+void UMultiplayerSessionsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Sessions that never leave this process, for testing the menu flow without Steam.
+	// An override set before Initialize wins
+	if (!SessionInterface && FParse::Param(FCommandLine::Get(), TEXT("FakeSessions")))
+	{
+		SessionInterface = MakeShared<FMultiplayerSessionsFakeOnlineSession>(FMultiplayerSessionsFakeBackend::GetShared());
+	}
+
+	IsValidSessionInterface();
+	BuildSessionSettingsTemplate();
+
+	// Travel ends when the destination map has loaded
+	PostLoadMapDelegateHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &ThisClass::OnPostLoadMap);
+}
+
+void UMultiplayerSessionsSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapDelegateHandle);
+
+	// Don't leave callbacks to a dead subsystem on the online interface
+	if (SessionInterface)
+	{
+		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
+		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
+		SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
+		SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
+		SessionInterface->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegateHandle);
+		SessionInterface->ClearOnEndSessionCompleteDelegate_Handle(EndSessionCompleteDelegateHandle);
+	}
+
+	LogPhaseLatency();
+
+	Super::Deinitialize();
+}
+
+void UMultiplayerSessionsSubsystem::BuildSessionSettingsTemplate()
+{
+	IOnlineSubsystem* Subsystem = IOnlineSubsystem::Get();
+
+	SessionSettingsTemplate = FOnlineSessionSettings();
+	SessionSettingsTemplate.bIsLANMatch = Subsystem && Subsystem->GetSubsystemName() == "NULL";
+	SessionSettingsTemplate.bAllowJoinInProgress = true;
+	SessionSettingsTemplate.bAllowJoinViaPresence = true;
+	SessionSettingsTemplate.bShouldAdvertise = true;
+	SessionSettingsTemplate.bUsesPresence = true;
+	SessionSettingsTemplate.bUseLobbiesIfAvailable = true;
+	SessionSettingsTemplate.BuildUniqueId = 1;
+}
+
+void UMultiplayerSessionsSubsystem::SetSessionInterfaceOverride(IOnlineSessionPtr InSessionInterface)
+{
+	SessionInterface = InSessionInterface;
+	BuildSessionSettingsTemplate();
+}
+
+FUniqueNetIdPtr UMultiplayerSessionsSubsystem::GetLocalUserId() const
+{
+	const UWorld* World = GetWorld();
+	const ULocalPlayer* LocalPlayer = World ? World->GetFirstLocalPlayerFromController() : nullptr;
+	return LocalPlayer ? LocalPlayer->GetPreferredUniqueNetId().GetUniqueNetId() : nullptr;
+}
+
 void UMultiplayerSessionsSubsystem::CreateSession(int32 NumPublicConnections, FString MatchType)
 {
 	if (!IsValidSessionInterface())
@@ -23,60 +115,113 @@ void UMultiplayerSessionsSubsystem::CreateSession(int32 NumPublicConnections, FS
 		return;
 	}
 
-	auto ExistingSession = SessionInterface->GetNamedSession(NAME_GameSession);
-	if (ExistingSession != nullptr)
+	LastNumPublicConnections = NumPublicConnections;
+	LastMatchType = MatchType;
+
+	// A create is already on its way and will go through on its own
+	if (SessionState == EMultiplayerSessionState::Creating)
+	{
+		return;
+	}
+
+	BeginPhase(EMultiplayerSessionPhase::HostToLobby);
+	BeginPhase(EMultiplayerSessionPhase::Create);
+
+	// The interface won't create a session while the old one still exists, so queue the create behind the destroy.
+	// The settings are ready, so it goes out from the destroy callback without waiting any further
+	if (SessionInterface->GetNamedSession(NAME_GameSession) != nullptr)
 	{
 		bCreateSessionOnDestroy = true;
-		LastNumPublicConnections = NumPublicConnections;
-		LastMatchType = MatchType;
 
-		DestroySession();
+		if (SessionState != EMultiplayerSessionState::Destroying)
+		{
+			DestroySession();
+		}
+		return;
 	}
 
+	CreateSessionFromTemplate();
+}
+
+void UMultiplayerSessionsSubsystem::CreateSessionFromTemplate()
+{
 	// Store the delegate in a FDelegateHandle so we can later remove it from the delegate list
 	CreateSessionCompleteDelegateHandle = SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate);
 
-	LastSessionSettings = MakeShareable(new FOnlineSessionSettings());
-	LastSessionSettings->bIsLANMatch = IOnlineSubsystem::Get()->GetSubsystemName() == "NULL" ? true : false;
-	LastSessionSettings->NumPublicConnections = NumPublicConnections;
-	LastSessionSettings->bAllowJoinInProgress = true;
-	LastSessionSettings->bAllowJoinViaPresence = true;
-	LastSessionSettings->bShouldAdvertise = true;
-	LastSessionSettings->bUsesPresence = true;
-	LastSessionSettings->bUseLobbiesIfAvailable = true;
-	LastSessionSettings->Set(FName("MatchType"), MatchType, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
-	LastSessionSettings->BuildUniqueId = 1;
+	// Only the per-session values differ from the template
+	LastSessionSettings = MakeShared<FOnlineSessionSettings>(SessionSettingsTemplate);
+	LastSessionSettings->NumPublicConnections = LastNumPublicConnections;
+	LastSessionSettings->Set(MatchTypeSettingName, LastMatchType, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
 
-	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-	if (!SessionInterface->CreateSession(*LocalPlayer->GetPreferredUniqueNetId(), NAME_GameSession, *LastSessionSettings))
+	SetSessionState(EMultiplayerSessionState::Creating);
+
+	const FUniqueNetIdPtr LocalUserId = GetLocalUserId();
+	const bool bRequested = LocalUserId.IsValid()
+		? SessionInterface->CreateSession(*LocalUserId, NAME_GameSession, *LastSessionSettings)
+		: SessionInterface->CreateSession(0, NAME_GameSession, *LastSessionSettings);
+	if (!bRequested)
 	{
 		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
+		SetSessionState(EMultiplayerSessionState::NoSession);
+		EndPhase(EMultiplayerSessionPhase::Create, false);
+		EndPhase(EMultiplayerSessionPhase::HostToLobby, false);
 
 		// Broadcast our own custom delegate
 		MultiplayerOnCreateSessionComplete.Broadcast(false);
 	}
 }
 
-void UMultiplayerSessionsSubsystem::FindSessions(int32 MaxSearchResults)
+void UMultiplayerSessionsSubsystem::FindSessions(int32 MaxSearchResults, const FString& MatchType)
 {
 	if (!IsValidSessionInterface())
 	{
 		return;
 	}
 
+	// A search is already on its way and will answer for this one too.
+	// Adding a second callback would overwrite the handle of the first and leave it bound
+	if (FindSessionsCompleteDelegateHandle.IsValid())
+	{
+		return;
+	}
+
+	BeginPhase(EMultiplayerSessionPhase::JoinToLobby);
+	BeginPhase(EMultiplayerSessionPhase::Find);
+
+	// Recent results for the same match type don't need another round trip to the backend
+	if (IsSessionResultsCacheValid(MatchType))
+	{
+		EndPhase(EMultiplayerSessionPhase::Find, true);
+		MultiplayerOnFindSessionsComplete.Broadcast(GetSessionResultsPage(0), CachedSearchResults.Num() > 0);
+		return;
+	}
+
+	LastSearchMatchType = MatchType;
+
 	FindSessionsCompleteDelegateHandle = SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate);
 
 	LastSessionSearch = MakeShareable(new FOnlineSessionSearch());
 	LastSessionSearch->MaxSearchResults = MaxSearchResults;
-	LastSessionSearch->bIsLanQuery = IOnlineSubsystem::Get()->GetSubsystemName() == "NULL" ? true : false;
+	LastSessionSearch->bIsLanQuery = SessionSettingsTemplate.bIsLANMatch;
 	LastSessionSearch->QuerySettings.Set(SEARCH_LOBBIES, true, EOnlineComparisonOp::Equals);
 
-	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-	if (!SessionInterface->FindSessions(*LocalPlayer->GetPreferredUniqueNetId(), LastSessionSearch.ToSharedRef()))
+	// Let the backend filter on match type, so sessions we wouldn't join are never sent to us
+	if (!MatchType.IsEmpty())
+	{
+		LastSessionSearch->QuerySettings.Set(MatchTypeSettingName, MatchType, EOnlineComparisonOp::Equals);
+	}
+
+	const FUniqueNetIdPtr LocalUserId = GetLocalUserId();
+	const bool bRequested = LocalUserId.IsValid()
+		? SessionInterface->FindSessions(*LocalUserId, LastSessionSearch.ToSharedRef())
+		: SessionInterface->FindSessions(0, LastSessionSearch.ToSharedRef());
+	if (!bRequested)
 	{
 		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
+		EndPhase(EMultiplayerSessionPhase::Find, false);
+		EndPhase(EMultiplayerSessionPhase::JoinToLobby, false);
 
-		MultiplayerOnFindSessionsComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
+		MultiplayerOnFindSessionsComplete.Broadcast(TArrayView<const FOnlineSessionSearchResult>(), false);
 	}
 }
 
@@ -88,12 +233,27 @@ void UMultiplayerSessionsSubsystem::JoinSession(const FOnlineSessionSearchResult
 		return;
 	}
 
+	// Same as searching, the join in flight answers
+	if (JoinSessionCompleteDelegateHandle.IsValid())
+	{
+		return;
+	}
+
 	JoinSessionCompleteDelegateHandle = SessionInterface->AddOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate);
 
-	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-	if (!SessionInterface->JoinSession(*LocalPlayer->GetPreferredUniqueNetId(), NAME_GameSession, SessionResult))
+	BeginPhase(EMultiplayerSessionPhase::Join);
+	SetSessionState(EMultiplayerSessionState::Joining);
+
+	const FUniqueNetIdPtr LocalUserId = GetLocalUserId();
+	const bool bRequested = LocalUserId.IsValid()
+		? SessionInterface->JoinSession(*LocalUserId, NAME_GameSession, SessionResult)
+		: SessionInterface->JoinSession(0, NAME_GameSession, SessionResult);
+	if (!bRequested)
 	{
 		SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
+		SetSessionState(EMultiplayerSessionState::NoSession);
+		EndPhase(EMultiplayerSessionPhase::Join, false);
+		EndPhase(EMultiplayerSessionPhase::JoinToLobby, false);
 
 		MultiplayerOnJoinSessionComplete.Broadcast(EOnJoinSessionCompleteResult::UnknownError);
 	}
@@ -107,17 +267,141 @@ void UMultiplayerSessionsSubsystem::DestroySession()
 		return;
 	}
 
+	// Already on its way
+	if (SessionState == EMultiplayerSessionState::Destroying)
+	{
+		return;
+	}
+
 	DestroySessionCompleteDelegateHandle = SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate);
 
+	const EMultiplayerSessionState PreviousState = SessionState;
+	SetSessionState(EMultiplayerSessionState::Destroying);
+
 	if (!SessionInterface->DestroySession(NAME_GameSession))
 	{
 		SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
-		MultiplayerOnDestroySessionComplete.Broadcast(false);
+		SetSessionState(PreviousState);
+		OnDestroySessionComplete(NAME_GameSession, false);
 	}
 }
 
 void UMultiplayerSessionsSubsystem::StartSession()
 {
+	if (!IsValidSessionInterface() || SessionState != EMultiplayerSessionState::Pending)
+	{
+		MultiplayerOnStartSessionComplete.Broadcast(false);
+		return;
+	}
+
+	StartSessionCompleteDelegateHandle = SessionInterface->AddOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegate);
+
+	SetSessionState(EMultiplayerSessionState::Starting);
+
+	if (!SessionInterface->StartSession(NAME_GameSession))
+	{
+		SessionInterface->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegateHandle);
+		SetSessionState(EMultiplayerSessionState::Pending);
+
+		MultiplayerOnStartSessionComplete.Broadcast(false);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::EndSession()
+{
+	if (!IsValidSessionInterface() || SessionState != EMultiplayerSessionState::InProgress)
+	{
+		MultiplayerOnEndSessionComplete.Broadcast(false);
+		return;
+	}
+
+	EndSessionCompleteDelegateHandle = SessionInterface->AddOnEndSessionCompleteDelegate_Handle(EndSessionCompleteDelegate);
+
+	SetSessionState(EMultiplayerSessionState::Ending);
+
+	if (!SessionInterface->EndSession(NAME_GameSession))
+	{
+		SessionInterface->ClearOnEndSessionCompleteDelegate_Handle(EndSessionCompleteDelegateHandle);
+		SetSessionState(EMultiplayerSessionState::InProgress);
+
+		MultiplayerOnEndSessionComplete.Broadcast(false);
+	}
+}
+
+bool UMultiplayerSessionsSubsystem::TravelToLobby(const FString& PathToLobby)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		EndPhase(EMultiplayerSessionPhase::HostToLobby, false);
+		return false;
+	}
+
+	BeginPhase(EMultiplayerSessionPhase::Travel);
+	if (!World->ServerTravel(PathToLobby))
+	{
+		EndPhase(EMultiplayerSessionPhase::Travel, false);
+		EndPhase(EMultiplayerSessionPhase::HostToLobby, false);
+		return false;
+	}
+	return true;
+}
+
+bool UMultiplayerSessionsSubsystem::TravelToJoinedSession()
+{
+	if (!IsValidSessionInterface())
+	{
+		EndPhase(EMultiplayerSessionPhase::JoinToLobby, false);
+		return false;
+	}
+
+	BeginPhase(EMultiplayerSessionPhase::ResolveConnectString);
+	FString Address;
+	const bool bResolved = SessionInterface->GetResolvedConnectString(NAME_GameSession, Address);
+	EndPhase(EMultiplayerSessionPhase::ResolveConnectString, bResolved);
+
+	APlayerController* PlayerController = GetGameInstance()->GetFirstLocalPlayerController();
+	if (!bResolved || PlayerController == nullptr)
+	{
+		EndPhase(EMultiplayerSessionPhase::JoinToLobby, false);
+		return false;
+	}
+
+	BeginPhase(EMultiplayerSessionPhase::Travel);
+	PlayerController->ClientTravel(Address, ETravelType::TRAVEL_Absolute);
+	return true;
+}
+
+TArrayView<const FOnlineSessionSearchResult> UMultiplayerSessionsSubsystem::GetSessionResultsPage(int32 PageIndex) const
+{
+	const int32 FirstResult = PageIndex * SessionResultsPageSize;
+	if (PageIndex < 0 || FirstResult >= CachedSearchResults.Num())
+	{
+		return TArrayView<const FOnlineSessionSearchResult>();
+	}
+
+	return TArrayView<const FOnlineSessionSearchResult>(CachedSearchResults).Slice(FirstResult, FMath::Min(SessionResultsPageSize, CachedSearchResults.Num() - FirstResult));
+}
+
+int32 UMultiplayerSessionsSubsystem::GetNumSessionResultPages() const
+{
+	return FMath::DivideAndRoundUp(CachedSearchResults.Num(), SessionResultsPageSize);
+}
+
+void UMultiplayerSessionsSubsystem::SetSessionResultsPaging(int32 PageSize, double CacheTimeToLive)
+{
+	SessionResultsPageSize = FMath::Max(PageSize, 1);
+	SessionResultsCacheTTL = CacheTimeToLive;
+}
+
+void UMultiplayerSessionsSubsystem::InvalidateSessionResultsCache()
+{
+	CachedSearchTime = -1.0;
+}
+
+bool UMultiplayerSessionsSubsystem::IsSessionResultsCacheValid(const FString& MatchType) const
+{
+	return CachedSearchTime >= 0.0 && CachedMatchType == MatchType && FPlatformTime::Seconds() - CachedSearchTime < SessionResultsCacheTTL;
 }
 
 bool UMultiplayerSessionsSubsystem::IsValidSessionInterface()
@@ -140,6 +424,13 @@ void UMultiplayerSessionsSubsystem::OnCreateSessionComplete(FName SessionName, b
 		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
 	}
 
+	SetSessionState(bWasSuccessful ? EMultiplayerSessionState::Pending : EMultiplayerSessionState::NoSession);
+	EndPhase(EMultiplayerSessionPhase::Create, bWasSuccessful);
+	if (!bWasSuccessful)
+	{
+		EndPhase(EMultiplayerSessionPhase::HostToLobby, false);
+	}
+
 	MultiplayerOnCreateSessionComplete.Broadcast(bWasSuccessful);
 }
 
@@ -150,13 +441,26 @@ void UMultiplayerSessionsSubsystem::OnFindSessionsComplete(bool bWasSuccessful)
 		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
 	}
 
-	if (LastSessionSearch->SearchResults.Num() <= 0)
+	EndPhase(EMultiplayerSessionPhase::Find, bWasSuccessful);
+
+	CachedSearchResults = MoveTemp(LastSessionSearch->SearchResults);
+	LastSessionSearch->SearchResults.Reset();
+
+	// Not every backend applies the query settings, so drop anything that slipped through once here
+	FilterByMatchType(CachedSearchResults, LastSearchMatchType);
+
+	CachedMatchType = LastSearchMatchType;
+	// An empty list is cached as a miss, so the next search goes to the backend and can see sessions created since
+	CachedSearchTime = bWasSuccessful && CachedSearchResults.Num() > 0 ? FPlatformTime::Seconds() : -1.0;
+
+	if (CachedSearchResults.Num() <= 0)
 	{
-		MultiplayerOnFindSessionsComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
+		EndPhase(EMultiplayerSessionPhase::JoinToLobby, false);
+		MultiplayerOnFindSessionsComplete.Broadcast(TArrayView<const FOnlineSessionSearchResult>(), false);
 		return;
 	}
 
-	MultiplayerOnFindSessionsComplete.Broadcast(LastSessionSearch->SearchResults, bWasSuccessful);
+	MultiplayerOnFindSessionsComplete.Broadcast(GetSessionResultsPage(0), bWasSuccessful);
 }
 
 void UMultiplayerSessionsSubsystem::OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result)
@@ -166,6 +470,17 @@ void UMultiplayerSessionsSubsystem::OnJoinSessionComplete(FName SessionName, EOn
 		SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
 	}
 
+	const bool bWasSuccessful = Result == EOnJoinSessionCompleteResult::Success;
+	SetSessionState(bWasSuccessful ? EMultiplayerSessionState::Joined : EMultiplayerSessionState::NoSession);
+	EndPhase(EMultiplayerSessionPhase::Join, bWasSuccessful);
+
+	// The session we picked may be full or gone, so search again next time
+	if (!bWasSuccessful)
+	{
+		EndPhase(EMultiplayerSessionPhase::JoinToLobby, false);
+		InvalidateSessionResultsCache();
+	}
+
 	MultiplayerOnJoinSessionComplete.Broadcast(Result);
 }
 
@@ -175,14 +490,239 @@ void UMultiplayerSessionsSubsystem::OnDestroySessionComplete(FName SessionName,
 	{
 		SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
 	}
-	if (bWasSuccessful && bCreateSessionOnDestroy)
+	if (SessionState == EMultiplayerSessionState::Destroying)
+	{
+		SetSessionState(bWasSuccessful ? EMultiplayerSessionState::NoSession : EMultiplayerSessionState::Pending);
+	}
+	if (bCreateSessionOnDestroy)
 	{
 		bCreateSessionOnDestroy = false;
-		CreateSession(LastNumPublicConnections, LastMatchType);
+		if (bWasSuccessful)
+		{
+			CreateSessionFromTemplate();
+		}
+		else
+		{
+			EndPhase(EMultiplayerSessionPhase::Create, false);
+			EndPhase(EMultiplayerSessionPhase::HostToLobby, false);
+			MultiplayerOnCreateSessionComplete.Broadcast(false);
+		}
 	}
 	MultiplayerOnDestroySessionComplete.Broadcast(bWasSuccessful);
 }
 
 void UMultiplayerSessionsSubsystem::OnStartSessionComplete(FName SessionName, bool bWasSuccessful)
 {
+	if (SessionInterface)
+	{
+		SessionInterface->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegateHandle);
+	}
+
+	SetSessionState(bWasSuccessful ? EMultiplayerSessionState::InProgress : EMultiplayerSessionState::Pending);
+
+	MultiplayerOnStartSessionComplete.Broadcast(bWasSuccessful);
 }
+
+void UMultiplayerSessionsSubsystem::OnEndSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	if (SessionInterface)
+	{
+		SessionInterface->ClearOnEndSessionCompleteDelegate_Handle(EndSessionCompleteDelegateHandle);
+	}
+
+	// An ended session can be started again, same as a freshly created one
+	SetSessionState(bWasSuccessful ? EMultiplayerSessionState::Pending : EMultiplayerSessionState::InProgress);
+
+	MultiplayerOnEndSessionComplete.Broadcast(bWasSuccessful);
+}
+
+void UMultiplayerSessionsSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	EndPhase(EMultiplayerSessionPhase::Travel, LoadedWorld != nullptr);
+	EndPhase(EMultiplayerSessionPhase::HostToLobby, LoadedWorld != nullptr);
+	EndPhase(EMultiplayerSessionPhase::JoinToLobby, LoadedWorld != nullptr);
+}
+
+void UMultiplayerSessionsSubsystem::SetSessionState(EMultiplayerSessionState NewState)
+{
+	if (SessionState != NewState)
+	{
+		UE_LOG(LogMultiplayerSessions, Verbose, TEXT("Session state %s -> %s"), *UEnum::GetValueAsString(SessionState), *UEnum::GetValueAsString(NewState));
+		SessionState = NewState;
+	}
+}
+
+void UMultiplayerSessionsSubsystem::BeginPhase(EMultiplayerSessionPhase Phase)
+{
+	PhaseStartTimes[static_cast<int32>(Phase)] = FPlatformTime::Seconds();
+}
+
+void UMultiplayerSessionsSubsystem::EndPhase(EMultiplayerSessionPhase Phase, bool bWasSuccessful)
+{
+	double& StartTime = PhaseStartTimes[static_cast<int32>(Phase)];
+
+	// Phases that never started, or already ended, aren't recorded
+	if (StartTime <= 0.0)
+	{
+		return;
+	}
+
+	FMultiplayerSessionsLatencyHistogram& Histogram = PhaseLatency[static_cast<int32>(Phase)];
+	if (bWasSuccessful)
+	{
+		Histogram.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	}
+	else
+	{
+		++Histogram.NumFailed;
+	}
+
+	StartTime = 0.0;
+}
+
+void UMultiplayerSessionsSubsystem::LogPhaseLatency() const
+{
+	for (int32 PhaseIndex = 0; PhaseIndex < static_cast<int32>(EMultiplayerSessionPhase::Count); ++PhaseIndex)
+	{
+		const FMultiplayerSessionsLatencyHistogram& Histogram = PhaseLatency[PhaseIndex];
+		if (Histogram.Count > 0 || Histogram.NumFailed > 0)
+		{
+			UE_LOG(LogMultiplayerSessions, Log, TEXT("%s: %s"), *UEnum::GetValueAsString(static_cast<EMultiplayerSessionPhase>(PhaseIndex)), *Histogram.ToString());
+		}
+	}
+}
+
+const double FMultiplayerSessionsLatencyHistogram::BucketLimitsMs[NumBuckets - 1] = { 50.0, 100.0, 250.0, 500.0, 1000.0, 2500.0, 5000.0 };
+
+void FMultiplayerSessionsLatencyHistogram::Add(double Ms)
+{
+	int32 Bucket = 0;
+	while (Bucket < NumBuckets - 1 && Ms > BucketLimitsMs[Bucket])
+	{
+		++Bucket;
+	}
+
+	++Buckets[Bucket];
+	++Count;
+	SumMs += Ms;
+	MaxMs = FMath::Max(MaxMs, Ms);
+}
+
+void FMultiplayerSessionsLatencyHistogram::Append(const FMultiplayerSessionsLatencyHistogram& Other)
+{
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+	{
+		Buckets[Bucket] += Other.Buckets[Bucket];
+	}
+
+	Count += Other.Count;
+	NumFailed += Other.NumFailed;
+	SumMs += Other.SumMs;
+	MaxMs = FMath::Max(MaxMs, Other.MaxMs);
+}
+
+double FMultiplayerSessionsLatencyHistogram::GetPercentileMs(double Percentile) const
+{
+	const int32 Target = FMath::CeilToInt32(Percentile * Count);
+
+	int32 Seen = 0;
+	for (int32 Bucket = 0; Bucket < NumBuckets - 1; ++Bucket)
+	{
+		Seen += Buckets[Bucket];
+		if (Seen >= Target)
+		{
+			return FMath::Min(BucketLimitsMs[Bucket], MaxMs);
+		}
+	}
+	return MaxMs;
+}
+
+FString FMultiplayerSessionsLatencyHistogram::ToString() const
+{
+	FString Result = FString::Printf(TEXT("%d ok, %d failed, avg %.1f ms, p50 <= %.0f ms, p90 <= %.0f ms, p99 <= %.0f ms, max %.1f ms ["),
+		Count, NumFailed, Count > 0 ? SumMs / Count : 0.0, GetPercentileMs(0.5), GetPercentileMs(0.9), GetPercentileMs(0.99), MaxMs);
+
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+	{
+		Result += FString::Printf(TEXT("%s%d"), Bucket > 0 ? TEXT(" ") : TEXT(""), Buckets[Bucket]);
+	}
+	return Result + TEXT("]");
+}
+
+//
+// Prints the phase latency histograms of the current game instance
+//
+static FAutoConsoleCommandWithWorld MultiplayerSessionsLatencyCommand(
+	TEXT("MultiplayerSessions.Latency"),
+	TEXT("Logs latency histograms for each session phase, from Host or Join to a playable lobby"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		if (const UMultiplayerSessionsSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr)
+		{
+			Subsystem->LogPhaseLatency();
+		}
+	}));
+
+//
+// Compares scanning every result on the client against filtering once and handing out pages
+//
+static FAutoConsoleCommand MultiplayerSessionsBrowserBenchmarkCommand(
+	TEXT("MultiplayerSessions.BrowserBenchmark"),
+	TEXT("Times session result delivery with fake LAN sessions. Usage: MultiplayerSessions.BrowserBenchmark [Sessions=5000] [Iterations=100] [PageSize=20]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumSessions = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 5000;
+		const int32 Iterations = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 100;
+		const int32 PageSize = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 20;
+
+		const FString WantedMatchType(TEXT("FreeForAll"));
+
+		// One in ten sessions has the match type we're looking for, placed at random
+		FRandomStream Random(1234);
+		TArray<FOnlineSessionSearchResult> Results;
+		Results.SetNum(NumSessions);
+		for (FOnlineSessionSearchResult& Result : Results)
+		{
+			Result.Session.SessionSettings.bIsLANMatch = true;
+			Result.Session.SessionSettings.NumPublicConnections = 4;
+			Result.Session.SessionSettings.Set(MatchTypeSettingName, Random.FRand() < 0.1f ? WantedMatchType : FString(TEXT("Teams")), EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+			Result.PingInMs = Random.RandRange(10, 200);
+		}
+
+		// Old path: the whole array goes to the menu, which copies every result while it scans for the match type
+		int32 NumMatches = 0;
+		const double CopyScanStart = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			NumMatches = 0;
+			for (auto Result : Results)
+			{
+				if (MatchesMatchType(Result, WantedMatchType))
+				{
+					++NumMatches;
+				}
+			}
+		}
+		const double CopyScanTime = FPlatformTime::Seconds() - CopyScanStart;
+
+		// New path: results are filtered once when the search completes
+		TArray<FOnlineSessionSearchResult> Filtered = Results;
+		const double FilterStart = FPlatformTime::Seconds();
+		FilterByMatchType(Filtered, WantedMatchType);
+		const double FilterTime = FPlatformTime::Seconds() - FilterStart;
+
+		// then every delivery, including cached ones within the time to live, only hands out a page by reference
+		int32 NumDelivered = 0;
+		const double PageStart = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			const int32 PageIndex = Iteration % FMath::Max(FMath::DivideAndRoundUp(Filtered.Num(), PageSize), 1);
+			NumDelivered += TArrayView<const FOnlineSessionSearchResult>(Filtered).Mid(PageIndex * PageSize, PageSize).Num();
+		}
+		const double PageTime = FPlatformTime::Seconds() - PageStart;
+
+		UE_LOG(LogMultiplayerSessions, Display, TEXT("Session browser benchmark: %d sessions, %d matching. Copy and scan: %.3f ms/search. Filter once: %.3f ms/search, then %.3f us/page of %d (%d results delivered)"),
+			NumSessions, NumMatches,
+			CopyScanTime * 1000.0 / Iterations, FilterTime * 1000.0, PageTime * 1000000.0 / Iterations, PageSize, NumDelivered);
+	}));
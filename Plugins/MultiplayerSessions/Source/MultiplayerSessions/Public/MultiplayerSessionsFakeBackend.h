@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "OnlineSessionSettings.h"
+
+//
+// Latency and failure injection for the fake session backend
+//
+struct MULTIPLAYERSESSIONS_API FMultiplayerSessionsFakeBackendSettings
+{
+	// Every request completes after a random delay in this range
+	float MinLatencyMs{ 20.f };
+	float MaxLatencyMs{ 200.f };
+
+	// Chance for any request to fail once its delay has passed
+	float FailureRate{ 0.f };
+
+	int32 RandomSeed{ 0 };
+};
+
+//
+// In-process stand-in for an online session service, shared by every FMultiplayerSessionsFakeOnlineSession.
+// Keeps the advertised sessions and completes requests after the configured latency, on the core ticker
+//
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsFakeBackend : public TSharedFromThis<FMultiplayerSessionsFakeBackend>
+{
+public:
+	explicit FMultiplayerSessionsFakeBackend(const FMultiplayerSessionsFakeBackendSettings& InSettings = FMultiplayerSessionsFakeBackendSettings());
+	~FMultiplayerSessionsFakeBackend();
+
+	// Backend shared by every game instance in this process, so PIE clients can find sessions hosted by PIE servers
+	static TSharedRef<FMultiplayerSessionsFakeBackend> GetShared();
+
+	// Runs the completion after the simulated latency, failing it at the configured rate
+	void Schedule(TFunction<void(bool bWasSuccessful)>&& Completion);
+
+	//
+	// Advertised sessions, keyed by the host id stored in their settings
+	//
+	int32 AdvertiseSession(FOnlineSessionSettings& SessionSettings);
+	void RemoveSession(int32 HostId);
+	EOnJoinSessionCompleteResult::Type ClaimSlot(int32 HostId);
+	void ReleaseSlot(int32 HostId);
+	void Search(const FOnlineSessionSearch& SearchSettings, TArray<FOnlineSessionSearchResult>& OutResults) const;
+
+	static int32 GetHostId(const FOnlineSessionSettings& SessionSettings);
+
+	int32 GetNumPendingRequests() const { return PendingRequests.Num(); }
+	int32 GetNumAdvertisedSessions() const { return AdvertisedSessions.Num(); }
+
+	// Seeded from Settings.RandomSeed, so anything driving the backend can replay the same run
+	FRandomStream& GetRandom() { return Random; }
+
+	FMultiplayerSessionsFakeBackendSettings Settings;
+
+private:
+	bool Tick(float DeltaTime);
+
+	struct FPendingRequest
+	{
+		double DueTime{ 0.0 };
+		bool bSucceeds{ true };
+		TFunction<void(bool)> Completion;
+	};
+
+	struct FAdvertisedSession
+	{
+		FOnlineSessionSettings Settings;
+		int32 OpenSlots{ 0 };
+	};
+
+	TArray<FPendingRequest> PendingRequests;
+	TMap<int32, FAdvertisedSession> AdvertisedSessions;
+	int32 NextHostId{ 1 };
+	FRandomStream Random;
+	FTSTicker::FDelegateHandle TickerHandle;
+};
+
+//
+// IOnlineSession backed by FMultiplayerSessionsFakeBackend, for one simulated player.
+// Supports create, start, end, destroy, find and join. Everything else fails or does nothing
+//
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsFakeOnlineSession : public IOnlineSession, public TSharedFromThis<FMultiplayerSessionsFakeOnlineSession>
+{
+public:
+	explicit FMultiplayerSessionsFakeOnlineSession(const TSharedRef<FMultiplayerSessionsFakeBackend>& InBackend);
+	virtual ~FMultiplayerSessionsFakeOnlineSession();
+
+	// Number of completion delegate lists that still have something bound. Should be zero once every request has completed
+	int32 GetNumBoundDelegates() const;
+
+	//~ Begin IOnlineSession Interface
+	virtual FUniqueNetIdPtr CreateSessionIdFromString(const FString& SessionIdStr) override;
+	virtual FNamedOnlineSession* GetNamedSession(FName SessionName) override;
+	virtual void RemoveNamedSession(FName SessionName) override;
+	virtual EOnlineSessionState::Type GetSessionState(FName SessionName) const override;
+	virtual bool HasPresenceSession() override;
+	virtual bool CreateSession(int32 HostingPlayerNum, FName SessionName, const FOnlineSessionSettings& NewSessionSettings) override;
+	virtual bool CreateSession(const FUniqueNetId& HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings) override;
+	virtual bool StartSession(FName SessionName) override;
+	virtual bool UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData = true) override;
+	virtual bool EndSession(FName SessionName) override;
+	virtual bool DestroySession(FName SessionName, const FOnDestroySessionCompleteDelegate& CompletionDelegate = FOnDestroySessionCompleteDelegate()) override;
+	virtual bool IsPlayerInSession(FName SessionName, const FUniqueNetId& UniqueId) override;
+	virtual bool StartMatchmaking(const TArray<FUniqueNetIdRef>& LocalPlayers, FName SessionName, const FOnlineSessionSettings& NewSessionSettings, TSharedRef<FOnlineSessionSearch>& SearchSettings) override;
+	virtual bool CancelMatchmaking(int32 SearchingPlayerNum, FName SessionName) override;
+	virtual bool CancelMatchmaking(const FUniqueNetId& SearchingPlayerId, FName SessionName) override;
+	virtual bool FindSessions(int32 SearchingPlayerNum, const TSharedRef<FOnlineSessionSearch>& SearchSettings) override;
+	virtual bool FindSessions(const FUniqueNetId& SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings) override;
+	virtual bool FindSessionById(const FUniqueNetId& SearchingUserId, const FUniqueNetId& SessionId, const FUniqueNetId& FriendId, const FOnSingleSessionResultCompleteDelegate& CompletionDelegate) override;
+	virtual bool CancelFindSessions() override;
+	virtual bool PingSearchResults(const FOnlineSessionSearchResult& SearchResult) override;
+	virtual bool JoinSession(int32 LocalUserNum, FName SessionName, const FOnlineSessionSearchResult& DesiredSession) override;
+	virtual bool JoinSession(const FUniqueNetId& LocalUserId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession) override;
+	virtual bool FindFriendSession(int32 LocalUserNum, const FUniqueNetId& Friend) override;
+	virtual bool FindFriendSession(const FUniqueNetId& LocalUserId, const FUniqueNetId& Friend) override;
+	virtual bool FindFriendSession(const FUniqueNetId& LocalUserId, const TArray<FUniqueNetIdRef>& FriendList) override;
+	virtual bool SendSessionInviteToFriend(int32 LocalUserNum, FName SessionName, const FUniqueNetId& Friend) override;
+	virtual bool SendSessionInviteToFriend(const FUniqueNetId& LocalUserId, FName SessionName, const FUniqueNetId& Friend) override;
+	virtual bool SendSessionInviteToFriends(int32 LocalUserNum, FName SessionName, const TArray<FUniqueNetIdRef>& Friends) override;
+	virtual bool SendSessionInviteToFriends(const FUniqueNetId& LocalUserId, FName SessionName, const TArray<FUniqueNetIdRef>& Friends) override;
+	virtual bool GetResolvedConnectString(FName SessionName, FString& ConnectInfo, FName PortType = NAME_GamePort) override;
+	virtual bool GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo) override;
+	virtual FOnlineSessionSettings* GetSessionSettings(FName SessionName) override;
+	virtual bool RegisterPlayer(FName SessionName, const FUniqueNetId& PlayerId, bool bWasInvited) override;
+	virtual bool RegisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasInvited = false) override;
+	virtual bool UnregisterPlayer(FName SessionName, const FUniqueNetId& PlayerId) override;
+	virtual bool UnregisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players) override;
+	virtual void RegisterLocalPlayer(const FUniqueNetId& PlayerId, FName SessionName, const FOnRegisterLocalPlayerCompleteDelegate& Delegate) override;
+	virtual void UnregisterLocalPlayer(const FUniqueNetId& PlayerId, FName SessionName, const FOnUnregisterLocalPlayerCompleteDelegate& Delegate) override;
+	virtual void RemovePlayerFromSession(int32 LocalUserNum, FName SessionName, const FUniqueNetId& TargetPlayerId) override;
+	virtual int32 GetNumSessions() override;
+	virtual void DumpSessionState() override;
+	//~ End IOnlineSession Interface
+
+protected:
+	virtual FNamedOnlineSession* AddNamedSession(FName SessionName, const FOnlineSessionSettings& SessionSettings) override;
+	virtual FNamedOnlineSession* AddNamedSession(FName SessionName, const FOnlineSession& Session) override;
+
+private:
+	// The search in flight. Only one at a time, as with the real services
+	TSharedPtr<FOnlineSessionSearch> CurrentSessionSearch;
+
+	// Named sessions are heap allocated so pointers handed out by GetNamedSession stay valid
+	TArray<TUniquePtr<FNamedOnlineSession>> Sessions;
+
+	TSharedRef<FMultiplayerSessionsFakeBackend> Backend;
+};
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "Interfaces/OnlineSessionInterface.h"
+#include "OnlineSessionSettings.h"
 
 #include "MultiplayerSessionsSubsystem.generated.h"
 
@@ -12,10 +13,69 @@
 // Delcaring our own custom delegates for the Menu class to bind callbacks to
 //
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnCreateSessionComplete, bool, bWasSuccessful);
-DECLARE_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnFindSessionsComplete, const TArray<FOnlineSessionSearchResult>& SessionResults, bool bWasSuccessful);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnFindSessionsComplete, TArrayView<const FOnlineSessionSearchResult> SessionResults, bool bWasSuccessful);
 DECLARE_MULTICAST_DELEGATE_OneParam(FMultiplayerOnJoinSessionComplete, EOnJoinSessionCompleteResult::Type Result);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnDestroySessionComplete, bool, bWasSuccessful);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnStartSessionComplete, bool, bWasSuccessful);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnEndSessionComplete, bool, bWasSuccessful);
+
+//
+// Where the game session is in its lifecycle. Requests that arrive mid-transition are queued instead of racing the online interface
+//
+UENUM(BlueprintType)
+enum class EMultiplayerSessionState : uint8
+{
+	NoSession,
+	Destroying,
+	Creating,
+	Pending,
+	Starting,
+	InProgress,
+	Ending,
+	Joining,
+	Joined
+};
+
+//
+// Timed phases, from clicking Host or Join to a playable map
+//
+UENUM(BlueprintType)
+enum class EMultiplayerSessionPhase : uint8
+{
+	Create,
+	Find,
+	Join,
+	ResolveConnectString,
+	Travel,
+	HostToLobby,
+	JoinToLobby,
+	Count UMETA(Hidden)
+};
+
+//
+// Latency distribution for one phase, in log scale buckets
+//
+struct MULTIPLAYERSESSIONS_API FMultiplayerSessionsLatencyHistogram
+{
+	static constexpr int32 NumBuckets = 8;
+
+	// Upper bound of each bucket in milliseconds. The last bucket takes everything above
+	static const double BucketLimitsMs[NumBuckets - 1];
+
+	int32 Buckets[NumBuckets]{};
+	int32 Count{ 0 };
+	int32 NumFailed{ 0 };
+	double SumMs{ 0.0 };
+	double MaxMs{ 0.0 };
+
+	void Add(double Ms);
+	void Append(const FMultiplayerSessionsLatencyHistogram& Other);
+
+	// Approximate percentile, as the upper bound of the bucket it falls in
+	double GetPercentileMs(double Percentile) const;
+
+	FString ToString() const;
+};
 
 /**
  * 
@@ -31,13 +91,41 @@ public:
 	// To handle session functionality. The Menu class will call these
 	//
 	void CreateSession(int32 NumPublicConnections, FString MatchType);
-	void FindSessions(int32 MaxSearchResults);
+	void FindSessions(int32 MaxSearchResults, const FString& MatchType = FString());
 	void JoinSession(const FOnlineSessionSearchResult& SessionResult);
 	void DestroySession();
 	void StartSession();
+	void EndSession();
+
+	//
+	// Travel helpers, so the subsystem can time the whole trip to a playable lobby
+	//
+	bool TravelToLobby(const FString& PathToLobby);
+	bool TravelToJoinedSession();
+
+	EMultiplayerSessionState GetSessionState() const { return SessionState; }
+	const FMultiplayerSessionsLatencyHistogram& GetPhaseLatency(EMultiplayerSessionPhase Phase) const { return PhaseLatency[static_cast<int32>(Phase)]; }
+	void LogPhaseLatency() const;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
 
 	bool IsValidSessionInterface();
 
+	// Sends every session call to this interface instead of the online subsystem's, e.g. a FMultiplayerSessionsFakeOnlineSession
+	void SetSessionInterfaceOverride(IOnlineSessionPtr InSessionInterface);
+
+	//
+	// Paged access to the results of the last search. FindSessions only delivers the first page
+	//
+	TArrayView<const FOnlineSessionSearchResult> GetSessionResultsPage(int32 PageIndex) const;
+	int32 GetNumSessionResultPages() const;
+	int32 GetNumSessionResults() const { return CachedSearchResults.Num(); }
+
+	// Page size, and how long search results are reused before FindSessions searches again
+	void SetSessionResultsPaging(int32 PageSize, double CacheTimeToLive);
+	void InvalidateSessionResultsCache();
+
 	//
 	// Our own custom delegates for the Menu class to bind callbacks to
 	//
@@ -46,6 +134,7 @@ public:
 	FMultiplayerOnJoinSessionComplete MultiplayerOnJoinSessionComplete;
 	FMultiplayerOnDestroySessionComplete MultiplayerOnDestroySessionComplete;
 	FMultiplayerOnStartSessionComplete MultiplayerOnStartSessionComplete;
+	FMultiplayerOnEndSessionComplete MultiplayerOnEndSessionComplete;
 
 protected:
 
@@ -58,8 +147,13 @@ protected:
 	void OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result);
 	void OnDestroySessionComplete(FName SessionName, bool bWasSuccessful);
 	void OnStartSessionComplete(FName SessionName, bool bWasSuccessful);
+	void OnEndSessionComplete(FName SessionName, bool bWasSuccessful);
+	void OnPostLoadMap(UWorld* LoadedWorld);
 
 private:
+	// The local player's id, or null without one, in which case requests go out for local user 0
+	FUniqueNetIdPtr GetLocalUserId() const;
+
 	IOnlineSessionPtr SessionInterface;
 	TSharedPtr<FOnlineSessionSettings> LastSessionSettings;
 	TSharedPtr<FOnlineSessionSearch> LastSessionSearch;
@@ -78,6 +172,39 @@ private:
 	FDelegateHandle DestroySessionCompleteDelegateHandle;
 	FOnStartSessionCompleteDelegate StartSessionCompleteDelegate;
 	FDelegateHandle StartSessionCompleteDelegateHandle;
+	FOnEndSessionCompleteDelegate EndSessionCompleteDelegate;
+	FDelegateHandle EndSessionCompleteDelegateHandle;
+	FDelegateHandle PostLoadMapDelegateHandle;
+
+	//
+	// Results of the last successful search, filtered on match type and reused until they expire
+	//
+	bool IsSessionResultsCacheValid(const FString& MatchType) const;
+	TArray<FOnlineSessionSearchResult> CachedSearchResults;
+	FString CachedMatchType;
+	FString LastSearchMatchType;
+	double CachedSearchTime{ -1.0 };
+	int32 SessionResultsPageSize{ 20 };
+	double SessionResultsCacheTTL{ 10.0 };
+
+	//
+	// Session lifecycle
+	//
+	void SetSessionState(EMultiplayerSessionState NewState);
+	void CreateSessionFromTemplate();
+	void BuildSessionSettingsTemplate();
+	EMultiplayerSessionState SessionState{ EMultiplayerSessionState::NoSession };
+
+	// Settings shared by every session we host, built once. Only the per-session values are patched in before creating
+	FOnlineSessionSettings SessionSettingsTemplate;
+
+	//
+	// Phase timing
+	//
+	void BeginPhase(EMultiplayerSessionPhase Phase);
+	void EndPhase(EMultiplayerSessionPhase Phase, bool bWasSuccessful);
+	double PhaseStartTimes[static_cast<int32>(EMultiplayerSessionPhase::Count)]{};
+	FMultiplayerSessionsLatencyHistogram PhaseLatency[static_cast<int32>(EMultiplayerSessionPhase::Count)];
 
 	bool bCreateSessionOnDestroy{ false };
 	int32 LastNumPublicConnections;
@@ -5,4 +5,21 @@
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Revolution2, "Revolution2" );
 
-DEFINE_LOG_CATEGORY(LogRevolution2)
\ No newline at end of file
+DEFINE_LOG_CATEGORY(LogRevolution2)
+DEFINE_LOG_CATEGORY(LogRevolution2View)
+
+DEFINE_STAT(STAT_ShooterSceneQueries);
+
+/** Never reset, so readers only ever diff it */
+static uint64 ShooterSceneQueryTotal = 0;
+
+void RecordShooterSceneQueries(int32 Count)
+{
+	INC_DWORD_STAT_BY(STAT_ShooterSceneQueries, Count);
+	ShooterSceneQueryTotal += Count;
+}
+
+uint64 GetShooterSceneQueryTotal()
+{
+	return ShooterSceneQueryTotal;
+}
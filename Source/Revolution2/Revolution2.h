@@ -5,4 +5,40 @@
 #include "CoreMinimal.h"
 
 /** Main log category used across the project */
-DECLARE_LOG_CATEGORY_EXTERN(LogRevolution2, Log, All);
\ No newline at end of file
+DECLARE_LOG_CATEGORY_EXTERN(LogRevolution2, Log, All);
+
+/** View mode and input diagnostics. Only errors are compiled into Shipping and Test builds */
+#if UE_BUILD_SHIPPING || UE_BUILD_TEST
+DECLARE_LOG_CATEGORY_EXTERN(LogRevolution2View, Error, Error);
+#else
+DECLARE_LOG_CATEGORY_EXTERN(LogRevolution2View, Log, All);
+#endif
+
+/** On screen view diagnostics. Compiled out of Shipping and Test builds, and skipped on dedicated servers */
+#if UE_BUILD_SHIPPING || UE_BUILD_TEST
+#define REVOLUTION2_VIEW_SCREEN_MESSAGE(Duration, Color, Message)
+#else
+#define REVOLUTION2_VIEW_SCREEN_MESSAGE(Duration, Color, Message) \
+	do \
+	{ \
+		if (GEngine && !IsRunningDedicatedServer()) \
+		{ \
+			GEngine->AddOnScreenDebugMessage(-1, Duration, Color, Message); \
+		} \
+	} while (0)
+#endif
+
+/** Stat group for the Shooter variant. Use "stat Shooter" to display it */
+DECLARE_STATS_GROUP(TEXT("Shooter"), STATGROUP_Shooter, STATCAT_Advanced);
+
+/** Stat group for the shared character code. Use "stat Revolution2" to display it */
+DECLARE_STATS_GROUP(TEXT("Revolution2"), STATGROUP_Revolution2, STATCAT_Advanced);
+
+/** Scene queries issued by gameplay code each frame */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Scene Queries"), STAT_ShooterSceneQueries, STATGROUP_Shooter, REVOLUTION2_API);
+
+/** Counts scene queries issued by gameplay code, both in "stat Shooter" and in a running total */
+REVOLUTION2_API void RecordShooterSceneQueries(int32 Count = 1);
+
+/** Returns the number of scene queries recorded since startup. Diff two readings to get the queries in between */
+REVOLUTION2_API uint64 GetShooterSceneQueryTotal();
\ No newline at end of file
@@ -12,8 +12,15 @@
 #include "Engine/World.h"
 #include "Engine/Engine.h"
 #include "GameFramework/PlayerController.h"
+#include "TopDownAimComponent.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
 #include "Revolution2.h"
 
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("View Mode Changes"), STAT_Revolution2ViewModeChanges, STATGROUP_Revolution2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("First Person Views Applied"), STAT_Revolution2FirstPersonViews, STATGROUP_Revolution2);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Top Down Views Applied"), STAT_Revolution2TopDownViews, STATGROUP_Revolution2);
+
 ARevolution2Character::ARevolution2Character()
 {
 	// Enable tick for top down aim updates
@@ -68,6 +75,9 @@ ARevolution2Character::ARevolution2Character()
 	// Initially deactivate top down camera (first person is default)
 	TopDownCameraComponent->SetActive(false);
 
+	// Create the top down aim component
+	TopDownAim = CreateDefaultSubobject<UTopDownAimComponent>(TEXT("Top Down Aim"));
+
 	// Initialize view mode
 	CurrentViewMode = EViewMode::FirstPerson;
 }
@@ -135,19 +145,13 @@ void ARevolution2Character::SetupPlayerInputComponent(UInputComponent* PlayerInp
 		if (ToggleViewAction)
 		{
 			EnhancedInputComponent->BindAction(ToggleViewAction, ETriggerEvent::Started, this, &ARevolution2Character::ToggleViewMode);
-			UE_LOG(LogRevolution2, Warning, TEXT("ToggleViewAction bound successfully"));
-			if (GEngine)
-			{
-				GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Cyan, TEXT("ToggleViewAction 输入绑定成功"));
-			}
+			UE_LOG(LogRevolution2View, Verbose, TEXT("ToggleViewAction bound successfully"));
+			REVOLUTION2_VIEW_SCREEN_MESSAGE(5.0f, FColor::Cyan, TEXT("ToggleViewAction 输入绑定成功"));
 		}
 		else
 		{
-			UE_LOG(LogRevolution2, Error, TEXT("ToggleViewAction is null! Please assign it in the character blueprint."));
-			if (GEngine)
-			{
-				GEngine->AddOnScreenDebugMessage(-1, 10.0f, FColor::Red, TEXT("错误: ToggleViewAction 未设置！请在角色蓝图中分配 Input Action"));
-			}
+			UE_LOG(LogRevolution2View, Error, TEXT("ToggleViewAction is null! Please assign it in the character blueprint."));
+			REVOLUTION2_VIEW_SCREEN_MESSAGE(10.0f, FColor::Red, TEXT("错误: ToggleViewAction 未设置！请在角色蓝图中分配 Input Action"));
 		}
 
 		// Click move for top down mode
@@ -170,7 +174,8 @@ void ARevolution2Character::MoveInput(const FInputActionValue& Value)
 
 	if (CurrentViewMode == EViewMode::TopDown && !MovementVector.IsNearlyZero())
 	{
-		bHasClickMoveTarget = false;
+		// direct movement overrides the click move
+		CancelClickMove();
 	}
 
 	// pass the axis values to the move input
@@ -239,33 +244,29 @@ void ARevolution2Character::DoJumpEnd()
 
 void ARevolution2Character::ToggleViewMode()
 {
-	UE_LOG(LogRevolution2, Warning, TEXT("ToggleViewMode called, current mode: %d"), (int32)CurrentViewMode);
+	UE_LOG(LogRevolution2View, Verbose, TEXT("ToggleViewMode called, current mode: %d"), (int32)CurrentViewMode);
 	
 	if (CurrentViewMode == EViewMode::FirstPerson)
 	{
-		UE_LOG(LogRevolution2, Warning, TEXT("Switching to TopDown view mode"));
-		if (GEngine)
-		{
-			GEngine->AddOnScreenDebugMessage(-1, 3.0f, FColor::Yellow, TEXT("切换到俯视角模式"));
-		}
+		UE_LOG(LogRevolution2View, Log, TEXT("Switching to TopDown view mode"));
+		REVOLUTION2_VIEW_SCREEN_MESSAGE(3.0f, FColor::Yellow, TEXT("切换到俯视角模式"));
 		SetViewMode(EViewMode::TopDown);
 	}
 	else
 	{
-		UE_LOG(LogRevolution2, Warning, TEXT("Switching to FirstPerson view mode"));
-		if (GEngine)
-		{
-			GEngine->AddOnScreenDebugMessage(-1, 3.0f, FColor::Yellow, TEXT("切换到第一人称模式"));
-		}
+		UE_LOG(LogRevolution2View, Log, TEXT("Switching to FirstPerson view mode"));
+		REVOLUTION2_VIEW_SCREEN_MESSAGE(3.0f, FColor::Yellow, TEXT("切换到第一人称模式"));
 		SetViewMode(EViewMode::FirstPerson);
 	}
 }
 
 void ARevolution2Character::SetViewMode(EViewMode NewViewMode)
 {
-	UE_LOG(LogRevolution2, Warning, TEXT("SetViewMode called with: %d"), (int32)NewViewMode);
+	UE_LOG(LogRevolution2View, Verbose, TEXT("SetViewMode called with: %d"), (int32)NewViewMode);
+	INC_DWORD_STAT(STAT_Revolution2ViewModeChanges);
+
 	CurrentViewMode = NewViewMode;
-	bHasClickMoveTarget = false;
+	CancelClickMove();
 	bHasTopDownAimLocation = false;
 
 	if (CurrentViewMode == EViewMode::FirstPerson)
@@ -329,14 +330,36 @@ void ARevolution2Character::UpdateClickMove()
 	}
 
 	const FVector CurrentLocation = GetActorLocation();
-	const float DistanceToTarget = FVector::Dist(CurrentLocation, ClickMoveTargetLocation);
+	const float DistanceToTarget = FVector::Dist2D(CurrentLocation, ClickMoveTargetLocation);
 	if (DistanceToTarget <= ClickMoveAcceptanceRadius)
 	{
-		bHasClickMoveTarget = false;
+		CancelClickMove();
 		return;
 	}
 
-	MoveToLocation(ClickMoveTargetLocation);
+	// re-path if the navmesh changed under the cached path
+	if (ClickMovePath.IsValid() && !ClickMovePath->IsUpToDate())
+	{
+		ClickMovePath.Reset();
+		RequestClickMovePath();
+	}
+
+	// steer straight to the target if we have no path, or while the path request is in flight
+	if (!ClickMovePath.IsValid())
+	{
+		MoveToLocation(ClickMoveTargetLocation);
+		return;
+	}
+
+	const TArray<FNavPathPoint>& PathPoints = ClickMovePath->GetPathPoints();
+
+	// skip the corners we've already reached. The last point is handled by the acceptance radius
+	while (ClickMovePathIndex < PathPoints.Num() - 1 && FVector::Dist2D(CurrentLocation, PathPoints[ClickMovePathIndex].Location) <= ClickMoveCornerRadius)
+	{
+		++ClickMovePathIndex;
+	}
+
+	MoveToLocation(PathPoints.IsValidIndex(ClickMovePathIndex) ? PathPoints[ClickMovePathIndex].Location : ClickMoveTargetLocation);
 }
 
 void ARevolution2Character::OnClickMove(const FInputActionValue& Value)
@@ -356,7 +379,103 @@ void ARevolution2Character::OnClickMove(const FInputActionValue& Value)
 
 	ClickMoveTargetLocation = AimLocation;
 	bHasClickMoveTarget = true;
-	MoveToLocation(ClickMoveTargetLocation);
+	RequestClickMovePath();
+	UpdateClickMove();
+}
+
+void ARevolution2Character::RequestClickMovePath()
+{
+	if (!bUseNavigationForClickMove)
+	{
+		return;
+	}
+
+	// keep the cached path or the request in flight if the target barely moved
+	const bool bHasPathOrRequest = ClickMovePath.IsValid() || ClickMovePathQueryId != INVALID_NAVQUERYID;
+	if (bHasPathOrRequest && FVector::Dist(ClickMovePathGoal, ClickMoveTargetLocation) <= ClickMoveRepathDistance)
+	{
+		return;
+	}
+
+	// navigation may not be available, e.g. on clients without client side navigation
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!NavSys)
+	{
+		return;
+	}
+
+	const ANavigationData* NavData = NavSys->GetNavDataForProps(GetNavAgentPropertiesRef(), GetNavAgentLocation());
+	if (!NavData)
+	{
+		return;
+	}
+
+	// drop the old path and any request still in flight
+	if (ClickMovePathQueryId != INVALID_NAVQUERYID)
+	{
+		NavSys->AbortAsyncFindPathRequest(ClickMovePathQueryId);
+	}
+
+	ClickMovePath.Reset();
+	ClickMovePathGoal = ClickMoveTargetLocation;
+
+	FPathFindingQuery Query(this, *NavData, GetNavAgentLocation(), ClickMoveTargetLocation, NavData->GetDefaultQueryFilter());
+	ClickMovePathQueryId = NavSys->FindPathAsync(GetNavAgentPropertiesRef(), Query, FNavPathQueryDelegate::CreateUObject(this, &ARevolution2Character::OnClickMovePathFound));
+}
+
+void ARevolution2Character::OnClickMovePathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+	// ignore results for requests we've since replaced or cancelled
+	if (QueryId != ClickMovePathQueryId)
+	{
+		return;
+	}
+
+	ClickMovePathQueryId = INVALID_NAVQUERYID;
+
+	if (Result != ENavigationQueryResult::Success || !Path.IsValid() || Path->GetPathPoints().Num() == 0)
+	{
+		// no path, so we keep steering straight to the target
+		return;
+	}
+
+	// we re-path ourselves when the navmesh changes, so only flag the path as out of date
+	Path->EnableRecalculationOnInvalidation(false);
+
+	if (ANavigationData* NavData = Path->GetNavigationDataUsed())
+	{
+		NavData->RegisterActivePath(Path);
+	}
+
+	ClickMovePath = Path;
+
+	// the target is off the navmesh or cut off from us, so stop at the closest reachable point instead of pushing against the edge
+	if (Path->IsPartial())
+	{
+		ClickMoveTargetLocation = Path->GetEndLocation();
+		ClickMovePathGoal = ClickMoveTargetLocation;
+	}
+
+	// the first point is our own location
+	ClickMovePathIndex = FMath::Min(1, Path->GetPathPoints().Num() - 1);
+}
+
+void ARevolution2Character::CancelClickMove()
+{
+	bHasClickMoveTarget = false;
+	ClickMovePath.Reset();
+	ClickMovePathIndex = 0;
+
+	// abort the request in flight
+	if (ClickMovePathQueryId != INVALID_NAVQUERYID)
+	{
+		if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+		{
+			NavSys->AbortAsyncFindPathRequest(ClickMovePathQueryId);
+		}
+
+		ClickMovePathQueryId = INVALID_NAVQUERYID;
+	}
 }
 
 void ARevolution2Character::MoveToLocation(const FVector& TargetLocation)
@@ -371,7 +490,7 @@ void ARevolution2Character::MoveToLocation(const FVector& TargetLocation)
 	FVector Direction = (TargetLocation - CurrentLocation).GetSafeNormal();
 	
 	// Only move if we're not already at the target (within a small threshold)
-	float DistanceToTarget = FVector::Dist(CurrentLocation, TargetLocation);
+	float DistanceToTarget = FVector::Dist2D(CurrentLocation, TargetLocation);
 	if (DistanceToTarget > ClickMoveAcceptanceRadius)
 	{
 		// Calculate movement direction in world space
@@ -386,11 +505,9 @@ void ARevolution2Character::MoveToLocation(const FVector& TargetLocation)
 
 void ARevolution2Character::ApplyFirstPersonView(APlayerController* PC)
 {
-	UE_LOG(LogRevolution2, Warning, TEXT("View mode set to FirstPerson"));
-	if (GEngine)
-	{
-		GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Green, TEXT("视角模式: 第一人称"));
-	}
+	UE_LOG(LogRevolution2View, Log, TEXT("View mode set to FirstPerson"));
+	REVOLUTION2_VIEW_SCREEN_MESSAGE(2.0f, FColor::Green, TEXT("视角模式: 第一人称"));
+	INC_DWORD_STAT(STAT_Revolution2FirstPersonViews);
 
 	SetCameraActive(TopDownCameraComponent, false);
 	SetCameraActive(FirstPersonCameraComponent, true);
@@ -418,11 +535,9 @@ void ARevolution2Character::ApplyFirstPersonView(APlayerController* PC)
 
 void ARevolution2Character::ApplyTopDownView(APlayerController* PC)
 {
-	UE_LOG(LogRevolution2, Warning, TEXT("View mode set to TopDown"));
-	if (GEngine)
-	{
-		GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Green, TEXT("视角模式: 俯视角"));
-	}
+	UE_LOG(LogRevolution2View, Log, TEXT("View mode set to TopDown"));
+	REVOLUTION2_VIEW_SCREEN_MESSAGE(2.0f, FColor::Green, TEXT("视角模式: 俯视角"));
+	INC_DWORD_STAT(STAT_Revolution2TopDownViews);
 
 	ApplyTopDownCameraSettings();
 
@@ -449,7 +564,7 @@ void ARevolution2Character::ApplyTopDownView(APlayerController* PC)
 	}
 	else
 	{
-		UE_LOG(LogRevolution2, Error, TEXT("GetMesh() is null in TopDown mode!"));
+		UE_LOG(LogRevolution2View, Error, TEXT("GetMesh() is null in TopDown mode!"));
 	}
 
 	SetMouseInputMode(PC, true);
@@ -479,49 +594,8 @@ void ARevolution2Character::ApplyTopDownCameraSettings()
 
 bool ARevolution2Character::TryGetTopDownAimLocation(FVector& OutAimLocation) const
 {
-	const APlayerController* PC = Cast<APlayerController>(GetController());
-	if (!PC)
-	{
-		return false;
-	}
-
-	// Get mouse position
-	float MouseX = 0.0f;
-	float MouseY = 0.0f;
-	if (!PC->GetMousePosition(MouseX, MouseY))
-	{
-		return false;
-	}
-
-	// Deproject screen position to world
-	FVector WorldLocation;
-	FVector WorldDirection;
-	if (!PC->DeprojectScreenPositionToWorld(MouseX, MouseY, WorldLocation, WorldDirection))
-	{
-		return false;
-	}
-
-	// Perform line trace to find ground
-	FHitResult HitResult;
-	const FVector Start = WorldLocation;
-	const FVector End = Start + (WorldDirection * 10000.0f);
-
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
-
-	UWorld* World = GetWorld();
-	if (!World)
-	{
-		return false;
-	}
-
-	if (!World->LineTraceSingleByChannel(HitResult, Start, End, ECC_Visibility, QueryParams))
-	{
-		return false;
-	}
-
-	OutAimLocation = HitResult.ImpactPoint;
-	return true;
+	// the aim component caches the cursor trace, so this is cheap to call multiple times per frame
+	return TopDownAim && TopDownAim->ResolveAimLocation(OutAimLocation);
 }
 
 void ARevolution2Character::SetTopDownAimLocation(const FVector& AimLocation)
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "Logging/LogMacros.h"
+#include "AI/Navigation/NavigationTypes.h"
 #include "Revolution2Character.generated.h"
 
 class UInputComponent;
@@ -14,6 +15,7 @@ class USpringArmComponent;
 class UInputAction;
 struct FInputActionValue;
 class APlayerController;
+class UTopDownAimComponent;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
 
@@ -52,6 +54,10 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
 	UCameraComponent* TopDownCameraComponent;
 
+	/** Resolves and caches the world location under the cursor in top down mode */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UTopDownAimComponent* TopDownAim;
+
 protected:
 
 	/** Jump Input Action */
@@ -94,6 +100,18 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Camera|TopDown", meta = (ClampMin = 0, ClampMax = 1000, Units = "cm"))
 	float ClickMoveAcceptanceRadius = 50.0f;
 
+	/** If true, click moves follow a navmesh path found asynchronously. Otherwise, or if no path is found, the character steers straight to the target */
+	UPROPERTY(EditAnywhere, Category="Camera|TopDown")
+	bool bUseNavigationForClickMove = true;
+
+	/** Distance at which an intermediate path corner is considered reached */
+	UPROPERTY(EditAnywhere, Category="Camera|TopDown", meta = (ClampMin = 0, ClampMax = 1000, Units = "cm"))
+	float ClickMoveCornerRadius = 30.0f;
+
+	/** Min distance the click move target has to change before a new path is requested */
+	UPROPERTY(EditAnywhere, Category="Camera|TopDown", meta = (ClampMin = 0, ClampMax = 1000, Units = "cm"))
+	float ClickMoveRepathDistance = 50.0f;
+
 	/** Active view mode changed delegate */
 	UPROPERTY(BlueprintAssignable, Category="Camera")
 	FViewModeChangedDelegate OnViewModeChanged;
@@ -109,6 +127,18 @@ protected:
 
 	/** Whether click move target is active */
 	bool bHasClickMoveTarget = false;
+
+	/** Cached navmesh path for the click move */
+	FNavPathSharedPtr ClickMovePath;
+
+	/** Index of the path corner we're currently moving towards */
+	int32 ClickMovePathIndex = 0;
+
+	/** Goal the cached path, or the path request in flight, was computed for */
+	FVector ClickMovePathGoal = FVector::ZeroVector;
+
+	/** ID of the async path request in flight */
+	uint32 ClickMovePathQueryId = INVALID_NAVQUERYID;
 	
 public:
 	ARevolution2Character();
@@ -164,6 +194,15 @@ protected:
 	/** Move to target location */
 	void MoveToLocation(const FVector& TargetLocation);
 
+	/** Requests an async navmesh path to the click move target, unless the cached path already leads there */
+	void RequestClickMovePath();
+
+	/** Called when the async path request completes */
+	void OnClickMovePathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
+	/** Stops the click move and discards its path and any path request in flight */
+	void CancelClickMove();
+
 	/** Update top down aim direction based on mouse position */
 	void UpdateTopDownAim();
 
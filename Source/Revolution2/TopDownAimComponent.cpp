@@ -0,0 +1,226 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "TopDownAimComponent.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Revolution2.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Top Down Aim Traces"), STAT_TopDownAimTraces, STATGROUP_Revolution2);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Top Down Aim Cache Hits"), STAT_TopDownAimCacheHits, STATGROUP_Revolution2);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Top Down Aim Ground Plane"), STAT_TopDownAimGroundPlane, STATGROUP_Revolution2);
+
+UTopDownAimComponent::UTopDownAimComponent()
+{
+	// the aim is resolved on demand, so there's no need to tick
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+bool UTopDownAimComponent::ResolveAimLocation(FVector& OutAimLocation)
+{
+	// reuse the result if we already resolved the aim this frame
+	if (ResolvedFrame != GFrameCounter)
+	{
+		ResolvedFrame = GFrameCounter;
+		TracesThisFrame = 0;
+
+		bResolved = ResolveAimLocationInternal(ResolvedLocation);
+	}
+
+	OutAimLocation = ResolvedLocation;
+	return bResolved;
+}
+
+void UTopDownAimComponent::InvalidateCache()
+{
+	ResolvedFrame = 0;
+	bHasTrace = false;
+	bTraceHit = false;
+	PendingTrace = FTraceHandle();
+}
+
+bool UTopDownAimComponent::ResolveAimLocationInternal(FVector& OutAimLocation)
+{
+	FVector RayOrigin, RayDirection;
+	if (!DeprojectCursor(RayOrigin, RayDirection))
+	{
+		return false;
+	}
+
+	if (!bGroundPlaneOnly)
+	{
+		// pick up any async trace results from the previous frame
+		if (bUseAsyncTrace)
+		{
+			ReadAsyncTrace();
+		}
+
+		// can we reuse the cached trace?
+		const bool bRayMoved = !RayOrigin.Equals(TracedRayOrigin, RayOriginTolerance) || !RayDirection.Equals(TracedRayDirection, RayDirectionTolerance);
+		const bool bCacheExpired = GFrameCounter - TracedFrame > static_cast<uint64>(MaxCachedFrames);
+
+		if (bHasTrace && !bRayMoved && !bCacheExpired)
+		{
+			INC_DWORD_STAT(STAT_TopDownAimCacheHits);
+
+			if (bTraceHit)
+			{
+				OutAimLocation = TraceLocation;
+				return true;
+			}
+
+		} else if (bUseAsyncTrace) {
+
+			// only keep one async trace in flight
+			if (!PendingTrace.IsValid())
+			{
+				TraceAsync(RayOrigin, RayDirection);
+			}
+
+		} else {
+
+			TraceSync(RayOrigin, RayDirection);
+
+			if (bTraceHit)
+			{
+				OutAimLocation = TraceLocation;
+				return true;
+			}
+		}
+	}
+
+	// the trace missed or hasn't come back yet, so intersect with the ground plane
+	if ((bFallbackToGroundPlane || bGroundPlaneOnly) && IntersectGroundPlane(RayOrigin, RayDirection, OutAimLocation))
+	{
+		INC_DWORD_STAT(STAT_TopDownAimGroundPlane);
+		return true;
+	}
+
+	// as a last resort, use a stale async result while the new one is in flight
+	if (bUseAsyncTrace && bTraceHit)
+	{
+		OutAimLocation = TraceLocation;
+		return true;
+	}
+
+	return false;
+}
+
+bool UTopDownAimComponent::DeprojectCursor(FVector& OutRayOrigin, FVector& OutRayDirection) const
+{
+	const APawn* OwnerPawn = Cast<APawn>(GetOwner());
+	const APlayerController* PC = OwnerPawn ? Cast<APlayerController>(OwnerPawn->GetController()) : nullptr;
+
+	if (!PC)
+	{
+		return false;
+	}
+
+	// Get mouse position
+	float MouseX = 0.0f;
+	float MouseY = 0.0f;
+	if (!PC->GetMousePosition(MouseX, MouseY))
+	{
+		return false;
+	}
+
+	// Deproject screen position to world
+	return PC->DeprojectScreenPositionToWorld(MouseX, MouseY, OutRayOrigin, OutRayDirection);
+}
+
+void UTopDownAimComponent::TraceSync(const FVector& RayOrigin, const FVector& RayDirection)
+{
+	FHitResult HitResult;
+	const FVector End = RayOrigin + (RayDirection * TraceDistance);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TopDownAim));
+	QueryParams.AddIgnoredActor(GetOwner());
+
+	bTraceHit = GetWorld()->LineTraceSingleByChannel(HitResult, RayOrigin, End, TraceChannel, QueryParams);
+	TraceLocation = HitResult.ImpactPoint;
+
+	TracedRayOrigin = RayOrigin;
+	TracedRayDirection = RayDirection;
+	TracedFrame = GFrameCounter;
+	bHasTrace = true;
+
+	++TracesThisFrame;
+	INC_DWORD_STAT(STAT_TopDownAimTraces);
+}
+
+void UTopDownAimComponent::TraceAsync(const FVector& RayOrigin, const FVector& RayDirection)
+{
+	const FVector End = RayOrigin + (RayDirection * TraceDistance);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TopDownAimAsync));
+	QueryParams.AddIgnoredActor(GetOwner());
+
+	PendingTrace = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, RayOrigin, End, TraceChannel, QueryParams);
+	PendingRayOrigin = RayOrigin;
+	PendingRayDirection = RayDirection;
+	PendingFrame = GFrameCounter;
+
+	++TracesThisFrame;
+	INC_DWORD_STAT(STAT_TopDownAimTraces);
+}
+
+void UTopDownAimComponent::ReadAsyncTrace()
+{
+	if (!PendingTrace.IsValid())
+	{
+		return;
+	}
+
+	UWorld* World = GetWorld();
+
+	// the handle expired without being read, so drop it and trace again
+	if (!World->IsTraceHandleValid(PendingTrace, false))
+	{
+		PendingTrace = FTraceHandle();
+		return;
+	}
+
+	FTraceDatum Datum;
+	if (!World->QueryTraceData(PendingTrace, Datum))
+	{
+		// still in flight
+		return;
+	}
+
+	const FHitResult* BlockingHit = Datum.OutHits.FindByPredicate([](const FHitResult& Hit) { return Hit.bBlockingHit; });
+
+	bTraceHit = BlockingHit != nullptr;
+	TraceLocation = BlockingHit ? BlockingHit->ImpactPoint : FVector::ZeroVector;
+
+	TracedRayOrigin = PendingRayOrigin;
+	TracedRayDirection = PendingRayDirection;
+	TracedFrame = PendingFrame;
+	bHasTrace = true;
+
+	PendingTrace = FTraceHandle();
+}
+
+bool UTopDownAimComponent::IntersectGroundPlane(const FVector& RayOrigin, const FVector& RayDirection, FVector& OutLocation) const
+{
+	// a ray parallel to the ground never intersects it
+	if (FMath::IsNearlyZero(RayDirection.Z))
+	{
+		return false;
+	}
+
+	// place the plane at the owner's feet
+	const AActor* Owner = GetOwner();
+	const float PlaneZ = Owner->GetActorLocation().Z - Owner->GetSimpleCollisionHalfHeight();
+
+	const float Distance = (PlaneZ - RayOrigin.Z) / RayDirection.Z;
+
+	// ignore intersections behind the camera or beyond the trace distance
+	if (Distance < 0.0f || Distance > TraceDistance)
+	{
+		return false;
+	}
+
+	OutLocation = RayOrigin + (RayDirection * Distance);
+	return true;
+}
@@ -0,0 +1,126 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "WorldCollision.h"
+#include "TopDownAimComponent.generated.h"
+
+/**
+ *  Resolves the world location under the mouse cursor for top down aiming and click moves.
+ *  Reuses the last trace while the cursor ray hasn't moved, falls back to an analytic ground plane intersection,
+ *  and can optionally run the trace asynchronously. Does at most one trace per frame no matter how many times it's queried.
+ */
+UCLASS(ClassGroup=(Revolution2), meta=(BlueprintSpawnableComponent))
+class REVOLUTION2_API UTopDownAimComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Collision channel used for the cursor trace */
+	UPROPERTY(EditAnywhere, Category="Aim")
+	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Visibility;
+
+	/** Max distance for the cursor trace */
+	UPROPERTY(EditAnywhere, Category="Aim", meta = (ClampMin = 0, ClampMax = 100000, Units = "cm"))
+	float TraceDistance = 10000.0f;
+
+	/** If true, the cursor trace runs asynchronously and its result is read on the next frame. The last result, or the ground plane if enabled, is used meanwhile */
+	UPROPERTY(EditAnywhere, Category="Aim")
+	bool bUseAsyncTrace = false;
+
+	/** If true, the cursor ray is intersected with a ground plane at the owner's feet when the trace misses or is still in flight.
+	 *  Off by default, since aiming past a ledge or into the sky would otherwise snap to a point under the owner's feet */
+	UPROPERTY(EditAnywhere, Category="Aim")
+	bool bFallbackToGroundPlane = false;
+
+	/** If true, skip traces entirely and only use the ground plane. Cheapest option for flat levels */
+	UPROPERTY(EditAnywhere, Category="Aim")
+	bool bGroundPlaneOnly = false;
+
+	/** Max distance the cursor ray origin can move before the cached trace is discarded */
+	UPROPERTY(EditAnywhere, Category="Aim|Cache", meta = (ClampMin = 0, ClampMax = 100, Units = "cm"))
+	float RayOriginTolerance = 0.5f;
+
+	/** Max change in the cursor ray direction before the cached trace is discarded */
+	UPROPERTY(EditAnywhere, Category="Aim|Cache", meta = (ClampMin = 0, ClampMax = 1))
+	float RayDirectionTolerance = 0.0001f;
+
+	/** Max number of frames a cached trace can be reused for, so moving geometry under a still cursor is picked up */
+	UPROPERTY(EditAnywhere, Category="Aim|Cache", meta = (ClampMin = 0, ClampMax = 600))
+	int32 MaxCachedFrames = 10;
+
+	/** Frame the aim location was last resolved on */
+	uint64 ResolvedFrame = 0;
+
+	/** Aim location resolved this frame */
+	FVector ResolvedLocation = FVector::ZeroVector;
+
+	/** If true, the aim location resolved this frame is valid */
+	bool bResolved = false;
+
+	/** Cursor ray used for the cached trace */
+	FVector TracedRayOrigin = FVector::ZeroVector;
+	FVector TracedRayDirection = FVector::ZeroVector;
+
+	/** Frame the cached trace was issued on */
+	uint64 TracedFrame = 0;
+
+	/** If true, a trace result is cached */
+	bool bHasTrace = false;
+
+	/** If true, the cached trace hit something */
+	bool bTraceHit = false;
+
+	/** Impact point of the cached trace */
+	FVector TraceLocation = FVector::ZeroVector;
+
+	/** Async trace in flight, if any */
+	FTraceHandle PendingTrace;
+
+	/** Cursor ray used for the async trace in flight */
+	FVector PendingRayOrigin = FVector::ZeroVector;
+	FVector PendingRayDirection = FVector::ZeroVector;
+
+	/** Frame the async trace in flight was issued on */
+	uint64 PendingFrame = 0;
+
+	/** Number of traces issued this frame */
+	int32 TracesThisFrame = 0;
+
+public:
+
+	/** Constructor */
+	UTopDownAimComponent();
+
+	/** Returns the world location under the cursor. Repeated calls within the same frame return the same result without tracing */
+	bool ResolveAimLocation(FVector& OutAimLocation);
+
+	/** Discards the cached trace, forcing the next query to trace again */
+	void InvalidateCache();
+
+	/** Returns the number of traces issued this frame */
+	int32 GetTracesThisFrame() const { return ResolvedFrame == GFrameCounter ? TracesThisFrame : 0; }
+
+protected:
+
+	/** Resolves the aim location without the per-frame cache */
+	bool ResolveAimLocationInternal(FVector& OutAimLocation);
+
+	/** Deprojects the mouse cursor into a world space ray */
+	bool DeprojectCursor(FVector& OutRayOrigin, FVector& OutRayDirection) const;
+
+	/** Runs a synchronous trace along the ray and caches the result */
+	void TraceSync(const FVector& RayOrigin, const FVector& RayDirection);
+
+	/** Issues an async trace along the ray */
+	void TraceAsync(const FVector& RayOrigin, const FVector& RayDirection);
+
+	/** Reads back the async trace in flight, if it's available */
+	void ReadAsyncTrace();
+
+	/** Intersects the ray with a horizontal plane at the owner's feet */
+	bool IntersectGroundPlane(const FVector& RayOrigin, const FVector& RayDirection, FVector& OutLocation) const;
+};
@@ -2,8 +2,8 @@
 
 
 #include "Variant_Horror/HorrorCharacter.h"
+#include "Variant_Horror/HorrorStaminaSubsystem.h"
 #include "Engine/World.h"
-#include "TimerManager.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Camera/CameraComponent.h"
 #include "Components/SpotLightComponent.h"
@@ -28,22 +28,32 @@ void AHorrorCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// initialize sprint meter to max
-	SprintMeter = SprintTime;
-
 	// Initialize the walk speed
 	GetCharacterMovement()->MaxWalkSpeed = WalkSpeed;
 
-	// start the sprint tick timer
-	GetWorld()->GetTimerManager().SetTimer(SprintTimer, this, &AHorrorCharacter::SprintFixedTick, SprintFixedTickTime, true);
+	// register with the stamina subsystem, starting with a full sprint meter
+	if (UHorrorStaminaSubsystem* StaminaSubsystem = GetWorld()->GetSubsystem<UHorrorStaminaSubsystem>())
+	{
+		FHorrorStaminaState StaminaState;
+		StaminaState.MaxMeter = FMath::Max(SprintTime, KINDA_SMALL_NUMBER);
+		StaminaState.Meter = StaminaState.MaxMeter;
+		StaminaState.FixedStep = FMath::Max(SprintFixedTickTime, KINDA_SMALL_NUMBER);
+		StaminaState.WalkSpeed = WalkSpeed;
+		StaminaState.BroadcastThreshold = SprintMeterBroadcastThreshold;
+
+		StaminaSubsystem->RegisterCharacter(this, StaminaState);
+	}
 }
 
 void AHorrorCharacter::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	// clear the sprint timer
-	GetWorld()->GetTimerManager().ClearTimer(SprintTimer);
+	// unregister from the stamina subsystem
+	if (UHorrorStaminaSubsystem* StaminaSubsystem = GetWorld()->GetSubsystem<UHorrorStaminaSubsystem>())
+	{
+		StaminaSubsystem->UnregisterCharacter(this);
+	}
 }
 
 void AHorrorCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -67,6 +77,11 @@ void AHorrorCharacter::DoStartSprint()
 	// set the sprinting flag
 	bSprinting = true;
 
+	if (UHorrorStaminaSubsystem* StaminaSubsystem = GetWorld()->GetSubsystem<UHorrorStaminaSubsystem>())
+	{
+		StaminaSubsystem->SetSprinting(this, true);
+	}
+
 	// are we out of recovery mode?
 	if (!bRecovering)
 	{
@@ -84,6 +99,11 @@ void AHorrorCharacter::DoEndSprint()
 	// set the sprinting flag
 	bSprinting = false;
 
+	if (UHorrorStaminaSubsystem* StaminaSubsystem = GetWorld()->GetSubsystem<UHorrorStaminaSubsystem>())
+	{
+		StaminaSubsystem->SetSprinting(this, false);
+	}
+
 	// are we out of recovery mode?
 	if (!bRecovering)
 	{
@@ -95,49 +115,23 @@ void AHorrorCharacter::DoEndSprint()
 	}
 }
 
-void AHorrorCharacter::SprintFixedTick()
+void AHorrorCharacter::OnStaminaDepleted()
 {
-	// are we out of recovery, still have stamina and are moving faster than our walk speed?
-	if (bSprinting && !bRecovering && GetVelocity().Length() > WalkSpeed)
-	{
+	// raise the recovering flag
+	bRecovering = true;
 
-		// do we still have meter to burn?
-		if (SprintMeter > 0.0f)
-		{
-			// update the sprint meter
-			SprintMeter = FMath::Max(SprintMeter - SprintFixedTickTime, 0.0f);
-
-			// have we run out of stamina?
-			if (SprintMeter <= 0.0f)
-			{
-				// raise the recovering flag
-				bRecovering = true;
-
-				// set the recovering walk speed
-				GetCharacterMovement()->MaxWalkSpeed = RecoveringWalkSpeed;
-			}
-		}
-		
-	} else {
-
-		// recover stamina
-		SprintMeter = FMath::Min(SprintMeter + SprintFixedTickTime, SprintTime);
-
-		if (SprintMeter >= SprintTime)
-		{
-			// lower the recovering flag
-			bRecovering = false;
-
-			// set the walk or sprint speed depending on whether the sprint button is down
-			GetCharacterMovement()->MaxWalkSpeed = bSprinting ? SprintSpeed : WalkSpeed;
-
-			// update the sprint state depending on whether the button is down or not
-			OnSprintStateChanged.Broadcast(bSprinting);
-		}
+	// set the recovering walk speed
+	GetCharacterMovement()->MaxWalkSpeed = RecoveringWalkSpeed;
+}
 
-	}
+void AHorrorCharacter::OnStaminaRecovered()
+{
+	// lower the recovering flag
+	bRecovering = false;
 
-	// broadcast the sprint meter updated delegate
-	OnSprintMeterUpdated.Broadcast(SprintMeter / SprintTime);
+	// set the walk or sprint speed depending on whether the sprint button is down
+	GetCharacterMovement()->MaxWalkSpeed = bSprinting ? SprintSpeed : WalkSpeed;
 
+	// update the sprint state depending on whether the button is down or not
+	OnSprintStateChanged.Broadcast(bSprinting);
 }
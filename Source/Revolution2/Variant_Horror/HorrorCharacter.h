@@ -41,13 +41,10 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Walk")
 	float WalkSpeed = 250.0f;
 
-	/** Time interval for sprinting stamina ticks */
+	/** Time interval for sprinting stamina ticks. Stamina is updated by the stamina subsystem at this fixed step */
 	UPROPERTY(EditAnywhere, Category="Sprint", meta = (ClampMin = 0, ClampMax = 1, Units = "s"))
 	float SprintFixedTickTime = 0.03333f;
 
-	/** Sprint stamina amount. Maxes at SprintTime */
-	float SprintMeter = 0.0f;
-
 	/** How long we can sprint for, in seconds */
 	UPROPERTY(EditAnywhere, Category="Sprint", meta = (ClampMin = 0, ClampMax = 10, Units = "s"))
 	float SprintTime = 3.0f;
@@ -64,8 +61,9 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Recovery", meta = (ClampMin = 0, ClampMax = 10, Units = "s"))
 	float RecoveryTime = 0.0f;
 
-	/** Sprint tick timer */
-	FTimerHandle SprintTimer;
+	/** Min change in the sprint meter percentage before OnSprintMeterUpdated is broadcast again */
+	UPROPERTY(EditAnywhere, Category="Sprint", meta = (ClampMin = 0, ClampMax = 1))
+	float SprintMeterBroadcastThreshold = 0.01f;
 
 public:
 
@@ -99,6 +97,11 @@ protected:
 	UFUNCTION(BlueprintCallable, Category="Input")
 	void DoEndSprint();
 
-	/** Called while sprinting at a fixed time interval */
-	void SprintFixedTick();
+public:
+
+	/** Called by the stamina subsystem when the sprint meter runs out */
+	void OnStaminaDepleted();
+
+	/** Called by the stamina subsystem when the sprint meter has fully recovered */
+	void OnStaminaRecovered();
 };
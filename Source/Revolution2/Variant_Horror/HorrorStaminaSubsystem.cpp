@@ -0,0 +1,146 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Horror/HorrorStaminaSubsystem.h"
+#include "Variant_Horror/HorrorCharacter.h"
+#include "Revolution2.h"
+
+DECLARE_CYCLE_STAT(TEXT("Stamina Tick"), STAT_HorrorStamina, STATGROUP_Revolution2);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Stamina Meter Broadcasts"), STAT_HorrorStaminaBroadcasts, STATGROUP_Revolution2);
+
+void UHorrorStaminaSubsystem::RegisterCharacter(AHorrorCharacter* Character, const FHorrorStaminaState& InitialState)
+{
+	if (!IsValid(Character) || StateIndices.Contains(Character))
+	{
+		return;
+	}
+
+	FHorrorStaminaState& State = States.Add_GetRef(InitialState);
+	State.Character = Character;
+	State.LastBroadcastPercent = State.Meter / State.MaxMeter;
+
+	StateIndices.Add(Character, States.Num() - 1);
+
+	// later broadcasts only report changes, so the UI needs the starting value up front
+	Character->OnSprintMeterUpdated.Broadcast(State.LastBroadcastPercent);
+
+	INC_DWORD_STAT(STAT_HorrorStaminaBroadcasts);
+}
+
+void UHorrorStaminaSubsystem::UnregisterCharacter(AHorrorCharacter* Character)
+{
+	int32 Index = INDEX_NONE;
+
+	if (!StateIndices.RemoveAndCopyValue(Character, Index))
+	{
+		return;
+	}
+
+	States.RemoveAtSwap(Index, EAllowShrinking::No);
+
+	// fix up the index of the state that was swapped in
+	if (States.IsValidIndex(Index))
+	{
+		StateIndices.Add(States[Index].Character.Get(), Index);
+	}
+}
+
+void UHorrorStaminaSubsystem::SetSprinting(AHorrorCharacter* Character, bool bSprinting)
+{
+	if (const int32* Index = StateIndices.Find(Character))
+	{
+		States[*Index].bSprinting = bSprinting;
+	}
+}
+
+void UHorrorStaminaSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_HorrorStamina);
+
+	for (FHorrorStaminaState& State : States)
+	{
+		AHorrorCharacter* Character = State.Character.Get();
+
+		if (!Character)
+		{
+			continue;
+		}
+
+		// run as many fixed steps as fit in the accumulated time
+		State.Accumulator += DeltaTime;
+
+		if (State.Accumulator < State.FixedStep)
+		{
+			continue;
+		}
+
+		while (State.Accumulator >= State.FixedStep)
+		{
+			State.Accumulator -= State.FixedStep;
+			StepState(State, Character);
+		}
+
+		BroadcastMeter(State, Character);
+	}
+}
+
+bool UHorrorStaminaSubsystem::IsTickable() const
+{
+	return States.Num() > 0;
+}
+
+TStatId UHorrorStaminaSubsystem::GetStatId() const
+{
+	return GET_STATID(STAT_HorrorStamina);
+}
+
+void UHorrorStaminaSubsystem::StepState(FHorrorStaminaState& State, AHorrorCharacter* Character)
+{
+	// are we out of recovery, still have stamina and are moving faster than our walk speed?
+	if (State.bSprinting && !State.bRecovering && Character->GetVelocity().Length() > State.WalkSpeed)
+	{
+		// do we still have meter to burn?
+		if (State.Meter > 0.0f)
+		{
+			// update the sprint meter
+			State.Meter = FMath::Max(State.Meter - State.FixedStep, 0.0f);
+
+			// have we run out of stamina?
+			if (State.Meter <= 0.0f)
+			{
+				State.bRecovering = true;
+				Character->OnStaminaDepleted();
+			}
+		}
+
+	} else if (State.Meter < State.MaxMeter) {
+
+		// recover stamina
+		State.Meter = FMath::Min(State.Meter + State.FixedStep, State.MaxMeter);
+
+		// have we fully recovered?
+		if (State.Meter >= State.MaxMeter && State.bRecovering)
+		{
+			State.bRecovering = false;
+			Character->OnStaminaRecovered();
+		}
+	}
+}
+
+void UHorrorStaminaSubsystem::BroadcastMeter(FHorrorStaminaState& State, AHorrorCharacter* Character)
+{
+	const float Percent = State.Meter / State.MaxMeter;
+
+	// always report reaching empty or full so the UI settles on the exact value
+	const bool bReachedLimit = (Percent <= 0.0f || Percent >= 1.0f) && Percent != State.LastBroadcastPercent;
+
+	if (bReachedLimit || FMath::Abs(Percent - State.LastBroadcastPercent) >= State.BroadcastThreshold)
+	{
+		State.LastBroadcastPercent = Percent;
+		Character->OnSprintMeterUpdated.Broadcast(Percent);
+
+		INC_DWORD_STAT(STAT_HorrorStaminaBroadcasts);
+	}
+}
@@ -0,0 +1,87 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "HorrorStaminaSubsystem.generated.h"
+
+class AHorrorCharacter;
+
+/**
+ *  Sprint stamina state for a single character
+ */
+struct FHorrorStaminaState
+{
+	/** Character that owns this state */
+	TWeakObjectPtr<AHorrorCharacter> Character;
+
+	/** Current sprint stamina. Maxes at MaxMeter */
+	float Meter = 0.0f;
+
+	/** Max sprint stamina, in seconds of sprinting */
+	float MaxMeter = 1.0f;
+
+	/** Fixed time step for stamina updates */
+	float FixedStep = 0.03333f;
+
+	/** Time accumulated towards the next fixed step */
+	float Accumulator = 0.0f;
+
+	/** Speed the character has to exceed to burn stamina while sprinting */
+	float WalkSpeed = 0.0f;
+
+	/** Min change in the meter percentage before it's broadcast again */
+	float BroadcastThreshold = 0.01f;
+
+	/** Last meter percentage broadcast to the character */
+	float LastBroadcastPercent = 1.0f;
+
+	/** If true, the sprint input is held */
+	bool bSprinting = false;
+
+	/** If true, stamina ran out and must fully recover before sprinting again */
+	bool bRecovering = false;
+};
+
+/**
+ *  Updates the sprint stamina of every horror character in one fixed step pass
+ *  Meter updates are only broadcast when they change by more than a threshold or reach empty or full
+ */
+UCLASS()
+class REVOLUTION2_API UHorrorStaminaSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Packed stamina state for every registered character */
+	TArray<FHorrorStaminaState> States;
+
+	/** Index of each character's state */
+	TMap<TObjectKey<AHorrorCharacter>, int32> StateIndices;
+
+public:
+
+	/** Adds a character with the given initial stamina state and broadcasts its starting meter */
+	void RegisterCharacter(AHorrorCharacter* Character, const FHorrorStaminaState& InitialState);
+
+	/** Removes a character */
+	void UnregisterCharacter(AHorrorCharacter* Character);
+
+	/** Updates the sprint input for a character */
+	void SetSprinting(AHorrorCharacter* Character, bool bSprinting);
+
+	//~Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~End FTickableGameObject interface
+
+protected:
+
+	/** Runs a single fixed step for a stamina state */
+	static void StepState(FHorrorStaminaState& State, AHorrorCharacter* Character);
+
+	/** Broadcasts the meter if it changed enough or reached empty or full */
+	static void BroadcastMeter(FHorrorStaminaState& State, AHorrorCharacter* Character);
+};
@@ -7,6 +7,13 @@
 #include "Perception/AIPerceptionComponent.h"
 #include "Navigation/PathFollowingComponent.h"
 #include "AI/Navigation/PathFollowingAgentInterface.h"
+#include "TimerManager.h"
+#include "Engine/World.h"
+#include "Revolution2.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Updates Coalesced"), STAT_ShooterPerceptionCoalesced, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Batches"), STAT_ShooterPerceptionBatches, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception LOS Traces"), STAT_ShooterPerceptionTraces, STATGROUP_Shooter);
 
 AShooterAIController::AShooterAIController()
 {
@@ -29,7 +36,7 @@ void AShooterAIController::OnPossess(APawn* InPawn)
 	if (AShooterNPC* NPC = Cast<AShooterNPC>(InPawn))
 	{
 		// add the team tag to the pawn
-		NPC->Tags.Add(TeamTag);
+		NPC->Tags.AddUnique(TeamTag);
 
 		// subscribe to the pawn's OnDeath delegate
 		NPC->OnPawnDeath.AddDynamic(this, &AShooterAIController::OnPawnDeath);
@@ -61,14 +68,198 @@ void AShooterAIController::ClearCurrentTarget()
 	TargetEnemy = nullptr;
 }
 
+void AShooterAIController::SetUpdateIntervals(float StateTreeTickInterval, float PerceptionInterval)
+{
+	// ticking less often accumulates the delta time, so the StateTree still sees the real elapsed time
+	StateTreeAI->SetComponentTickInterval(StateTreeTickInterval);
+
+	PerceptionUpdateInterval = PerceptionInterval;
+}
+
+void AShooterAIController::SetPerceptionFilter(FName SenseTag, float LineOfSightCone)
+{
+	PerceptionSenseTag = SenseTag;
+	PerceptionLineOfSightCone = LineOfSightCone;
+}
+
 void AShooterAIController::OnPerceptionUpdated(AActor* Actor, FAIStimulus Stimulus)
 {
-	// pass the data to the StateTree delegate hook
-	OnShooterPerceptionUpdated.ExecuteIfBound(Actor, Stimulus);
+	// ignore actors the StateTree doesn't care about
+	if (!Actor || !Actor->ActorHasTag(PerceptionSenseTag))
+	{
+		return;
+	}
+
+	// keep only the strongest update for each actor until the next flush
+	if (FShooterPerceptionUpdate* Pending = PendingPerceptionUpdates.FindByPredicate([Actor](const FShooterPerceptionUpdate& Update) { return Update.Actor == Actor; }))
+	{
+		if (Stimulus.Strength >= Pending->Stimulus.Strength)
+		{
+			Pending->Stimulus = Stimulus;
+		}
+
+		INC_DWORD_STAT(STAT_ShooterPerceptionCoalesced);
+
+	} else {
+
+		FShooterPerceptionUpdate& Update = PendingPerceptionUpdates.AddDefaulted_GetRef();
+		Update.Actor = Actor;
+		Update.Stimulus = Stimulus;
+	}
+
+	// flush once per frame, or once per interval for less significant NPCs
+	if (!PerceptionFlushTimer.IsValid())
+	{
+		if (PerceptionUpdateInterval > 0.0f)
+		{
+			GetWorldTimerManager().SetTimer(PerceptionFlushTimer, this, &AShooterAIController::FlushPerceptionUpdates, PerceptionUpdateInterval, false);
+
+		} else {
+
+			PerceptionFlushTimer = GetWorldTimerManager().SetTimerForNextTick(this, &AShooterAIController::FlushPerceptionUpdates);
+		}
+	}
 }
 
 void AShooterAIController::OnPerceptionForgotten(AActor* Actor)
 {
+	// drop any batched update for the forgotten actor
+	PendingPerceptionUpdates.RemoveAll([Actor](const FShooterPerceptionUpdate& Update) { return Update.Actor == Actor; });
+	TracingPerceptionUpdates.RemoveAll([Actor](const FShooterPerceptionUpdate& Update) { return Update.Actor == Actor; });
+
 	// pass the data to the StateTree delegate hook
 	OnShooterPerceptionForgotten.ExecuteIfBound(Actor);
 }
+
+void AShooterAIController::FlushPerceptionUpdates()
+{
+	GetWorldTimerManager().ClearTimer(PerceptionFlushTimer);
+	PerceptionFlushTimer.Invalidate();
+
+	const APawn* ControlledPawn = GetPawn();
+
+	if (!ControlledPawn || PendingPerceptionUpdates.Num() == 0)
+	{
+		PendingPerceptionUpdates.Reset();
+		return;
+	}
+
+	const FVector PawnLocation = ControlledPawn->GetActorLocation();
+	const FVector PawnForward = ControlledPawn->GetActorForwardVector();
+	const float MaxDot = FMath::Cos(FMath::DegreesToRadians(PerceptionLineOfSightCone));
+
+	int32 NumTraces = 0;
+
+	// updates outside the cone have nothing to wait for
+	TArray<FShooterPerceptionUpdate> Untraced;
+
+	for (FShooterPerceptionUpdate& Update : PendingPerceptionUpdates)
+	{
+		const AActor* Actor = Update.Actor.Get();
+
+		if (!Actor)
+		{
+			continue;
+		}
+
+		// infer the angle from the dot product between the pawn facing and the stimulus direction
+		const FVector StimulusDir = (Update.Stimulus.StimulusLocation - PawnLocation).GetSafeNormal();
+
+		// only stimuli within our perception cone need a line of sight trace
+		if (FVector::DotProduct(StimulusDir, PawnForward) >= MaxDot)
+		{
+			FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShooterPerceptionLineOfSight));
+			QueryParams.AddIgnoredActor(ControlledPawn);
+			QueryParams.AddIgnoredActor(Actor);
+
+			Update.TraceHandle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, PawnLocation, Actor->GetActorLocation(), ECC_Visibility, QueryParams);
+			Update.TraceFrame = GFrameCounter;
+			++NumTraces;
+
+			TracingPerceptionUpdates.Add(MoveTemp(Update));
+
+		} else {
+
+			Untraced.Add(MoveTemp(Update));
+		}
+	}
+
+	PendingPerceptionUpdates.Reset();
+
+	INC_DWORD_STAT_BY(STAT_ShooterPerceptionTraces, NumTraces);
+	RecordShooterSceneQueries(NumTraces);
+
+	// async traces resolve on the next frame. Earlier batches may still be waiting on theirs
+	if (NumTraces > 0 && !PerceptionTraceTimer.IsValid())
+	{
+		PerceptionTraceTimer = GetWorldTimerManager().SetTimerForNextTick(this, &AShooterAIController::ResolvePerceptionUpdates);
+	}
+
+	BroadcastPerceptionUpdates(Untraced);
+}
+
+void AShooterAIController::ResolvePerceptionUpdates()
+{
+	PerceptionTraceTimer.Invalidate();
+
+	TArray<FShooterPerceptionUpdate> Updates;
+
+	// traces issued this frame haven't run yet, so leave them for the next one
+	for (int32 i = 0; i < TracingPerceptionUpdates.Num(); ++i)
+	{
+		FShooterPerceptionUpdate& Update = TracingPerceptionUpdates[i];
+
+		if (Update.TraceFrame >= GFrameCounter)
+		{
+			continue;
+		}
+
+		// we have direct line of sight if this trace is unobstructed. Unavailable results count as obstructed
+		FTraceDatum TraceData;
+
+		if (GetWorld()->QueryTraceData(Update.TraceHandle, TraceData))
+		{
+			Update.bHasLineOfSight = !TraceData.OutHits.ContainsByPredicate([](const FHitResult& Hit) { return Hit.bBlockingHit; });
+		}
+
+		Updates.Add(MoveTemp(Update));
+		TracingPerceptionUpdates.RemoveAt(i--, EAllowShrinking::No);
+	}
+
+	if (TracingPerceptionUpdates.Num() > 0)
+	{
+		PerceptionTraceTimer = GetWorldTimerManager().SetTimerForNextTick(this, &AShooterAIController::ResolvePerceptionUpdates);
+	}
+
+	BroadcastPerceptionUpdates(Updates);
+}
+
+void AShooterAIController::BroadcastPerceptionUpdates(TArray<FShooterPerceptionUpdate>& Updates)
+{
+	// drop updates for actors that went away while tracing
+	Updates.RemoveAll([](const FShooterPerceptionUpdate& Update) { return !Update.Actor.IsValid(); });
+
+	// updates are in flush order, so the last one for an actor is the most recent
+	for (int32 i = Updates.Num() - 1; i > 0; --i)
+	{
+		const TWeakObjectPtr<AActor> Actor = Updates[i].Actor;
+
+		for (int32 j = i - 1; j >= 0; --j)
+		{
+			if (Updates[j].Actor == Actor)
+			{
+				Updates.RemoveAt(j, EAllowShrinking::No);
+				--i;
+				INC_DWORD_STAT(STAT_ShooterPerceptionCoalesced);
+			}
+		}
+	}
+
+	if (Updates.Num() > 0)
+	{
+		INC_DWORD_STAT(STAT_ShooterPerceptionBatches);
+
+		// pass the whole batch to the StateTree delegate hook
+		OnShooterPerceptionUpdated.ExecuteIfBound(Updates);
+	}
+}
@@ -4,13 +4,35 @@
 
 #include "CoreMinimal.h"
 #include "AIController.h"
+#include "Perception/AIPerceptionTypes.h"
+#include "WorldCollision.h"
 #include "ShooterAIController.generated.h"
 
 class UStateTreeAIComponent;
 class UAIPerceptionComponent;
-struct FAIStimulus;
 
-DECLARE_DELEGATE_TwoParams(FShooterPerceptionUpdatedDelegate, AActor*, const FAIStimulus&);
+/**
+ *  A coalesced perception update for a single actor, with its line of sight already resolved
+ */
+struct FShooterPerceptionUpdate
+{
+	/** Sensed actor */
+	TWeakObjectPtr<AActor> Actor;
+
+	/** Strongest stimulus received for the actor since the last flush */
+	FAIStimulus Stimulus;
+
+	/** True if the stimulus was within the line of sight cone and the trace to the actor was unobstructed */
+	bool bHasLineOfSight = false;
+
+	/** Async line of sight trace, if one was issued */
+	FTraceHandle TraceHandle;
+
+	/** Frame the trace was issued on. Its result can only be read back on a later frame */
+	uint64 TraceFrame = 0;
+};
+
+DECLARE_DELEGATE_OneParam(FShooterPerceptionUpdatedDelegate, TConstArrayView<FShooterPerceptionUpdate>);
 DECLARE_DELEGATE_OneParam(FShooterPerceptionForgottenDelegate, AActor*);
 
 /**
@@ -38,9 +60,30 @@ protected:
 	/** Enemy currently being targeted */
 	TObjectPtr<AActor> TargetEnemy;
 
+	/** Time to batch perception updates for before passing them to the StateTree. Zero batches them for a single frame */
+	float PerceptionUpdateInterval = 0.0f;
+
+	/** Tag required on sensed actors for their updates to be passed on */
+	FName PerceptionSenseTag = FName("Player");
+
+	/** Line of sight cone half angle. Stimuli outside of it don't get a line of sight trace */
+	float PerceptionLineOfSightCone = 85.0f;
+
+	/** Strongest perception update per actor, waiting for the next flush */
+	TArray<FShooterPerceptionUpdate> PendingPerceptionUpdates;
+
+	/** Flushed perception updates waiting for their line of sight traces, oldest first */
+	TArray<FShooterPerceptionUpdate> TracingPerceptionUpdates;
+
+	/** Timer to flush the batched perception updates */
+	FTimerHandle PerceptionFlushTimer;
+
+	/** Timer to read back the line of sight traces */
+	FTimerHandle PerceptionTraceTimer;
+
 public:
 
-	/** Called when an AI perception has been updated. StateTree task delegate hook */
+	/** Called with the coalesced AI perception updates. StateTree task delegate hook */
 	FShooterPerceptionUpdatedDelegate OnShooterPerceptionUpdated;
 
 	/** Called when an AI perception has been forgotten. StateTree task delegate hook */
@@ -73,6 +116,12 @@ public:
 	/** Returns the targeted enemy */
 	AActor* GetCurrentTarget() const { return TargetEnemy; };
 
+	/** Sets how often the StateTree ticks and perception updates are passed to it. Zero updates every frame */
+	void SetUpdateIntervals(float StateTreeTickInterval, float PerceptionInterval);
+
+	/** Sets which perception updates are passed on and the cone to check line of sight in */
+	void SetPerceptionFilter(FName SenseTag, float LineOfSightCone);
+
 protected:
 
 	/** Called when the AI perception component updates a perception on a given actor */
@@ -82,4 +131,14 @@ protected:
 	/** Called when the AI perception component forgets a given actor */
 	UFUNCTION()
 	void OnPerceptionForgotten(AActor* Actor);
+
+	/** Issues one batch of async line of sight traces for the pending perception updates.
+	 *  Updates that don't need a trace are passed on right away */
+	void FlushPerceptionUpdates();
+
+	/** Reads back the line of sight traces issued on earlier frames and passes those updates to the StateTree */
+	void ResolvePerceptionUpdates();
+
+	/** Passes a batch of updates to the StateTree, keeping only the latest one for each actor */
+	void BroadcastPerceptionUpdates(TArray<FShooterPerceptionUpdate>& Updates);
 };
@@ -0,0 +1,194 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterCorpseSubsystem.h"
+#include "ShooterNPC.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "Revolution2.h"
+
+DECLARE_CYCLE_STAT(TEXT("Ragdoll Budget"), STAT_ShooterRagdollBudget, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Simulating Ragdolls"), STAT_ShooterSimulatingRagdolls, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled NPCs"), STAT_ShooterPooledNPCs, STATGROUP_Shooter);
+
+void UShooterCorpseSubsystem::Deinitialize()
+{
+	UE_LOG(LogRevolution2, Log, TEXT("Corpses: %d ragdolls started, peak %d simulating, %d frozen early to stay in budget. NPC pool: %d hits, %d misses, %d releases, %d destroyed over the cap"),
+		RagdollsStarted, PeakRagdolls, RagdollsFrozenOverBudget, PoolHits, PoolMisses, PoolReleases, PoolOverflows);
+
+	Ragdolls.Empty();
+	Pools.Empty();
+
+	Super::Deinitialize();
+}
+
+void UShooterCorpseSubsystem::StartRagdoll(AShooterNPC* NPC)
+{
+	if (!IsValid(NPC))
+	{
+		return;
+	}
+
+	// freeze the oldest ragdolls to make room for the new one
+	while (Ragdolls.Num() >= MaxSimulatingRagdolls)
+	{
+		if (AShooterNPC* OldestNPC = Ragdolls[0].NPC.Get())
+		{
+			OldestNPC->FreezeRagdoll();
+			++RagdollsFrozenOverBudget;
+		}
+
+		Ragdolls.RemoveAt(0, EAllowShrinking::No);
+	}
+
+	NPC->StartRagdoll();
+
+	FShooterRagdoll& Ragdoll = Ragdolls.AddDefaulted_GetRef();
+	Ragdoll.NPC = NPC;
+	Ragdoll.StartTime = GetWorld()->GetTimeSeconds();
+
+	++RagdollsStarted;
+	PeakRagdolls = FMath::Max(PeakRagdolls, Ragdolls.Num());
+
+	SET_DWORD_STAT(STAT_ShooterSimulatingRagdolls, Ragdolls.Num());
+}
+
+void UShooterCorpseSubsystem::ReleaseNPC(AShooterNPC* NPC)
+{
+	if (!IsValid(NPC))
+	{
+		return;
+	}
+
+	RemoveRagdoll(NPC);
+
+	FShooterNPCPoolEntry& Pool = Pools.FindOrAdd(NPC->GetClass());
+
+	// drop NPCs destroyed while pooled before checking the cap
+	const int32 NumDestroyed = Pool.Available.RemoveAll([](const AShooterNPC* PooledNPC) { return !IsValid(PooledNPC); });
+	DEC_DWORD_STAT_BY(STAT_ShooterPooledNPCs, NumDestroyed);
+
+	// a full pool already covers the next wave, so this one isn't worth keeping around
+	if (Pool.Available.Num() >= MaxPooledNPCsPerClass)
+	{
+		++PoolOverflows;
+		NPC->Destroy();
+		return;
+	}
+
+	NPC->DeactivateForPool();
+
+	Pool.Available.Add(NPC);
+	++PoolReleases;
+
+	INC_DWORD_STAT(STAT_ShooterPooledNPCs);
+}
+
+AShooterNPC* UShooterCorpseSubsystem::AcquireNPC(TSubclassOf<AShooterNPC> NPCClass, const FTransform& SpawnTransform)
+{
+	if (!NPCClass)
+	{
+		return nullptr;
+	}
+
+	// try to reuse a pooled NPC first
+	if (FShooterNPCPoolEntry* Pool = Pools.Find(NPCClass))
+	{
+		while (Pool->Available.Num() > 0)
+		{
+			AShooterNPC* NPC = Pool->Available.Pop(EAllowShrinking::No);
+
+			// skip NPCs that were destroyed while pooled, e.g. by a level unload
+			if (IsValid(NPC))
+			{
+				DEC_DWORD_STAT(STAT_ShooterPooledNPCs);
+				++PoolHits;
+
+				NPC->SetReturnToPool(true);
+				NPC->ReactivateFromPool(SpawnTransform);
+				return NPC;
+			}
+
+			DEC_DWORD_STAT(STAT_ShooterPooledNPCs);
+		}
+	}
+
+	// nothing to reuse, so spawn a new NPC
+	++PoolMisses;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+
+	AShooterNPC* NPC = GetWorld()->SpawnActor<AShooterNPC>(NPCClass, SpawnTransform, SpawnParams);
+
+	if (!NPC)
+	{
+		return nullptr;
+	}
+
+	// whoever acquires from the pool is expected to come back for more, so recycle this one when it dies
+	NPC->SetReturnToPool(true);
+
+	// NPCs placed in the level are possessed automatically, but spawned ones may not be
+	if (!NPC->GetController())
+	{
+		NPC->SpawnDefaultController();
+	}
+
+	return NPC;
+}
+
+void UShooterCorpseSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterRagdollBudget);
+
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+
+	for (int32 i = Ragdolls.Num() - 1; i >= 0; --i)
+	{
+		FShooterRagdoll& Ragdoll = Ragdolls[i];
+		AShooterNPC* NPC = Ragdoll.NPC.Get();
+
+		if (!NPC)
+		{
+			Ragdolls.RemoveAt(i, EAllowShrinking::No);
+			continue;
+		}
+
+		// track how long the body has been at rest
+		if (NPC->GetMesh()->GetPhysicsLinearVelocity().SizeSquared() < FMath::Square(SettleSpeed))
+		{
+			Ragdoll.SettledTime += DeltaTime;
+
+		} else {
+
+			Ragdoll.SettledTime = 0.0f;
+		}
+
+		// freeze settled ragdolls, and any that have been simulating for too long
+		if (Ragdoll.SettledTime >= SettleTime || CurrentTime - Ragdoll.StartTime >= MaxSimulationTime)
+		{
+			NPC->FreezeRagdoll();
+			Ragdolls.RemoveAt(i, EAllowShrinking::No);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_ShooterSimulatingRagdolls, Ragdolls.Num());
+}
+
+bool UShooterCorpseSubsystem::IsTickable() const
+{
+	return Ragdolls.Num() > 0;
+}
+
+TStatId UShooterCorpseSubsystem::GetStatId() const
+{
+	return GET_STATID(STAT_ShooterRagdollBudget);
+}
+
+void UShooterCorpseSubsystem::RemoveRagdoll(AShooterNPC* NPC)
+{
+	Ragdolls.RemoveAll([NPC](const FShooterRagdoll& Ragdoll) { return Ragdoll.NPC == NPC; });
+}
@@ -0,0 +1,110 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterCorpseSubsystem.generated.h"
+
+class AShooterNPC;
+
+/**
+ *  A dead NPC whose ragdoll is simulating
+ */
+struct FShooterRagdoll
+{
+	/** NPC the ragdoll belongs to */
+	TWeakObjectPtr<AShooterNPC> NPC;
+
+	/** Time the ragdoll started simulating */
+	double StartTime = 0.0;
+
+	/** Time the ragdoll has been moving slower than the settle speed */
+	float SettledTime = 0.0f;
+};
+
+/**
+ *  Inactive NPCs of a single class waiting to be reused
+ */
+USTRUCT()
+struct FShooterNPCPoolEntry
+{
+	GENERATED_BODY()
+
+	/** NPCs currently sitting in the pool */
+	UPROPERTY()
+	TArray<TObjectPtr<AShooterNPC>> Available;
+};
+
+/**
+ *  Manages dead NPCs
+ *  Caps the number of concurrently simulating ragdolls and freezes them once they settle,
+ *  then recycles the NPCs and their weapons through a pool instead of destroying and respawning them
+ */
+UCLASS()
+class REVOLUTION2_API UShooterCorpseSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Ragdolls currently simulating, oldest first */
+	TArray<FShooterRagdoll> Ragdolls;
+
+	/** Inactive NPCs by class */
+	UPROPERTY()
+	TMap<TSubclassOf<AShooterNPC>, FShooterNPCPoolEntry> Pools;
+
+	/** Pool usage counters */
+	int32 PoolHits = 0;
+	int32 PoolMisses = 0;
+	int32 PoolReleases = 0;
+	int32 PoolOverflows = 0;
+
+	/** Ragdoll counters */
+	int32 RagdollsStarted = 0;
+	int32 RagdollsFrozenOverBudget = 0;
+	int32 PeakRagdolls = 0;
+
+public:
+
+	/** Max number of ragdolls simulating at once. Starting a new one over budget freezes the oldest */
+	static constexpr int32 MaxSimulatingRagdolls = 8;
+
+	/** Ragdolls moving slower than this are considered settled */
+	static constexpr float SettleSpeed = 20.0f;
+
+	/** Time a ragdoll has to stay settled before it's frozen */
+	static constexpr float SettleTime = 0.5f;
+
+	/** Max time a ragdoll can simulate before it's frozen regardless of its speed */
+	static constexpr float MaxSimulationTime = 4.0f;
+
+	/** Max number of inactive NPCs kept per class. NPCs released past this are destroyed */
+	static constexpr int32 MaxPooledNPCsPerClass = 32;
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+	/** Starts simulating the NPC's ragdoll, freezing the oldest one if we're over budget */
+	void StartRagdoll(AShooterNPC* NPC);
+
+	/** Deactivates a dead NPC and returns it to the pool, or destroys it if the pool is full */
+	void ReleaseNPC(AShooterNPC* NPC);
+
+	/** Returns a live NPC of the given class at the given transform. Spawns a new one if the pool is empty.
+	 *  The NPC goes back to the pool when it dies */
+	AShooterNPC* AcquireNPC(TSubclassOf<AShooterNPC> NPCClass, const FTransform& SpawnTransform);
+
+	/** Returns the number of ragdolls currently simulating */
+	int32 GetNumSimulatingRagdolls() const { return Ragdolls.Num(); }
+
+	//~Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~End FTickableGameObject interface
+
+protected:
+
+	/** Removes the NPC from the simulating ragdolls, if it's there */
+	void RemoveRagdoll(AShooterNPC* NPC);
+};
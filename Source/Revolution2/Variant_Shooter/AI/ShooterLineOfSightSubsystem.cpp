@@ -0,0 +1,215 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterLineOfSightSubsystem.h"
+#include "Revolution2Character.h"
+#include "Camera/CameraComponent.h"
+#include "Engine/World.h"
+#include "Revolution2.h"
+
+DECLARE_CYCLE_STAT(TEXT("Line of Sight Tick"), STAT_ShooterLineOfSight, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Line of Sight Queries"), STAT_ShooterLineOfSightQueries, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Line of Sight Async Traces"), STAT_ShooterLineOfSightAsyncTraces, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Line of Sight Sync Traces"), STAT_ShooterLineOfSightSyncTraces, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Line of Sight Cached Pairs"), STAT_ShooterLineOfSightPairs, STATGROUP_Shooter);
+
+bool UShooterLineOfSightSubsystem::GetLineOfSight(ARevolution2Character* Observer, AActor* Target, int32 NumChecks, int32 MaxAgeFrames)
+{
+	INC_DWORD_STAT(STAT_ShooterLineOfSightQueries);
+
+	FShooterLineOfSightEntry& Entry = Entries.FindOrAdd(TPair<TObjectKey<AActor>, TObjectKey<AActor>>(Observer, Target));
+
+	Entry.LastQueryFrame = GFrameCounter;
+	Entry.NumChecks = NumChecks;
+
+	// is this the first time we see this pair?
+	if (Entry.ResultFrame == 0)
+	{
+		Entry.Observer = Observer;
+		Entry.Target = Target;
+
+		// resolve right away so the caller doesn't have to wait for the batch
+		Entry.bHasLineOfSight = ComputeLineOfSight(Observer, Target, NumChecks);
+		Entry.ResultFrame = GFrameCounter;
+
+	} else if (GFrameCounter - Entry.ResultFrame >= static_cast<uint64>(FMath::Max(MaxAgeFrames, 1))) {
+
+		// the result is stale, so refresh it with the next batch
+		Entry.bRefreshRequested = true;
+	}
+
+	return Entry.bHasLineOfSight;
+}
+
+bool UShooterLineOfSightSubsystem::ComputeLineOfSight(const ARevolution2Character* Observer, const AActor* Target, int32 NumChecks)
+{
+	// get the target's bounding box
+	FVector CenterOfMass, Extent;
+	Target->GetActorBounds(true, CenterOfMass, Extent, false);
+
+	FVector Start;
+	TArray<FVector, TInlineAllocator<8>> Ends;
+	BuildTraceEndpoints(Observer, FBox::BuildAABB(CenterOfMass, Extent), NumChecks, Start, Ends);
+
+	// ignore the character and target. We want to ensure there's an unobstructed trace not counting them
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShooterLineOfSight));
+	QueryParams.AddIgnoredActor(Observer);
+	QueryParams.AddIgnoredActor(Target);
+
+	FHitResult OutHit;
+
+	for (const FVector& End : Ends)
+	{
+		INC_DWORD_STAT(STAT_ShooterLineOfSightSyncTraces);
+		RecordShooterSceneQueries();
+
+		// we only need one unobstructed trace, so terminate early
+		if (!Observer->GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility, QueryParams))
+		{
+			return true;
+		}
+	}
+
+	// no line of sight found
+	return false;
+}
+
+void UShooterLineOfSightSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterLineOfSight);
+
+	// target bounds are only valid for this frame's batch
+	TargetBounds.Reset();
+
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		FShooterLineOfSightEntry& Entry = It.Value();
+
+		// evict pairs whose actors are gone or that nobody has asked about in a while
+		if (!Entry.Observer.IsValid() || !Entry.Target.IsValid() || GFrameCounter - Entry.LastQueryFrame > EvictionFrames)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		// read back the traces issued on a previous frame
+		if (Entry.PendingTraces.Num() > 0 && !ReadPendingTraces(Entry))
+		{
+			// the results are still in flight
+			continue;
+		}
+
+		// issue a new batch of traces if the result went stale
+		if (Entry.bRefreshRequested)
+		{
+			Entry.bRefreshRequested = false;
+			IssueTraces(Entry);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_ShooterLineOfSightPairs, Entries.Num());
+}
+
+bool UShooterLineOfSightSubsystem::IsTickable() const
+{
+	return Entries.Num() > 0;
+}
+
+TStatId UShooterLineOfSightSubsystem::GetStatId() const
+{
+	return GET_STATID(STAT_ShooterLineOfSight);
+}
+
+bool UShooterLineOfSightSubsystem::ReadPendingTraces(FShooterLineOfSightEntry& Entry)
+{
+	UWorld* World = GetWorld();
+
+	// async trace results are only available on the frame after they were issued
+	if (!World->IsTraceHandleValid(Entry.PendingTraces[0], false))
+	{
+		// the handles expired without being read, so drop them and keep the last result
+		Entry.PendingTraces.Reset();
+		Entry.bRefreshRequested = true;
+		return true;
+	}
+
+	bool bHasLineOfSight = false;
+
+	for (const FTraceHandle& Handle : Entry.PendingTraces)
+	{
+		FTraceDatum Datum;
+
+		if (!World->QueryTraceData(Handle, Datum))
+		{
+			return false;
+		}
+
+		// we only need one unobstructed trace
+		if (!Datum.OutHits.ContainsByPredicate([](const FHitResult& Hit) { return Hit.bBlockingHit; }))
+		{
+			bHasLineOfSight = true;
+		}
+	}
+
+	Entry.bHasLineOfSight = bHasLineOfSight;
+	Entry.ResultFrame = GFrameCounter;
+	Entry.PendingTraces.Reset();
+
+	return true;
+}
+
+void UShooterLineOfSightSubsystem::IssueTraces(FShooterLineOfSightEntry& Entry)
+{
+	ARevolution2Character* Observer = Entry.Observer.Get();
+	AActor* Target = Entry.Target.Get();
+
+	FVector Start;
+	TArray<FVector, TInlineAllocator<8>> Ends;
+	BuildTraceEndpoints(Observer, GetTargetBounds(Target), Entry.NumChecks, Start, Ends);
+
+	// ignore the character and target. We want to ensure there's an unobstructed trace not counting them
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShooterLineOfSightAsync));
+	QueryParams.AddIgnoredActor(Observer);
+	QueryParams.AddIgnoredActor(Target);
+
+	for (const FVector& End : Ends)
+	{
+		Entry.PendingTraces.Add(GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, ECC_Visibility, QueryParams));
+	}
+
+	INC_DWORD_STAT_BY(STAT_ShooterLineOfSightAsyncTraces, Ends.Num());
+	RecordShooterSceneQueries(Ends.Num());
+}
+
+const FBox& UShooterLineOfSightSubsystem::GetTargetBounds(const AActor* Target)
+{
+	if (const FBox* FoundBounds = TargetBounds.Find(Target))
+	{
+		return *FoundBounds;
+	}
+
+	FVector CenterOfMass, Extent;
+	Target->GetActorBounds(true, CenterOfMass, Extent, false);
+
+	return TargetBounds.Add(Target, FBox::BuildAABB(CenterOfMass, Extent));
+}
+
+void UShooterLineOfSightSubsystem::BuildTraceEndpoints(const ARevolution2Character* Observer, const FBox& Bounds, int32 NumChecks, FVector& OutStart, TArray<FVector, TInlineAllocator<8>>& OutEnds)
+{
+	const FVector CenterOfMass = Bounds.GetCenter();
+	const FVector Extent = Bounds.GetExtent();
+
+	// divide the vertical extent by the number of line of sight checks we'll do
+	const float ExtentZOffset = Extent.Z * 2.0f / FMath::Max(NumChecks, 1);
+
+	// get the character's camera location as the source for the line checks
+	OutStart = Observer->GetFirstPersonCameraComponent()->GetComponentLocation();
+
+	// calculate the vertically offset endpoints for the traces
+	for (int32 i = 0; i < NumChecks - 1; ++i)
+	{
+		OutEnds.Add(CenterOfMass + FVector(0.0f, 0.0f, Extent.Z - ExtentZOffset * i));
+	}
+}
@@ -0,0 +1,92 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "UObject/ObjectKey.h"
+#include "ShooterLineOfSightSubsystem.generated.h"
+
+class ARevolution2Character;
+
+/**
+ *  Cached line of sight result between an observer and a target
+ */
+struct FShooterLineOfSightEntry
+{
+	/** Character looking for the target */
+	TWeakObjectPtr<ARevolution2Character> Observer;
+
+	/** Actor we're checking line of sight to */
+	TWeakObjectPtr<AActor> Target;
+
+	/** Number of vertical line of sight checks requested for this pair */
+	int32 NumChecks = 0;
+
+	/** Last known line of sight result */
+	bool bHasLineOfSight = false;
+
+	/** If true, the result is stale and traces should be issued on the next tick */
+	bool bRefreshRequested = false;
+
+	/** Frame the last result was computed on */
+	uint64 ResultFrame = 0;
+
+	/** Frame this pair was last queried on */
+	uint64 LastQueryFrame = 0;
+
+	/** Async traces issued for this pair that haven't been read back yet */
+	TArray<FTraceHandle, TInlineAllocator<8>> PendingTraces;
+};
+
+/**
+ *  Batches line of sight checks from every NPC into async traces
+ *  Results are cached per observer and target pair, so the cost per frame doesn't grow with the number of conditions evaluated
+ */
+UCLASS()
+class REVOLUTION2_API UShooterLineOfSightSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Cached results by observer and target */
+	TMap<TPair<TObjectKey<AActor>, TObjectKey<AActor>>, FShooterLineOfSightEntry> Entries;
+
+	/** Target bounds computed this frame, so each target's bounds are only calculated once per batch */
+	TMap<TObjectKey<AActor>, FBox> TargetBounds;
+
+	/** Number of frames a pair can go unqueried before it's evicted from the cache */
+	static constexpr uint64 EvictionFrames = 120;
+
+public:
+
+	/**
+	 *  Returns the cached line of sight between the observer's camera and the target.
+	 *  If the result is older than MaxAgeFrames, a batched async refresh is scheduled and the cached result is returned meanwhile.
+	 *  The first query for a pair is resolved synchronously so callers always get a valid result.
+	 */
+	bool GetLineOfSight(ARevolution2Character* Observer, AActor* Target, int32 NumChecks, int32 MaxAgeFrames);
+
+	/** Runs the vertical line of sight checks synchronously. Returns true if any trace is unobstructed */
+	static bool ComputeLineOfSight(const ARevolution2Character* Observer, const AActor* Target, int32 NumChecks);
+
+	//~Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~End FTickableGameObject interface
+
+protected:
+
+	/** Reads back the async traces for the entry. Returns true if all traces were available */
+	bool ReadPendingTraces(FShooterLineOfSightEntry& Entry);
+
+	/** Issues the async traces to refresh the entry */
+	void IssueTraces(FShooterLineOfSightEntry& Entry);
+
+	/** Returns the bounds of the target, computing them once per frame */
+	const FBox& GetTargetBounds(const AActor* Target);
+
+	/** Builds the start point and the vertically offset end points for the line of sight checks */
+	static void BuildTraceEndpoints(const ARevolution2Character* Observer, const FBox& Bounds, int32 NumChecks, FVector& OutStart, TArray<FVector, TInlineAllocator<8>>& OutEnds);
+};
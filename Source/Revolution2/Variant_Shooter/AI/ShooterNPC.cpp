@@ -11,6 +11,49 @@
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "TimerManager.h"
+#include "ShooterExplosionSubsystem.h"
+#include "Revolution2.h"
+#include "ShooterAIController.h"
+#include "ShooterCorpseSubsystem.h"
+#include "ShooterWeaponNetComponent.h"
+#include "ShooterHitboxHistoryComponent.h"
+
+AShooterNPC::AShooterNPC()
+{
+	// create the weapon fire replication component
+	WeaponNet = CreateDefaultSubobject<UShooterWeaponNetComponent>(TEXT("Weapon Net"));
+
+	// create the hitbox history component
+	HitboxHistory = CreateDefaultSubobject<UShooterHitboxHistoryComponent>(TEXT("Hitbox History"));
+
+	// only replicate to players nearby
+	SetNetCullDistanceSquared(FMath::Square(15000.0f));
+
+	// default significance buckets, from full rate up close to heavily throttled far away
+	FShooterSignificanceBucket& Near = SignificanceBuckets.AddDefaulted_GetRef();
+	Near.MaxDistance = 2000.0f;
+
+	FShooterSignificanceBucket& Medium = SignificanceBuckets.AddDefaulted_GetRef();
+	Medium.MaxDistance = 5000.0f;
+	Medium.StateTreeTickInterval = 0.1f;
+	Medium.PerceptionInterval = 0.1f;
+	Medium.AnimTickInterval = 0.033f;
+	Medium.AimTraceFrames = 2;
+
+	FShooterSignificanceBucket& Far = SignificanceBuckets.AddDefaulted_GetRef();
+	Far.MaxDistance = 10000.0f;
+	Far.StateTreeTickInterval = 0.25f;
+	Far.PerceptionInterval = 0.25f;
+	Far.AnimTickInterval = 0.1f;
+	Far.AimTraceFrames = 4;
+
+	FShooterSignificanceBucket& Distant = SignificanceBuckets.AddDefaulted_GetRef();
+	Distant.MaxDistance = 20000.0f;
+	Distant.StateTreeTickInterval = 0.5f;
+	Distant.PerceptionInterval = 0.5f;
+	Distant.AnimTickInterval = 0.25f;
+	Distant.AimTraceFrames = 15;
+}
 
 void AShooterNPC::BeginPlay()
 {
@@ -27,6 +70,18 @@ void AShooterNPC::BeginPlay()
 	{
 		Weapon->ActivateWeapon();
 	}
+
+	// register with the explosion spatial hash
+	if (UShooterExplosionSubsystem* ExplosionSubsystem = GetWorld()->GetSubsystem<UShooterExplosionSubsystem>())
+	{
+		ExplosionSubsystem->RegisterDamageable(this);
+	}
+
+	// register with the significance subsystem so our update rates follow the distance to the players
+	if (UShooterSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UShooterSignificanceSubsystem>())
+	{
+		SignificanceSubsystem->RegisterNPC(this);
+	}
 }
 
 void AShooterNPC::EndPlay(const EEndPlayReason::Type EndPlayReason)
@@ -35,6 +90,18 @@ void AShooterNPC::EndPlay(const EEndPlayReason::Type EndPlayReason)
 
 	// clear the death timer
 	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+
+	// unregister from the explosion spatial hash
+	if (UShooterExplosionSubsystem* ExplosionSubsystem = GetWorld()->GetSubsystem<UShooterExplosionSubsystem>())
+	{
+		ExplosionSubsystem->UnregisterDamageable(this);
+	}
+
+	// unregister from the significance subsystem
+	if (UShooterSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UShooterSignificanceSubsystem>())
+	{
+		SignificanceSubsystem->UnregisterNPC(this);
+	}
 }
 
 float AShooterNPC::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
@@ -86,6 +153,12 @@ void AShooterNPC::UpdateWeaponHUD(int32 CurrentAmmo, int32 MagazineSize)
 
 FVector AShooterNPC::GetWeaponTargetLocation()
 {
+#if !UE_BUILD_SHIPPING
+	// time the aim under our significance bucket
+	FScopeCycleCounter AimCounter(UShooterSignificanceSubsystem::GetAimStatId(FMath::Max(SignificanceBucket, 0)));
+	const double AimStartTime = FPlatformTime::Seconds();
+#endif
+
 	// start aiming from the camera location
 	const FVector AimSource = GetFirstPersonCameraComponent()->GetComponentLocation();
 
@@ -115,16 +188,65 @@ FVector AShooterNPC::GetWeaponTargetLocation()
 	// calculate the unobstructed aim target location
 	AimTarget = AimSource + (AimDir * AimRange);
 
-	// run a visibility trace to see if there's obstructions
-	FHitResult OutHit;
+	FVector AimLocation = AimTarget;
+
+	// less significant NPCs only trace every few frames
+	if (LastAimTraceFrame == 0 || GFrameCounter - LastAimTraceFrame >= static_cast<uint64>(AimTraceFrames))
+	{
+		// run a visibility trace to see if there's obstructions
+		FHitResult OutHit;
+
+		FCollisionQueryParams QueryParams;
+		QueryParams.AddIgnoredActor(this);
+
+		RecordShooterSceneQueries();
+
+		GetWorld()->LineTraceSingleByChannel(OutHit, AimSource, AimTarget, ECC_Visibility, QueryParams);
+
+		// use either the impact point or the trace end
+		AimLocation = OutHit.bBlockingHit ? OutHit.ImpactPoint : OutHit.TraceEnd;
+
+		CachedAimDistance = OutHit.bBlockingHit ? OutHit.Distance : AimRange;
+		LastAimTraceFrame = GFrameCounter;
+
+	} else {
+
+		// reuse the last obstruction distance along the new aim direction
+		AimLocation = AimSource + (AimDir * CachedAimDistance);
+	}
+
+#if !UE_BUILD_SHIPPING
+	if (UShooterSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UShooterSignificanceSubsystem>())
+	{
+		SignificanceSubsystem->RecordAim(FMath::Max(SignificanceBucket, 0), FPlatformTime::Seconds() - AimStartTime);
+	}
+#endif
 
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
+	return AimLocation;
+}
 
-	GetWorld()->LineTraceSingleByChannel(OutHit, AimSource, AimTarget, ECC_Visibility, QueryParams);
+void AShooterNPC::SetSignificanceBucket(int32 BucketIndex)
+{
+	if (!SignificanceBuckets.IsValidIndex(BucketIndex))
+	{
+		return;
+	}
+
+	SignificanceBucket = BucketIndex;
+
+	const FShooterSignificanceBucket& Bucket = SignificanceBuckets[BucketIndex];
 
-	// return either the impact point or the trace end
-	return OutHit.bBlockingHit ? OutHit.ImpactPoint : OutHit.TraceEnd;
+	AimTraceFrames = FMath::Max(Bucket.AimTraceFrames, 1);
+
+	// throttle the animation updates on both meshes
+	GetMesh()->SetComponentTickInterval(Bucket.AnimTickInterval);
+	GetFirstPersonMesh()->SetComponentTickInterval(Bucket.AnimTickInterval);
+
+	// throttle the behavior and perception on the controller
+	if (AShooterAIController* AIController = Cast<AShooterAIController>(GetController()))
+	{
+		AIController->SetUpdateIntervals(Bucket.StateTreeTickInterval, Bucket.PerceptionInterval);
+	}
 }
 
 void AShooterNPC::AddWeaponClass(const TSubclassOf<AShooterWeapon>& InWeaponClass)
@@ -178,10 +300,18 @@ void AShooterNPC::Die()
 	GetCharacterMovement()->StopMovementImmediately();
 	GetCharacterMovement()->StopActiveMovement();
 
-	// enable ragdoll physics on the third person mesh
-	GetMesh()->SetCollisionProfileName(RagdollCollisionProfile);
-	GetMesh()->SetSimulatePhysics(true);
-	GetMesh()->SetPhysicsBlendWeight(1.0f);
+	// enable ragdoll physics on the third person mesh. The corpse subsystem keeps the number of simulating ragdolls in budget
+	if (UShooterCorpseSubsystem* CorpseSubsystem = GetWorld()->GetSubsystem<UShooterCorpseSubsystem>())
+	{
+		CorpseSubsystem->StartRagdoll(this);
+
+	} else {
+
+		StartRagdoll();
+	}
+
+	// corpses don't change anymore, so stop considering them for replication once the death has gone out
+	SetNetDormancy(DORM_DormantAll);
 
 	// schedule actor destruction
 	GetWorld()->GetTimerManager().SetTimer(DeathTimer, this, &AShooterNPC::DeferredDestruction, DeferredDestructionTime, false);
@@ -189,9 +319,131 @@ void AShooterNPC::Die()
 
 void AShooterNPC::DeferredDestruction()
 {
+	// return to the pool instead of being destroyed, so we can be reused without spawning a new NPC and weapon
+	if (bReturnToPool)
+	{
+		if (UShooterCorpseSubsystem* CorpseSubsystem = GetWorld()->GetSubsystem<UShooterCorpseSubsystem>())
+		{
+			CorpseSubsystem->ReleaseNPC(this);
+			return;
+		}
+	}
+
 	Destroy();
 }
 
+void AShooterNPC::StartRagdoll()
+{
+	GetMesh()->SetCollisionProfileName(RagdollCollisionProfile);
+	GetMesh()->SetSimulatePhysics(true);
+	GetMesh()->SetPhysicsBlendWeight(1.0f);
+}
+
+void AShooterNPC::FreezeRagdoll()
+{
+	// stop simulating the bodies. With the mesh tick off, the pose stays where the simulation left it
+	GetMesh()->PutAllRigidBodiesToSleep();
+	GetMesh()->SetSimulatePhysics(false);
+	GetMesh()->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	GetMesh()->bPauseAnims = true;
+	GetMesh()->SetComponentTickEnabled(false);
+}
+
+void AShooterNPC::DeactivateForPool()
+{
+	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+
+	// stop the ragdoll
+	GetMesh()->SetSimulatePhysics(false);
+
+	// replicate the hidden state while staying dormant
+	FlushNetDormancy();
+
+	// hide the NPC and its weapon
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+
+	if (Weapon)
+	{
+		Weapon->DeactivateWeapon();
+	}
+
+	// drop our tags so pooled NPCs aren't picked up as enemies or targets
+	Tags.Reset();
+
+	// stop being tracked while pooled
+	if (UShooterExplosionSubsystem* ExplosionSubsystem = GetWorld()->GetSubsystem<UShooterExplosionSubsystem>())
+	{
+		ExplosionSubsystem->UnregisterDamageable(this);
+	}
+
+	if (UShooterSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UShooterSignificanceSubsystem>())
+	{
+		SignificanceSubsystem->UnregisterNPC(this);
+	}
+}
+
+void AShooterNPC::ReactivateFromPool(const FTransform& SpawnTransform)
+{
+	const AShooterNPC* DefaultNPC = GetClass()->GetDefaultObject<AShooterNPC>();
+
+	// wake up so the new spawn replicates
+	SetNetDormancy(DORM_Awake);
+
+	// move into place and show the NPC again
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+
+	// reset the gameplay state
+	Tags = DefaultNPC->Tags;
+	CurrentHP = DefaultNPC->CurrentHP;
+	bIsDead = false;
+	bIsShooting = false;
+	CurrentAimTarget = nullptr;
+	SignificanceBucket = INDEX_NONE;
+
+	// restore the capsule
+	GetCapsuleComponent()->SetCollisionEnabled(DefaultNPC->GetCapsuleComponent()->GetCollisionEnabled());
+
+	// put the mesh back on the capsule and hand it back to animation
+	GetMesh()->SetSimulatePhysics(false);
+	GetMesh()->SetPhysicsBlendWeight(0.0f);
+	GetMesh()->SetCollisionProfileName(DefaultNPC->GetMesh()->GetCollisionProfileName());
+	GetMesh()->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+	GetMesh()->SetRelativeLocationAndRotation(GetBaseTranslationOffset(), GetBaseRotationOffset());
+	GetMesh()->bPauseAnims = false;
+	GetMesh()->SetComponentTickEnabled(true);
+
+	GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+
+	// get the weapon ready again
+	if (Weapon)
+	{
+		Weapon->RefillAmmo();
+		Weapon->ActivateWeapon();
+	}
+
+	// register again
+	if (UShooterExplosionSubsystem* ExplosionSubsystem = GetWorld()->GetSubsystem<UShooterExplosionSubsystem>())
+	{
+		ExplosionSubsystem->RegisterDamageable(this);
+	}
+
+	if (UShooterSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UShooterSignificanceSubsystem>())
+	{
+		SignificanceSubsystem->RegisterNPC(this);
+	}
+
+	// our previous controller destroyed itself when we died
+	if (!GetController())
+	{
+		SpawnDefaultController();
+	}
+}
+
 void AShooterNPC::StartShooting(AActor* ActorToShoot)
 {
 	// save the aim target
@@ -5,11 +5,14 @@
 #include "CoreMinimal.h"
 #include "Revolution2Character.h"
 #include "ShooterWeaponHolder.h"
+#include "ShooterSignificanceSubsystem.h"
 #include "ShooterNPC.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FPawnDeathDelegate);
 
 class AShooterWeapon;
+class UShooterWeaponNetComponent;
+class UShooterHitboxHistoryComponent;
 
 /**
  *  A simple AI-controlled shooter game NPC
@@ -21,6 +24,14 @@ class REVOLUTION2_API AShooterNPC : public ARevolution2Character, public IShoote
 {
 	GENERATED_BODY()
 
+	/** Replicates weapon fire in multiplayer games */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UShooterWeaponNetComponent* WeaponNet;
+
+	/** Records hitboxes for lag compensated hit confirmation */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UShooterHitboxHistoryComponent* HitboxHistory;
+
 public:
 
 	/** Current HP for this character. It dies if it reaches zero through damage */
@@ -37,6 +48,11 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Damage")
 	float DeferredDestructionTime = 5.0f;
 
+	/** If true, this NPC and its weapon are returned to the NPC pool for reuse instead of being destroyed after death.
+	 *  Only worth it when something acquires NPCs back from the pool. NPCs acquired from the pool turn this on */
+	UPROPERTY(EditAnywhere, Category="Damage")
+	bool bReturnToPool = false;
+
 	/** Team byte for this character */
 	UPROPERTY(EditAnywhere, Category="Team")
 	uint8 TeamByte = 1;
@@ -72,6 +88,30 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Aim")
 	float MaxAimOffsetZ = -60.0f;
 
+	/** Update rates by significance, from most to least significant. NPCs further than every bucket's distance use the last one */
+	UPROPERTY(EditAnywhere, Category="Significance")
+	TArray<FShooterSignificanceBucket> SignificanceBuckets;
+
+	/** Distance multiplier for NPCs outside every player's view */
+	UPROPERTY(EditAnywhere, Category="Significance", meta = (ClampMin = 1))
+	float SignificanceOffscreenScale = 2.0f;
+
+	/** Half angle of the player view cone used to decide if this NPC is on screen */
+	UPROPERTY(EditAnywhere, Category="Significance", meta = (ClampMin = 0, ClampMax = 180, Units = "Degrees"))
+	float SignificanceViewHalfAngle = 60.0f;
+
+	/** Significance bucket currently applied */
+	int32 SignificanceBucket = INDEX_NONE;
+
+	/** Frames between aim traces for the current bucket */
+	int32 AimTraceFrames = 1;
+
+	/** Frame the last aim trace ran on */
+	uint64 LastAimTraceFrame = 0;
+
+	/** Distance to the obstruction found by the last aim trace */
+	float CachedAimDistance = 0.0f;
+
 	/** Actor currently being targeted */
 	TObjectPtr<AActor> CurrentAimTarget;
 
@@ -89,6 +129,15 @@ public:
 	/** Delegate called when this NPC dies */
 	FPawnDeathDelegate OnPawnDeath;
 
+	/** Sets the team this NPC scores for */
+	void SetTeamByte(uint8 InTeamByte) { TeamByte = InTeamByte; }
+
+	/** Sets whether this NPC goes back to the NPC pool after death */
+	void SetReturnToPool(bool bInReturnToPool) { bReturnToPool = bInReturnToPool; }
+
+	/** Constructor */
+	AShooterNPC();
+
 protected:
 
 	/** Gameplay initialization */
@@ -145,6 +194,36 @@ protected:
 
 public:
 
+	/** Returns the update rates by significance */
+	const TArray<FShooterSignificanceBucket>& GetSignificanceBuckets() const { return SignificanceBuckets; }
+
+	/** Returns the distance multiplier for NPCs outside every player's view */
+	float GetSignificanceOffscreenScale() const { return SignificanceOffscreenScale; }
+
+	/** Returns the half angle of the player view cone */
+	float GetSignificanceViewHalfAngle() const { return SignificanceViewHalfAngle; }
+
+	/** Returns true if this NPC has died */
+	bool IsDead() const { return bIsDead; }
+
+	/** Returns the significance bucket currently applied */
+	int32 GetSignificanceBucket() const { return SignificanceBucket; }
+
+	/** Applies the update rates for the given significance bucket */
+	void SetSignificanceBucket(int32 BucketIndex);
+
+	/** Starts simulating ragdoll physics on the third person mesh */
+	void StartRagdoll();
+
+	/** Stops simulating the ragdoll, leaving the mesh frozen in its last pose */
+	void FreezeRagdoll();
+
+	/** Hides and disables this NPC so it can sit in the NPC pool */
+	void DeactivateForPool();
+
+	/** Brings this NPC back to life from the NPC pool at the given transform */
+	void ReactivateFromPool(const FTransform& SpawnTransform);
+
 	/** Signals this character to start shooting at the passed actor */
 	void StartShooting(AActor* ActorToShoot);
 
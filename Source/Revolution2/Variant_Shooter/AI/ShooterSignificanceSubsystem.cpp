@@ -0,0 +1,210 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterSignificanceSubsystem.h"
+#include "ShooterNPC.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Revolution2.h"
+
+DECLARE_CYCLE_STAT(TEXT("Significance Update"), STAT_ShooterSignificanceUpdate, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("NPCs in Bucket 0"), STAT_ShooterSignificanceBucket0, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("NPCs in Bucket 1"), STAT_ShooterSignificanceBucket1, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("NPCs in Bucket 2"), STAT_ShooterSignificanceBucket2, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("NPCs in Bucket 3+"), STAT_ShooterSignificanceBucket3, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("NPC Aim (Bucket 0)"), STAT_ShooterNPCAimBucket0, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("NPC Aim (Bucket 1)"), STAT_ShooterNPCAimBucket1, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("NPC Aim (Bucket 2)"), STAT_ShooterNPCAimBucket2, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("NPC Aim (Bucket 3+)"), STAT_ShooterNPCAimBucket3, STATGROUP_Shooter);
+
+void UShooterSignificanceSubsystem::Deinitialize()
+{
+	// summarize how the NPC time was spread across buckets
+	for (int32 i = 0; i < BucketSeconds.Num(); ++i)
+	{
+		const int32 AimRequests = BucketAimRequests.IsValidIndex(i) ? BucketAimRequests[i] : 0;
+		const double AimSeconds = BucketAimSeconds.IsValidIndex(i) ? BucketAimSeconds[i] : 0.0;
+
+		UE_LOG(LogRevolution2, Log, TEXT("Significance: bucket %d held %.1f NPC seconds, %d aim requests averaging %.2f us"),
+			i, BucketSeconds[i], AimRequests, AimRequests > 0 ? AimSeconds * 1000000.0 / AimRequests : 0.0);
+	}
+
+	NPCs.Empty();
+
+	Super::Deinitialize();
+}
+
+void UShooterSignificanceSubsystem::RegisterNPC(AShooterNPC* NPC)
+{
+	NPCs.AddUnique(NPC);
+
+	// update soon so new NPCs don't run at the wrong rate for long
+	UpdateCountdown = 0.0f;
+}
+
+void UShooterSignificanceSubsystem::UnregisterNPC(AShooterNPC* NPC)
+{
+	NPCs.RemoveSwap(NPC);
+}
+
+void UShooterSignificanceSubsystem::RecordAim(int32 BucketIndex, double Seconds)
+{
+	if (BucketIndex < 0)
+	{
+		return;
+	}
+
+	if (BucketAimSeconds.Num() <= BucketIndex)
+	{
+		BucketAimSeconds.SetNumZeroed(BucketIndex + 1);
+		BucketAimRequests.SetNumZeroed(BucketIndex + 1);
+	}
+
+	BucketAimSeconds[BucketIndex] += Seconds;
+	++BucketAimRequests[BucketIndex];
+}
+
+TStatId UShooterSignificanceSubsystem::GetAimStatId(int32 BucketIndex)
+{
+	switch (BucketIndex)
+	{
+	case 0:
+		return GET_STATID(STAT_ShooterNPCAimBucket0);
+
+	case 1:
+		return GET_STATID(STAT_ShooterNPCAimBucket1);
+
+	case 2:
+		return GET_STATID(STAT_ShooterNPCAimBucket2);
+
+	default:
+		return GET_STATID(STAT_ShooterNPCAimBucket3);
+	}
+}
+
+void UShooterSignificanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UpdateCountdown -= DeltaTime;
+
+	if (UpdateCountdown > 0.0f)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterSignificanceUpdate);
+
+	const float Elapsed = UpdateInterval - UpdateCountdown;
+	UpdateCountdown = UpdateInterval;
+
+	GatherViewers();
+
+	int32 BucketCounts[4] = { 0, 0, 0, 0 };
+
+	for (int32 i = NPCs.Num() - 1; i >= 0; --i)
+	{
+		AShooterNPC* NPC = NPCs[i].Get();
+
+		if (!NPC)
+		{
+			NPCs.RemoveAtSwap(i, EAllowShrinking::No);
+			continue;
+		}
+
+		const int32 BucketIndex = ComputeBucket(NPC);
+
+		// only push new rates to the NPC when its bucket changes
+		if (BucketIndex != NPC->GetSignificanceBucket())
+		{
+			NPC->SetSignificanceBucket(BucketIndex);
+		}
+
+		if (BucketSeconds.Num() <= BucketIndex)
+		{
+			BucketSeconds.SetNumZeroed(BucketIndex + 1);
+		}
+
+		BucketSeconds[BucketIndex] += Elapsed;
+		++BucketCounts[FMath::Min(BucketIndex, 3)];
+	}
+
+	SET_DWORD_STAT(STAT_ShooterSignificanceBucket0, BucketCounts[0]);
+	SET_DWORD_STAT(STAT_ShooterSignificanceBucket1, BucketCounts[1]);
+	SET_DWORD_STAT(STAT_ShooterSignificanceBucket2, BucketCounts[2]);
+	SET_DWORD_STAT(STAT_ShooterSignificanceBucket3, BucketCounts[3]);
+}
+
+bool UShooterSignificanceSubsystem::IsTickable() const
+{
+	return NPCs.Num() > 0;
+}
+
+TStatId UShooterSignificanceSubsystem::GetStatId() const
+{
+	return GET_STATID(STAT_ShooterSignificanceUpdate);
+}
+
+void UShooterSignificanceSubsystem::GatherViewers()
+{
+	Viewers.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+
+		// skip players that aren't in the game yet
+		if (!PC || !PC->GetPawnOrSpectator())
+		{
+			continue;
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		Viewers.Emplace(ViewRotation, ViewLocation);
+	}
+}
+
+int32 UShooterSignificanceSubsystem::ComputeBucket(const AShooterNPC* NPC) const
+{
+	const TArray<FShooterSignificanceBucket>& Buckets = NPC->GetSignificanceBuckets();
+
+	// without players to watch, everyone runs at full rate
+	if (Viewers.Num() == 0 || Buckets.Num() == 0)
+	{
+		return 0;
+	}
+
+	const FVector NPCLocation = NPC->GetActorLocation();
+
+	// NPCs behind the view count as further away
+	const float ViewConeCos = FMath::Cos(FMath::DegreesToRadians(NPC->GetSignificanceViewHalfAngle()));
+
+	float NearestDistance = TNumericLimits<float>::Max();
+
+	for (const FTransform& Viewer : Viewers)
+	{
+		const FVector ToNPC = NPCLocation - Viewer.GetLocation();
+		float Distance = ToNPC.Length();
+
+		if (FVector::DotProduct(ToNPC.GetSafeNormal(), Viewer.GetRotation().GetForwardVector()) < ViewConeCos)
+		{
+			Distance *= NPC->GetSignificanceOffscreenScale();
+		}
+
+		NearestDistance = FMath::Min(NearestDistance, Distance);
+	}
+
+	// pick the first bucket the NPC fits in, or the least significant one
+	for (int32 i = 0; i < Buckets.Num(); ++i)
+	{
+		if (NearestDistance <= Buckets[i].MaxDistance)
+		{
+			return i;
+		}
+	}
+
+	return Buckets.Num() - 1;
+}
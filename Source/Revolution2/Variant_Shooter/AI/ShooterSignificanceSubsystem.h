@@ -0,0 +1,100 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterSignificanceSubsystem.generated.h"
+
+class AShooterNPC;
+
+/**
+ *  Update rates for NPCs within a significance bucket
+ */
+USTRUCT(BlueprintType)
+struct FShooterSignificanceBucket
+{
+	GENERATED_BODY()
+
+	/** NPCs closer than this to the nearest player fall in this bucket */
+	UPROPERTY(EditAnywhere, Category="Significance", meta = (ClampMin = 0, Units = "cm"))
+	float MaxDistance = 2000.0f;
+
+	/** Tick interval for the StateTree. Zero ticks every frame */
+	UPROPERTY(EditAnywhere, Category="Significance", meta = (ClampMin = 0, Units = "s"))
+	float StateTreeTickInterval = 0.0f;
+
+	/** Time perception updates are batched for before they reach the StateTree. Zero passes them right away */
+	UPROPERTY(EditAnywhere, Category="Significance", meta = (ClampMin = 0, Units = "s"))
+	float PerceptionInterval = 0.0f;
+
+	/** Tick interval for the skeletal meshes, which drives animation updates. Zero ticks every frame */
+	UPROPERTY(EditAnywhere, Category="Significance", meta = (ClampMin = 0, Units = "s"))
+	float AnimTickInterval = 0.0f;
+
+	/** Frames between weapon aim traces. In between, the last trace distance is reused */
+	UPROPERTY(EditAnywhere, Category="Significance", meta = (ClampMin = 1))
+	int32 AimTraceFrames = 1;
+};
+
+/**
+ *  Buckets NPCs by their distance and visibility to the players, so distant NPCs update at a fraction of the cost of nearby ones
+ *  Each NPC owns its bucket settings. This subsystem only decides which bucket applies and tracks per bucket stats
+ */
+UCLASS()
+class REVOLUTION2_API UShooterSignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Registered NPCs */
+	TArray<TWeakObjectPtr<AShooterNPC>> NPCs;
+
+	/** Player view points gathered for the current update */
+	TArray<FTransform, TInlineAllocator<4>> Viewers;
+
+	/** Time until the next update */
+	float UpdateCountdown = 0.0f;
+
+	/** Time spent by NPCs in each bucket, for the summary log */
+	TArray<double> BucketSeconds;
+
+	/** Time spent aiming by NPCs in each bucket, for the summary log */
+	TArray<double> BucketAimSeconds;
+
+	/** Number of aim requests by NPCs in each bucket, for the summary log */
+	TArray<int32> BucketAimRequests;
+
+public:
+
+	/** Time between significance updates */
+	static constexpr float UpdateInterval = 0.25f;
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+	/** Adds an NPC to be bucketed */
+	void RegisterNPC(AShooterNPC* NPC);
+
+	/** Removes an NPC */
+	void UnregisterNPC(AShooterNPC* NPC);
+
+	/** Records the time an NPC in the given bucket spent resolving its aim */
+	void RecordAim(int32 BucketIndex, double Seconds);
+
+	/** Returns the cycle stat used to time aiming for NPCs in the given bucket */
+	static TStatId GetAimStatId(int32 BucketIndex);
+
+	//~Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~End FTickableGameObject interface
+
+protected:
+
+	/** Gathers the view points of every local or remote player */
+	void GatherViewers();
+
+	/** Returns the bucket an NPC falls in given the current viewers */
+	int32 ComputeBucket(const AShooterNPC* NPC) const;
+};
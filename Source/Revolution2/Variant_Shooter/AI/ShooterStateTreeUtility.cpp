@@ -9,6 +9,7 @@
 #include "Perception/AIPerceptionComponent.h"
 #include "ShooterAIController.h"
 #include "StateTreeAsyncExecutionContext.h"
+#include "ShooterLineOfSightSubsystem.h"
 
 bool FStateTreeLineOfSightToTargetCondition::TestCondition(FStateTreeExecutionContext& Context) const
 {
@@ -32,41 +33,20 @@ bool FStateTreeLineOfSightToTargetCondition::TestCondition(FStateTreeExecutionCo
 		return !InstanceData.bMustHaveLineOfSight;
 	}
 
-	// get the target's bounding box
-	FVector CenterOfMass, Extent;
-	InstanceData.Target->GetActorBounds(true, CenterOfMass, Extent, false);
+	// get the line of sight from the batched line of sight cache
+	bool bHasLineOfSight = false;
 
-	// divide the vertical extent by the number of line of sight checks we'll do
-	const float ExtentZOffset = Extent.Z * 2.0f / InstanceData.NumberOfVerticalLineOfSightChecks;
-
-	// get the character's camera location as the source for the line checks
-	const FVector Start = InstanceData.Character->GetFirstPersonCameraComponent()->GetComponentLocation();
-
-	// ignore the character and target. We want to ensure there's an unobstructed trace not counting them
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(InstanceData.Character);
-	QueryParams.AddIgnoredActor(InstanceData.Target);
-
-	FHitResult OutHit;
-
-	// run a number of vertically offset line traces to the target location
-	for (int32 i = 0; i < InstanceData.NumberOfVerticalLineOfSightChecks - 1; ++i)
+	if (UShooterLineOfSightSubsystem* LineOfSight = InstanceData.Character->GetWorld()->GetSubsystem<UShooterLineOfSightSubsystem>())
 	{
-		// calculate the endpoint for the trace
-		const FVector End = CenterOfMass + FVector(0.0f, 0.0f, Extent.Z - ExtentZOffset * i);
+		bHasLineOfSight = LineOfSight->GetLineOfSight(InstanceData.Character, InstanceData.Target, InstanceData.NumberOfVerticalLineOfSightChecks, InstanceData.LineOfSightCacheFrames);
 
-		InstanceData.Character->GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility, QueryParams);
+	} else {
 
-		// is the trace unobstructed?
-		if (!OutHit.bBlockingHit)
-		{
-			// we only need one unobstructed trace, so terminate early
-			return InstanceData.bMustHaveLineOfSight;
-		}
+		// no cache available, so run the traces right away
+		bHasLineOfSight = UShooterLineOfSightSubsystem::ComputeLineOfSight(InstanceData.Character, InstanceData.Target, InstanceData.NumberOfVerticalLineOfSightChecks);
 	}
 
-	// no line of sight found
-	return !InstanceData.bMustHaveLineOfSight;
+	return bHasLineOfSight ? InstanceData.bMustHaveLineOfSight : !InstanceData.bMustHaveLineOfSight;
 }
 
 #if WITH_EDITOR
@@ -219,72 +199,62 @@ EStateTreeRunStatus FStateTreeSenseEnemiesTask::EnterState(FStateTreeExecutionCo
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// bind the perception updated delegate on the controller
+		// only pass on the updates we care about, and check line of sight within our cone
+		InstanceData.Controller->SetPerceptionFilter(InstanceData.SenseTag, InstanceData.DirectLineOfSightCone);
+
+		// bind the perception updated delegate on the controller. Updates arrive coalesced once per frame with line of sight already resolved
 		InstanceData.Controller->OnShooterPerceptionUpdated.BindLambda(
-			[WeakContext = Context.MakeWeakExecutionContext()](AActor* SensedActor, const FAIStimulus& Stimulus)
+			[WeakContext = Context.MakeWeakExecutionContext()](TConstArrayView<FShooterPerceptionUpdate> Updates)
 			{
-				// get the instance data inside the lambda
+				// get the instance data inside the lambda, once for the whole batch
 				const FStateTreeStrongExecutionContext StrongContext = WeakContext.MakeStrongExecutionContext();
 
-				if (FInstanceDataType* LambdaInstanceData = StrongContext.GetInstanceDataPtr<FInstanceDataType>())
+				FInstanceDataType* LambdaInstanceData = StrongContext.GetInstanceDataPtr<FInstanceDataType>();
+
+				if (!LambdaInstanceData)
 				{
-					if (SensedActor->ActorHasTag(LambdaInstanceData->SenseTag))
-					{
-						bool bDirectLOS = false;
+					return;
+				}
 
-						// calculate the direction of the stimulus
-						const FVector StimulusDir = (Stimulus.StimulusLocation - LambdaInstanceData->Character->GetActorLocation()).GetSafeNormal();
+				for (const FShooterPerceptionUpdate& Update : Updates)
+				{
+					AActor* SensedActor = Update.Actor.Get();
 
-						// infer the angle from the dot product between the character facing and the stimulus direction
-						const float DirDot = FVector::DotProduct(StimulusDir, LambdaInstanceData->Character->GetActorForwardVector());
-						const float MaxDot = FMath::Cos(FMath::DegreesToRadians(LambdaInstanceData->DirectLineOfSightCone));
+					if (!SensedActor || !SensedActor->ActorHasTag(LambdaInstanceData->SenseTag))
+					{
+						continue;
+					}
 
-						// is the direction within our perception cone?
-						if (DirDot >= MaxDot)
-						{
-							// run a line trace between the character and the sensed actor
-							FCollisionQueryParams QueryParams;
-							QueryParams.AddIgnoredActor(LambdaInstanceData->Character);
-							QueryParams.AddIgnoredActor(SensedActor);
+					// check if we have a direct line of sight to the stimulus
+					if (Update.bHasLineOfSight)
+					{
+						// set the controller's target
+						LambdaInstanceData->Controller->SetCurrentTarget(SensedActor);
 
-							FHitResult OutHit;
+						// set the task output
+						LambdaInstanceData->TargetActor = SensedActor;
 
-							// we have direct line of sight if this trace is unobstructed
-							bDirectLOS = !LambdaInstanceData->Character->GetWorld()->LineTraceSingleByChannel(OutHit, LambdaInstanceData->Character->GetActorLocation(), SensedActor->GetActorLocation(), ECC_Visibility, QueryParams);
+						// set the flags
+						LambdaInstanceData->bHasTarget = true;
+						LambdaInstanceData->bHasInvestigateLocation = false;
 
-						}
+					// no direct line of sight to target
+					} else {
 
-						// check if we have a direct line of sight to the stimulus
-						if (bDirectLOS)
+						// if we already have a target, ignore the partial sense and keep on them
+						if (!IsValid(LambdaInstanceData->TargetActor))
 						{
-							// set the controller's target
-							LambdaInstanceData->Controller->SetCurrentTarget(SensedActor);
-
-							// set the task output
-							LambdaInstanceData->TargetActor = SensedActor;
-
-							// set the flags
-							LambdaInstanceData->bHasTarget = true;
-							LambdaInstanceData->bHasInvestigateLocation = false;
+							// is this stimulus stronger than the last one we had?
+							if (Update.Stimulus.Strength > LambdaInstanceData->LastStimulusStrength)
+							{
+								// update the stimulus strength
+								LambdaInstanceData->LastStimulusStrength = Update.Stimulus.Strength;
 
-						// no direct line of sight to target
-						} else {
+								// set the investigate location
+								LambdaInstanceData->InvestigateLocation = Update.Stimulus.StimulusLocation;
 
-							// if we already have a target, ignore the partial sense and keep on them
-							if (!IsValid(LambdaInstanceData->TargetActor))
-							{
-								// is this stimulus stronger than the last one we had?
-								if (Stimulus.Strength > LambdaInstanceData->LastStimulusStrength)
-								{
-									// update the stimulus strength
-									LambdaInstanceData->LastStimulusStrength = Stimulus.Strength;
-
-									// set the investigate location
-									LambdaInstanceData->InvestigateLocation = Stimulus.StimulusLocation;
-
-									// set the investigate flag
-									LambdaInstanceData->bHasInvestigateLocation = true;
-								}
+								// set the investigate flag
+								LambdaInstanceData->bHasInvestigateLocation = true;
 							}
 						}
 					}
@@ -36,6 +36,10 @@ struct FStateTreeLineOfSightToTargetConditionInstanceData
 	UPROPERTY(EditAnywhere, Category = "Condition")
 	int32 NumberOfVerticalLineOfSightChecks = 5;
 
+	/** Number of frames a line of sight result can be reused before it's refreshed through a batched async trace */
+	UPROPERTY(EditAnywhere, Category = "Condition", meta = (ClampMin = 1))
+	int32 LineOfSightCacheFrames = 5;
+
 	/** If true, the condition passes if the character has line of sight */
 	UPROPERTY(EditAnywhere, Category = "Condition")
 	bool bMustHaveLineOfSight = true;
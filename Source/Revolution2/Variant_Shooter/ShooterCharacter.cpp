@@ -12,12 +12,30 @@
 #include "Camera/CameraComponent.h"
 #include "TimerManager.h"
 #include "ShooterGameMode.h"
+#include "ShooterExplosionSubsystem.h"
+#include "ShooterWeaponNetComponent.h"
+#include "ShooterHitboxHistoryComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "Serialization/BitWriter.h"
+#include "Revolution2.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Top Down Aim Bytes/s"), STAT_ShooterAimBytesPerSecond, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Top Down Aim Unthrottled Bytes/s"), STAT_ShooterAimUnthrottledBytesPerSecond, STATGROUP_Shooter);
 
 AShooterCharacter::AShooterCharacter()
 {
 	// create the noise emitter component
 	PawnNoiseEmitter = CreateDefaultSubobject<UPawnNoiseEmitterComponent>(TEXT("Pawn Noise Emitter"));
 
+	// create the weapon fire replication component
+	WeaponNet = CreateDefaultSubobject<UShooterWeaponNetComponent>(TEXT("Weapon Net"));
+
+	// create the hitbox history component
+	HitboxHistory = CreateDefaultSubobject<UShooterHitboxHistoryComponent>(TEXT("Hitbox History"));
+
+	// only replicate to players nearby. The owning player always receives its own pawn
+	SetNetCullDistanceSquared(FMath::Square(15000.0f));
+
 	// configure movement
 	GetCharacterMovement()->RotationRate = FRotator(0.0f, 600.0f, 0.0f);
 }
@@ -31,6 +49,12 @@ void AShooterCharacter::BeginPlay()
 
 	// update the HUD
 	OnDamaged.Broadcast(1.0f);
+
+	// register with the explosion spatial hash
+	if (UShooterExplosionSubsystem* ExplosionSubsystem = GetWorld()->GetSubsystem<UShooterExplosionSubsystem>())
+	{
+		ExplosionSubsystem->RegisterDamageable(this);
+	}
 }
 
 void AShooterCharacter::EndPlay(EEndPlayReason::Type EndPlayReason)
@@ -39,6 +63,39 @@ void AShooterCharacter::EndPlay(EEndPlayReason::Type EndPlayReason)
 
 	// clear the respawn timer
 	GetWorld()->GetTimerManager().ClearTimer(RespawnTimer);
+
+	// unregister from the explosion spatial hash
+	if (UShooterExplosionSubsystem* ExplosionSubsystem = GetWorld()->GetSubsystem<UShooterExplosionSubsystem>())
+	{
+		ExplosionSubsystem->UnregisterDamageable(this);
+	}
+}
+
+void AShooterCharacter::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// the owning client drives its own aim. Everyone else smooths towards the last received sample
+	if (!IsLocallyControlled() && bHasReplicatedAim)
+	{
+		FVector AimLocation;
+		if (!GetTopDownAimLocation(AimLocation))
+		{
+			// snap to the first sample
+			AimLocation = ReplicatedAimLocation;
+		}
+
+		SetTopDownAimLocation(FMath::VInterpTo(AimLocation, ReplicatedAimLocation, DeltaTime, AimInterpSpeed));
+	}
+}
+
+void AShooterCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// the owner already knows where it's aiming
+	DOREPLIFETIME_CONDITION(AShooterCharacter, ReplicatedAimLocation, COND_SkipOwner);
+	DOREPLIFETIME_CONDITION(AShooterCharacter, bHasReplicatedAim, COND_SkipOwner);
 }
 
 void AShooterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -205,16 +262,75 @@ FVector AShooterCharacter::GetWeaponTargetLocation()
 	}
 }
 
-void AShooterCharacter::ServerSetTopDownAimLocation_Implementation(FVector AimLocation)
+void AShooterCharacter::ServerSetTopDownAimLocation_Implementation(FVector_NetQuantize10 AimLocation)
 {
-	SetTopDownAimLocation(AimLocation);
+	// store the sample. Tick interpolates towards it
+	ReplicatedAimLocation = AimLocation;
+	bHasReplicatedAim = true;
 }
 
 void AShooterCharacter::OnTopDownAimLocationUpdated(const FVector& AimLocation)
 {
-	if (GetLocalRole() != ROLE_Authority)
+	// only the owning client sends aim to the server
+	if (GetLocalRole() == ROLE_Authority || !IsLocallyControlled())
+	{
+		return;
+	}
+
+	// the old path sent a full vector on every update
+	const int32 UnthrottledBytes = sizeof(FVector);
+
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+
+	// skip the update if we sent one too recently, or the aim hasn't moved enough.
+	// The RPC is unreliable, so a still aim is resent now and then in case the last update was dropped
+	const float TimeSinceLastSend = CurrentTime - LastAimSendTime;
+	const bool bRateLimited = LastAimSendTime >= 0.0f && TimeSinceLastSend < 1.0f / AimSendRate;
+	const bool bBelowThreshold = LastAimSendTime >= 0.0f && TimeSinceLastSend < AimKeepAliveInterval && FVector::DistSquared(AimLocation, LastSentAimLocation) < FMath::Square(AimSendThreshold);
+
+	if (bRateLimited || bBelowThreshold)
+	{
+		RecordAimBandwidth(0, UnthrottledBytes);
+		return;
+	}
+
+	FVector_NetQuantize10 QuantizedAim(AimLocation);
+
+	LastSentAimLocation = QuantizedAim;
+	LastAimSendTime = CurrentTime;
+
+	ServerSetTopDownAimLocation(QuantizedAim);
+
+	// measure the quantized payload size
+	FBitWriter PayloadWriter(0, true);
+	bool bSerialized = false;
+	QuantizedAim.NetSerialize(PayloadWriter, nullptr, bSerialized);
+
+	RecordAimBandwidth(static_cast<int32>(PayloadWriter.GetNumBytes()), UnthrottledBytes);
+}
+
+void AShooterCharacter::RecordAimBandwidth(int32 SentBytes, int32 UnthrottledBytes)
+{
+	AimBytesSent += SentBytes;
+	AimBytesUnthrottled += UnthrottledBytes;
+
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	const float WindowLength = CurrentTime - AimBandwidthWindowStart;
+
+	// publish the counters once per second
+	if (WindowLength >= 1.0f)
 	{
-		ServerSetTopDownAimLocation(AimLocation);
+		const int32 BytesPerSecond = FMath::RoundToInt32(AimBytesSent / WindowLength);
+		const int32 UnthrottledBytesPerSecond = FMath::RoundToInt32(AimBytesUnthrottled / WindowLength);
+
+		SET_DWORD_STAT(STAT_ShooterAimBytesPerSecond, BytesPerSecond);
+		SET_DWORD_STAT(STAT_ShooterAimUnthrottledBytesPerSecond, UnthrottledBytesPerSecond);
+
+		UE_LOG(LogRevolution2, Verbose, TEXT("Top down aim: %d bytes/s sent, %d bytes/s unthrottled"), BytesPerSecond, UnthrottledBytesPerSecond);
+
+		AimBytesSent = 0;
+		AimBytesUnthrottled = 0;
+		AimBandwidthWindowStart = CurrentTime;
 	}
 }
 
@@ -5,12 +5,15 @@
 #include "CoreMinimal.h"
 #include "Revolution2Character.h"
 #include "ShooterWeaponHolder.h"
+#include "Engine/NetSerialization.h"
 #include "ShooterCharacter.generated.h"
 
 class AShooterWeapon;
 class UInputAction;
 class UInputComponent;
 class UPawnNoiseEmitterComponent;
+class UShooterWeaponNetComponent;
+class UShooterHitboxHistoryComponent;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FBulletCountUpdatedDelegate, int32, MagazineSize, int32, Bullets);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDamagedDelegate, float, LifePercent);
@@ -29,6 +32,14 @@ class REVOLUTION2_API AShooterCharacter : public ARevolution2Character, public I
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
 	UPawnNoiseEmitterComponent* PawnNoiseEmitter;
 
+	/** Replicates weapon fire in multiplayer games */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UShooterWeaponNetComponent* WeaponNet;
+
+	/** Records hitboxes for lag compensated hit confirmation */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UShooterHitboxHistoryComponent* HitboxHistory;
+
 protected:
 
 	/** Fire weapon input action */
@@ -73,6 +84,45 @@ protected:
 
 	FTimerHandle RespawnTimer;
 
+	/** Max number of top down aim updates sent to the server per second */
+	UPROPERTY(EditAnywhere, Category="Aim|Replication", meta = (ClampMin = 1, ClampMax = 120, Units = "Hz"))
+	float AimSendRate = 20.0f;
+
+	/** Min distance the top down aim location has to move before a new update is sent to the server */
+	UPROPERTY(EditAnywhere, Category="Aim|Replication", meta = (ClampMin = 0, ClampMax = 1000, Units = "cm"))
+	float AimSendThreshold = 5.0f;
+
+	/** Max time between aim updates while the aim is still. Updates are unreliable, so this resends the settled aim in case the last one was dropped */
+	UPROPERTY(EditAnywhere, Category="Aim|Replication", meta = (ClampMin = 0.1, ClampMax = 10, Units = "s"))
+	float AimKeepAliveInterval = 0.5f;
+
+	/** Interpolation speed used by the server and simulated proxies to smooth between received aim samples */
+	UPROPERTY(EditAnywhere, Category="Aim|Replication", meta = (ClampMin = 0, ClampMax = 100))
+	float AimInterpSpeed = 15.0f;
+
+	/** Last top down aim sample received from the owning client. Replicated to simulated proxies */
+	UPROPERTY(Replicated)
+	FVector_NetQuantize10 ReplicatedAimLocation;
+
+	/** If true, the aim sample is valid and should be interpolated towards */
+	UPROPERTY(Replicated)
+	bool bHasReplicatedAim = false;
+
+	/** Last aim location sent to the server */
+	FVector LastSentAimLocation = FVector::ZeroVector;
+
+	/** Time the last aim update was sent to the server */
+	float LastAimSendTime = -1.0f;
+
+	/** Aim payload bytes sent during the current measurement window */
+	int32 AimBytesSent = 0;
+
+	/** Aim payload bytes an unthrottled, unquantized update per aim change would have sent during the current measurement window */
+	int32 AimBytesUnthrottled = 0;
+
+	/** Start time of the current aim bandwidth measurement window */
+	float AimBandwidthWindowStart = 0.0f;
+
 public:
 
 	/** Bullet count updated delegate */
@@ -94,6 +144,9 @@ protected:
 	/** Gameplay cleanup */
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
+	/** Interpolates the top down aim towards the last received sample */
+	virtual void Tick(float DeltaTime) override;
+
 	/** Set up input action bindings */
 	virtual void SetupPlayerInputComponent(UInputComponent* InputComponent) override;
 
@@ -164,10 +217,18 @@ protected:
 	/** Called from the respawn timer to destroy this character and force the PC to respawn */
 	void OnRespawn();
 
-	/** Sync top down aim location to server */
-	UFUNCTION(Server, Reliable)
-	void ServerSetTopDownAimLocation(FVector AimLocation);
+	/** Sync a quantized top down aim sample to the server. Unreliable since newer samples supersede older ones */
+	UFUNCTION(Server, Unreliable)
+	void ServerSetTopDownAimLocation(FVector_NetQuantize10 AimLocation);
 
-	/** Called when top down aim location updates */
+	/** Called when top down aim location updates. Sends rate limited, delta thresholded samples to the server */
 	virtual void OnTopDownAimLocationUpdated(const FVector& AimLocation) override;
+
+	/** Accumulates the aim bandwidth counters and publishes them once per second */
+	void RecordAimBandwidth(int32 SentBytes, int32 UnthrottledBytes);
+
+public:
+
+	/** Sets up replicated properties */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 };
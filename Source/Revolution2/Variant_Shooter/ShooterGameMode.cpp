@@ -2,32 +2,27 @@
 
 
 #include "Variant_Shooter/ShooterGameMode.h"
-#include "ShooterUI.h"
-#include "Kismet/GameplayStatics.h"
-#include "Engine/World.h"
+#include "ShooterGameState.h"
 
-void AShooterGameMode::BeginPlay()
+AShooterGameMode::AShooterGameMode()
 {
-	Super::BeginPlay();
-
-	// create the UI
-	ShooterUI = CreateWidget<UShooterUI>(UGameplayStatics::GetPlayerController(GetWorld(), 0), ShooterUIClass);
-	ShooterUI->AddToViewport(0);
+	// scores replicate through the game state
+	GameStateClass = AShooterGameState::StaticClass();
 }
 
 void AShooterGameMode::IncrementTeamScore(uint8 TeamByte)
 {
-	// retrieve the team score if any
-	int32 Score = 0;
-	if (int32* FoundScore = TeamScores.Find(TeamByte))
+	AShooterGameState* ShooterGameState = GetGameState<AShooterGameState>();
+
+	// the kill still counts for listeners, but there is nowhere to keep the score
+	if (!ensureMsgf(ShooterGameState, TEXT("%s needs a ShooterGameState to keep team scores"), *GetName()))
 	{
-		Score = *FoundScore;
+		OnTeamScoreChanged.Broadcast(TeamByte, 0);
+		return;
 	}
 
-	// increment the score for the given team
-	++Score;
-	TeamScores.Add(TeamByte, Score);
+	// the game state updates the scoreboards on its own, once per frame
+	const int32 Score = ShooterGameState->AddTeamScore(TeamByte, 1);
 
-	// update the UI
-	ShooterUI->BP_UpdateScore(TeamByte, Score);
+	OnTeamScoreChanged.Broadcast(TeamByte, Score);
 }
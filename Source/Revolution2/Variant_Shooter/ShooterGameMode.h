@@ -8,10 +8,11 @@
 
 class UShooterUI;
 
+DECLARE_MULTICAST_DELEGATE_TwoParams(FShooterTeamScoreChangedDelegate, uint8 /* TeamByte */, int32 /* Score */);
+
 /**
  *  Simple GameMode for a first person shooter game
- *  Manages game UI
- *  Keeps track of team scores
+ *  Keeps track of team scores through the ShooterGameState
  */
 UCLASS(abstract)
 class REVOLUTION2_API AShooterGameMode : public AGameModeBase
@@ -20,23 +21,21 @@ class REVOLUTION2_API AShooterGameMode : public AGameModeBase
 	
 protected:
 
-	/** Type of UI widget to spawn */
+	/** Type of scoreboard UI widget the local player controllers spawn */
 	UPROPERTY(EditAnywhere, Category="Shooter")
 	TSubclassOf<UShooterUI> ShooterUIClass;
 
-	/** Pointer to the UI widget */
-	TObjectPtr<UShooterUI> ShooterUI;
-
-	/** Map of scores by team ID */
-	TMap<uint8, int32> TeamScores;
-
-protected:
+public:
 
-	/** Gameplay initialization */
-	virtual void BeginPlay() override;
+	/** Constructor */
+	AShooterGameMode();
 
-public:
+	/** Native delegate called on the server whenever a team scores */
+	FShooterTeamScoreChangedDelegate OnTeamScoreChanged;
 
 	/** Increases the score for the given team */
 	void IncrementTeamScore(uint8 TeamByte);
+
+	/** Returns the type of scoreboard UI widget to spawn */
+	TSubclassOf<UShooterUI> GetShooterUIClass() const { return ShooterUIClass; }
 };
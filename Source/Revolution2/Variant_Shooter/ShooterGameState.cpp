@@ -0,0 +1,100 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/ShooterGameState.h"
+#include "ShooterPlayerController.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "Net/UnrealNetwork.h"
+#include "Revolution2.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Team Score Changes"), STAT_ShooterTeamScoreChanges, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Scoreboard Updates"), STAT_ShooterScoreboardUpdates, STATGROUP_Shooter);
+
+AShooterGameState::AShooterGameState()
+{
+	FMemory::Memzero(TeamScores);
+	FMemory::Memzero(FlushedTeamScores);
+}
+
+int32 AShooterGameState::AddTeamScore(uint8 TeamByte, int32 Delta)
+{
+	if (TeamByte >= MaxTeams)
+	{
+		UE_LOG(LogRevolution2, Warning, TEXT("Team %d has no score slot, the scoreboard holds %d teams"), TeamByte, MaxTeams);
+		return 0;
+	}
+
+	TeamScores[TeamByte] += Delta;
+
+	// the server doesn't get rep notifies
+	MarkTeamDirty(TeamByte);
+
+	return TeamScores[TeamByte];
+}
+
+void AShooterGameState::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// clear the flush timer
+	GetWorld()->GetTimerManager().ClearTimer(FlushTimer);
+}
+
+void AShooterGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AShooterGameState, TeamScores);
+}
+
+void AShooterGameState::OnRep_TeamScores()
+{
+	// the notify doesn't say which elements arrived, so compare against what the scoreboards last showed
+	for (int32 TeamIndex = 0; TeamIndex < MaxTeams; ++TeamIndex)
+	{
+		if (TeamScores[TeamIndex] != FlushedTeamScores[TeamIndex])
+		{
+			MarkTeamDirty(TeamIndex);
+		}
+	}
+}
+
+void AShooterGameState::MarkTeamDirty(int32 TeamIndex)
+{
+	INC_DWORD_STAT(STAT_ShooterTeamScoreChanges);
+
+	// several kills in the same frame only schedule one flush
+	if (DirtyTeamMask == 0)
+	{
+		FlushTimer = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &AShooterGameState::FlushTeamScores);
+	}
+
+	DirtyTeamMask |= 1u << TeamIndex;
+}
+
+void AShooterGameState::FlushTeamScores()
+{
+	uint32 Mask = DirtyTeamMask;
+	DirtyTeamMask = 0;
+
+	while (Mask != 0)
+	{
+		const int32 TeamIndex = FMath::CountTrailingZeros(Mask);
+		Mask &= Mask - 1;
+
+		FlushedTeamScores[TeamIndex] = TeamScores[TeamIndex];
+
+		// only local players have a scoreboard. Dedicated servers have none
+		for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+		{
+			AShooterPlayerController* PC = Cast<AShooterPlayerController>(It->Get());
+
+			if (PC && PC->IsLocalController())
+			{
+				PC->UpdateTeamScore(static_cast<uint8>(TeamIndex), TeamScores[TeamIndex]);
+				INC_DWORD_STAT(STAT_ShooterScoreboardUpdates);
+			}
+		}
+	}
+}
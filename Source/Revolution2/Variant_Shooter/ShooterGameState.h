@@ -0,0 +1,67 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameStateBase.h"
+#include "ShooterGameState.generated.h"
+
+/**
+ *  Simple GameState for a first person shooter game
+ *  Replicates team scores to every machine
+ *  Pushes changed scores to the local scoreboards once per frame
+ */
+UCLASS()
+class REVOLUTION2_API AShooterGameState : public AGameStateBase
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Number of teams with a score slot. Team bytes outside this range don't score */
+	static constexpr int32 MaxTeams = 16;
+
+protected:
+
+	/** Scores indexed by team byte. Only the elements that changed are replicated */
+	UPROPERTY(ReplicatedUsing=OnRep_TeamScores)
+	int32 TeamScores[MaxTeams];
+
+	/** Scores last pushed to the scoreboards, to find what changed on clients */
+	int32 FlushedTeamScores[MaxTeams];
+
+	/** One bit per team whose score changed since the last flush */
+	uint32 DirtyTeamMask = 0;
+
+	/** Timer to flush the dirty scores on the next frame */
+	FTimerHandle FlushTimer;
+
+public:
+
+	/** Constructor */
+	AShooterGameState();
+
+	/** Adds to the score of the given team and returns the new score. Server only */
+	int32 AddTeamScore(uint8 TeamByte, int32 Delta);
+
+	/** Returns the current score of the given team */
+	int32 GetTeamScore(uint8 TeamByte) const { return TeamByte < MaxTeams ? TeamScores[TeamByte] : 0; }
+
+protected:
+
+	/** Gameplay cleanup */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Sets up replicated properties */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Marks the teams whose replicated score changed */
+	UFUNCTION()
+	void OnRep_TeamScores();
+
+	/** Marks the given team for the next flush */
+	void MarkTeamDirty(int32 TeamIndex);
+
+	/** Pushes every dirty score to the scoreboards of the local players */
+	void FlushTeamScores();
+};
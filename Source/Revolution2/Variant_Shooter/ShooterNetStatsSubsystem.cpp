@@ -0,0 +1,144 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterNetStatsSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetworkObjectList.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Revolution2.h"
+
+DECLARE_CYCLE_STAT(TEXT("Net Stats Sample"), STAT_ShooterNetStats, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Net Connections"), STAT_ShooterNetConnections, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Net Out Bytes/s (All Connections)"), STAT_ShooterNetOutBytes, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Net Out Bytes/s (Peak Connection)"), STAT_ShooterNetPeakOutBytes, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Net Replicated Actors"), STAT_ShooterNetActors, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Net Dormant Actors"), STAT_ShooterNetDormantActors, STATGROUP_Shooter);
+
+bool UShooterNetStatsSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+	{
+		return false;
+	}
+
+	const UWorld* OuterWorld = Cast<UWorld>(Outer);
+	return OuterWorld && OuterWorld->IsGameWorld();
+}
+
+void UShooterNetStatsSubsystem::Deinitialize()
+{
+	for (const FShooterConnectionStats& Stats : Connections)
+	{
+		UE_LOG(LogRevolution2, Log, TEXT("Net: %s averaged %lld out bytes/s, peaked at %d, over %d samples"),
+			*Stats.Name, Stats.NumSamples > 0 ? Stats.OutBytesPerSecondSum / Stats.NumSamples : 0, Stats.PeakOutBytesPerSecond, Stats.NumSamples);
+	}
+
+	Connections.Empty();
+
+	Super::Deinitialize();
+}
+
+void UShooterNetStatsSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeUntilSample -= DeltaTime;
+
+	if (TimeUntilSample > 0.0f)
+	{
+		return;
+	}
+
+	TimeUntilSample = SampleInterval;
+
+	SampleConnections();
+}
+
+bool UShooterNetStatsSubsystem::IsTickable() const
+{
+	// only servers have client connections to measure
+	const UWorld* World = GetWorld();
+	return World && World->GetNetDriver() && World->GetNetMode() != NM_Client;
+}
+
+TStatId UShooterNetStatsSubsystem::GetStatId() const
+{
+	return GET_STATID(STAT_ShooterNetStats);
+}
+
+void UShooterNetStatsSubsystem::SampleConnections()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterNetStats);
+
+	UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+
+	int32 TotalOutBytes = 0;
+	int32 PeakOutBytes = 0;
+
+	for (UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		if (!Connection)
+		{
+			continue;
+		}
+
+		FShooterConnectionStats* Stats = Connections.FindByPredicate([Connection](const FShooterConnectionStats& Entry) { return Entry.Connection == Connection; });
+
+		if (!Stats)
+		{
+			Stats = &Connections.AddDefaulted_GetRef();
+			Stats->Connection = Connection;
+		}
+
+		// the player controller may not exist yet when the connection is first seen
+		Stats->Name = Connection->PlayerController ? Connection->PlayerController->GetName() : Connection->LowLevelGetRemoteAddress(true);
+
+		Stats->OutBytesPerSecond = Connection->OutBytesPerSecond;
+		Stats->InBytesPerSecond = Connection->InBytesPerSecond;
+		Stats->PeakOutBytesPerSecond = FMath::Max(Stats->PeakOutBytesPerSecond, Connection->OutBytesPerSecond);
+		Stats->OutBytesPerSecondSum += Connection->OutBytesPerSecond;
+		++Stats->NumSamples;
+
+		TotalOutBytes += Connection->OutBytesPerSecond;
+		PeakOutBytes = FMath::Max(PeakOutBytes, Connection->OutBytesPerSecond);
+	}
+
+	// actors the server considers every net tick, and the ones dormancy takes out of that set
+	const FNetworkObjectList& NetworkObjects = NetDriver->GetNetworkObjectList();
+	NumNetworkActors = NetworkObjects.GetAllObjects().Num();
+	NumDormantActors = NetworkObjects.GetDormantObjectsOnAllConnections().Num();
+
+	SET_DWORD_STAT(STAT_ShooterNetConnections, NetDriver->ClientConnections.Num());
+	SET_DWORD_STAT(STAT_ShooterNetOutBytes, TotalOutBytes);
+	SET_DWORD_STAT(STAT_ShooterNetPeakOutBytes, PeakOutBytes);
+	SET_DWORD_STAT(STAT_ShooterNetActors, NumNetworkActors);
+	SET_DWORD_STAT(STAT_ShooterNetDormantActors, NumDormantActors);
+}
+
+void UShooterNetStatsSubsystem::DumpStats() const
+{
+	UE_LOG(LogRevolution2, Display, TEXT("Net: %d replicated actors, %d dormant on every connection"), NumNetworkActors, NumDormantActors);
+
+	for (const FShooterConnectionStats& Stats : Connections)
+	{
+		if (Stats.Connection.IsValid())
+		{
+			UE_LOG(LogRevolution2, Display, TEXT("Net: %s out %d bytes/s (peak %d), in %d bytes/s"), *Stats.Name, Stats.OutBytesPerSecond, Stats.PeakOutBytesPerSecond, Stats.InBytesPerSecond);
+		}
+	}
+}
+
+/** Prints the latest per-connection bandwidth sample */
+static FAutoConsoleCommandWithWorld ShooterNetStatsCommand(
+	TEXT("Shooter.Net.Stats"),
+	TEXT("Logs per-connection bandwidth and the number of replicated and dormant actors on the server"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UShooterNetStatsSubsystem* NetStats = World ? World->GetSubsystem<UShooterNetStatsSubsystem>() : nullptr)
+		{
+			NetStats->DumpStats();
+		}
+	}));
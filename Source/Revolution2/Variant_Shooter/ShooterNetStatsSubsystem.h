@@ -0,0 +1,79 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterNetStatsSubsystem.generated.h"
+
+class UNetConnection;
+
+/**
+ *  Bandwidth counters for a single client connection
+ */
+struct FShooterConnectionStats
+{
+	/** Connection being measured */
+	TWeakObjectPtr<UNetConnection> Connection;
+
+	/** Description of the connection for the log, e.g. the owning player controller */
+	FString Name;
+
+	/** Last sampled outgoing and incoming bytes per second */
+	int32 OutBytesPerSecond = 0;
+	int32 InBytesPerSecond = 0;
+
+	/** Peak outgoing bytes per second */
+	int32 PeakOutBytesPerSecond = 0;
+
+	/** Summed outgoing bytes per second over every sample, to average on shutdown */
+	int64 OutBytesPerSecondSum = 0;
+
+	/** Number of samples taken */
+	int32 NumSamples = 0;
+};
+
+/**
+ *  Samples per-connection bandwidth and the number of actors the server considers for replication
+ *  Only runs on servers. Counters are exposed through stat Shooter and logged on shutdown, and Shooter.Net.Stats prints the current values
+ */
+UCLASS()
+class REVOLUTION2_API UShooterNetStatsSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Stats for every client connection seen so far */
+	TArray<FShooterConnectionStats> Connections;
+
+	/** Time left until the next sample */
+	float TimeUntilSample = 0.0f;
+
+	/** Last sampled number of replicated actors, and how many of them are dormant for every connection */
+	int32 NumNetworkActors = 0;
+	int32 NumDormantActors = 0;
+
+public:
+
+	/** Time between samples. Connections update their byte rates about once a second */
+	static constexpr float SampleInterval = 1.0f;
+
+	/** Only create on game worlds */
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+	//~Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~End FTickableGameObject interface
+
+	/** Logs the latest sample for every connection */
+	void DumpStats() const;
+
+protected:
+
+	/** Samples every client connection on the net driver */
+	void SampleConnections();
+};
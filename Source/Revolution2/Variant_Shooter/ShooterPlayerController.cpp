@@ -5,10 +5,14 @@
 #include "EnhancedInputSubsystems.h"
 #include "Engine/LocalPlayer.h"
 #include "InputMappingContext.h"
-#include "Kismet/GameplayStatics.h"
 #include "GameFramework/PlayerStart.h"
 #include "ShooterCharacter.h"
 #include "ShooterBulletCounterUI.h"
+#include "ShooterUI.h"
+#include "ShooterHUDModel.h"
+#include "ShooterGameMode.h"
+#include "GameFramework/GameStateBase.h"
+#include "ShooterSpawnPointSubsystem.h"
 #include "Revolution2.h"
 #include "Widgets/Input/SVirtualJoystick.h"
 
@@ -36,6 +40,10 @@ void AShooterPlayerController::BeginPlay()
 			}
 		}
 
+		// widgets are updated through the HUD model, at most once per frame
+		HUDModel = NewObject<UShooterHUDModel>(this);
+		HUDModel->SetUpdateInterval(HUDUpdateInterval);
+
 		// create the bullet counter widget and add it to the screen
 		BulletCounterUI = CreateWidget<UShooterBulletCounterUI>(this, BulletCounterUIClass);
 
@@ -48,10 +56,26 @@ void AShooterPlayerController::BeginPlay()
 			UE_LOG(LogRevolution2, Error, TEXT("Could not spawn bullet counter widget."));
 
 		}
+
+		// create the scoreboard widget. Clients may not know the game mode yet, in which case the first score creates it
+		CreateScoreboardUI();
+
+		HUDModel->SetWidgets(BulletCounterUI, ShooterUI);
 		
 	}
 }
 
+void AShooterPlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// every controller ends play on map travel, so keep this out of the default log
+	if (HUDModel)
+	{
+		HUDModel->DumpStats(true);
+	}
+}
+
 void AShooterPlayerController::SetupInputComponent()
 {
 	// only add IMCs for local player controllers
@@ -102,19 +126,18 @@ void AShooterPlayerController::OnPossess(APawn* InPawn)
 void AShooterPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
 {
 	// reset the bullet counter HUD
-	BulletCounterUI->BP_UpdateBulletCounter(0, 0);
+	if (HUDModel)
+	{
+		HUDModel->SetAmmo(0, 0);
+	}
 
-	// find the player start
-	TArray<AActor*> ActorList;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), APlayerStart::StaticClass(), ActorList);
+	// pick a player start away from enemies from the spawn point registry
+	UShooterSpawnPointSubsystem* SpawnPointSubsystem = GetWorld()->GetSubsystem<UShooterSpawnPointSubsystem>();
 
-	if (ActorList.Num() > 0)
+	if (APlayerStart* PlayerStart = SpawnPointSubsystem ? SpawnPointSubsystem->FindSpawnPoint(RespawnEnemyTag, RespawnSafeDistance, RespawnRecentUseTime) : nullptr)
 	{
-		// select a random player start
-		AActor* RandomPlayerStart = ActorList[FMath::RandRange(0, ActorList.Num() - 1)];
-
 		// spawn a character at the player start
-		const FTransform SpawnTransform = RandomPlayerStart->GetActorTransform();
+		const FTransform SpawnTransform = PlayerStart->GetActorTransform();
 
 		if (AShooterCharacter* RespawnedCharacter = GetWorld()->SpawnActor<AShooterCharacter>(CharacterClass, SpawnTransform))
 		{
@@ -126,17 +149,72 @@ void AShooterPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
 
 void AShooterPlayerController::OnBulletCountUpdated(int32 MagazineSize, int32 Bullets)
 {
-	// update the UI
-	if (BulletCounterUI)
+	// update the UI on the next push
+	if (HUDModel)
 	{
-		BulletCounterUI->BP_UpdateBulletCounter(MagazineSize, Bullets);
+		HUDModel->SetAmmo(MagazineSize, Bullets);
 	}
 }
 
 void AShooterPlayerController::OnPawnDamaged(float LifePercent)
 {
-	if (IsValid(BulletCounterUI))
+	if (HUDModel)
+	{
+		HUDModel->SetLifePercent(LifePercent);
+	}
+}
+
+void AShooterPlayerController::CreateScoreboardUI()
+{
+	if (ShooterUI)
+	{
+		return;
+	}
+
+	// fall back to the scoreboard set on the game mode. Its class is replicated through the game state
+	TSubclassOf<UShooterUI> ScoreboardClass = ShooterUIClass;
+
+	if (!ScoreboardClass)
+	{
+		const AGameStateBase* GameState = GetWorld()->GetGameState();
+
+		if (const AShooterGameMode* GameModeCDO = GameState ? Cast<AShooterGameMode>(GameState->GetDefaultGameMode()) : nullptr)
+		{
+			ScoreboardClass = GameModeCDO->GetShooterUIClass();
+		}
+	}
+
+	if (!ScoreboardClass)
+	{
+		return;
+	}
+
+	ShooterUI = CreateWidget<UShooterUI>(this, ScoreboardClass);
+
+	if (ShooterUI)
+	{
+		ShooterUI->AddToPlayerScreen(0);
+
+		// catch the new scoreboard up with the scores so far
+		if (HUDModel)
+		{
+			HUDModel->SetWidgets(BulletCounterUI, ShooterUI);
+		}
+
+	} else {
+
+		UE_LOG(LogRevolution2, Error, TEXT("Could not spawn scoreboard widget."));
+
+	}
+}
+
+void AShooterPlayerController::UpdateTeamScore(uint8 TeamByte, int32 Score)
+{
+	CreateScoreboardUI();
+
+	// update the UI on the next push
+	if (HUDModel)
 	{
-		BulletCounterUI->BP_Damaged(LifePercent);
+		HUDModel->SetTeamScore(TeamByte, Score);
 	}
 }
@@ -9,6 +9,8 @@
 class UInputMappingContext;
 class AShooterCharacter;
 class UShooterBulletCounterUI;
+class UShooterUI;
+class UShooterHUDModel;
 
 /**
  *  Simple PlayerController for a first person shooter game
@@ -45,18 +47,48 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Shooter|UI")
 	TSubclassOf<UShooterBulletCounterUI> BulletCounterUIClass;
 
+	/** Type of scoreboard UI widget to spawn. If unset, the game mode's scoreboard is used */
+	UPROPERTY(EditAnywhere, Category="Shooter|UI")
+	TSubclassOf<UShooterUI> ShooterUIClass;
+
+	/** Min time between HUD widget updates. Zero updates the widgets at most once per frame */
+	UPROPERTY(EditAnywhere, Category="Shooter|UI", meta = (ClampMin = 0, ClampMax = 1, Units = "s"))
+	float HUDUpdateInterval = 0.0f;
+
 	/** Tag to grant the possessed pawn to flag it as the player */
 	UPROPERTY(EditAnywhere, Category="Shooter|Player")
 	FName PlayerPawnTag = FName("Player");
 
+	/** Tag of the pawns the respawned player should be kept away from */
+	UPROPERTY(EditAnywhere, Category="Shooter|Respawn")
+	FName RespawnEnemyTag = FName("Enemy");
+
+	/** Preferred min distance between the respawn point and any enemy */
+	UPROPERTY(EditAnywhere, Category="Shooter|Respawn", meta = (ClampMin = 0, ClampMax = 100000, Units = "cm"))
+	float RespawnSafeDistance = 2000.0f;
+
+	/** Time during which a recently used respawn point is avoided */
+	UPROPERTY(EditAnywhere, Category="Shooter|Respawn", meta = (ClampMin = 0, ClampMax = 600, Units = "s"))
+	float RespawnRecentUseTime = 10.0f;
+
 	/** Pointer to the bullet counter UI widget */
 	TObjectPtr<UShooterBulletCounterUI> BulletCounterUI;
 
+	/** Pointer to the scoreboard UI widget */
+	TObjectPtr<UShooterUI> ShooterUI;
+
+	/** Latest HUD values, pushed to the widgets only when they change */
+	UPROPERTY()
+	TObjectPtr<UShooterHUDModel> HUDModel;
+
 protected:
 
 	/** Gameplay Initialization */
 	virtual void BeginPlay() override;
 
+	/** Gameplay cleanup */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/** Initialize input bindings */
 	virtual void SetupInputComponent() override;
 
@@ -74,4 +106,15 @@ protected:
 	/** Called when the possessed pawn is damaged */
 	UFUNCTION()
 	void OnPawnDamaged(float LifePercent);
+
+	/** Spawns the scoreboard widget, once the scoreboard class is known */
+	void CreateScoreboardUI();
+
+public:
+
+	/** Shows a team score on the scoreboard. Called by the game state on local player controllers */
+	void UpdateTeamScore(uint8 TeamByte, int32 Score);
+
+	/** Returns the HUD model. Only local player controllers have one */
+	UShooterHUDModel* GetHUDModel() const { return HUDModel; }
 };
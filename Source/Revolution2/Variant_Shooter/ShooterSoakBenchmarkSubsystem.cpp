@@ -0,0 +1,376 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterSoakBenchmarkSubsystem.h"
+#include "ShooterGameMode.h"
+#include "ShooterNPC.h"
+#include "ShooterCorpseSubsystem.h"
+#include "ShooterProjectilePool.h"
+#include "ShooterProjectileManager.h"
+#include "NavigationSystem.h"
+#include "GameFramework/PlayerStart.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+#include "Revolution2.h"
+
+DECLARE_CYCLE_STAT(TEXT("Soak Benchmark"), STAT_ShooterSoakBenchmark, STATGROUP_Shooter);
+
+bool UShooterSoakBenchmarkSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer) || !FParse::Param(FCommandLine::Get(), TEXT("ShooterSoak")))
+	{
+		return false;
+	}
+
+	const UWorld* OuterWorld = Cast<UWorld>(Outer);
+	return OuterWorld && OuterWorld->IsGameWorld();
+}
+
+void UShooterSoakBenchmarkSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	AShooterGameMode* GameMode = Cast<AShooterGameMode>(InWorld.GetAuthGameMode());
+
+	if (!GameMode)
+	{
+		UE_LOG(LogRevolution2, Warning, TEXT("Shooter soak: %s doesn't run a Shooter game mode, skipping"), *InWorld.GetMapName());
+		return;
+	}
+
+	// read the options
+	const TCHAR* CommandLine = FCommandLine::Get();
+
+	FParse::Value(CommandLine, TEXT("ShooterSoakSeconds="), Duration);
+	FParse::Value(CommandLine, TEXT("ShooterSoakBots="), NumBots);
+	FParse::Value(CommandLine, TEXT("ShooterSoakRadius="), SpawnRadius);
+	FParse::Value(CommandLine, TEXT("ShooterSoakMaxP99Ms="), MaxP99Ms);
+
+	if (!FParse::Value(CommandLine, TEXT("ShooterSoakReport="), ReportPath))
+	{
+		ReportPath = FPaths::ProfilingDir() / FString::Printf(TEXT("ShooterSoak-%s-%s"), *InWorld.GetMapName(), *FDateTime::Now().ToString());
+	}
+
+	FString NPCClassPath;
+
+	if (FParse::Value(CommandLine, TEXT("ShooterSoakNPCClass="), NPCClassPath))
+	{
+		NPCClass = LoadClass<AShooterNPC>(nullptr, *NPCClassPath);
+	}
+
+	// fall back to the NPCs already placed in the level
+	if (!NPCClass)
+	{
+		for (TActorIterator<AShooterNPC> It(&InWorld); It; ++It)
+		{
+			NPCClass = It->GetClass();
+			break;
+		}
+	}
+
+	if (!NPCClass)
+	{
+		UE_LOG(LogRevolution2, Error, TEXT("Shooter soak: no NPC class to spawn. Pass -ShooterSoakNPCClass= or place an NPC in the level"));
+		FPlatformMisc::RequestExitWithStatus(false, 1);
+		return;
+	}
+
+	// spawn around the player starts, or the world origin if there are none
+	for (TActorIterator<APlayerStart> It(&InWorld); It; ++It)
+	{
+		SpawnOrigins.Add(It->GetActorLocation());
+	}
+
+	if (SpawnOrigins.Num() == 0)
+	{
+		SpawnOrigins.Add(FVector::ZeroVector);
+	}
+
+	// hook up the metrics
+	PreGCHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddUObject(this, &UShooterSoakBenchmarkSubsystem::OnPreGarbageCollect);
+	PostGCHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &UShooterSoakBenchmarkSubsystem::OnPostGarbageCollect);
+	ScoreHandle = GameMode->OnTeamScoreChanged.AddUObject(this, &UShooterSoakBenchmarkSubsystem::OnTeamScoreChanged);
+
+	FrameTimes.Reserve(FMath::CeilToInt32(Duration * 120.0));
+
+	StartTime = LastFrameTime = SampleStartTime = FPlatformTime::Seconds();
+	LastSceneQueryTotal = GetShooterSceneQueryTotal();
+	bRunning = true;
+
+	RefillBots();
+
+	UE_LOG(LogRevolution2, Display, TEXT("Shooter soak: running %s for %.0f seconds with %d bots of %s"), *InWorld.GetMapName(), Duration, NumBots, *NPCClass->GetName());
+}
+
+void UShooterSoakBenchmarkSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGCHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGCHandle);
+
+	if (AShooterGameMode* GameMode = Cast<AShooterGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		GameMode->OnTeamScoreChanged.Remove(ScoreHandle);
+	}
+
+	Bots.Empty();
+	Samples.Empty();
+	FrameTimes.Empty();
+
+	Super::Deinitialize();
+}
+
+void UShooterSoakBenchmarkSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterSoakBenchmark);
+
+	const double Now = FPlatformTime::Seconds();
+
+	// use the wall clock so fixed time step runs still measure the real frame cost
+	const double FrameMs = (Now - LastFrameTime) * 1000.0;
+	LastFrameTime = Now;
+
+	FrameTimes.Add(static_cast<float>(FrameMs));
+
+	++CurrentSample.Frames;
+	CurrentSample.FrameMsSum += FrameMs;
+	CurrentSample.FrameMsMax = FMath::Max(CurrentSample.FrameMsMax, FrameMs);
+	// gameplay code keeps a running total, so take what was added since the last tick
+	const uint64 SceneQueryTotal = GetShooterSceneQueryTotal();
+	CurrentSample.SceneQueries += static_cast<int32>(SceneQueryTotal - LastSceneQueryTotal);
+	LastSceneQueryTotal = SceneQueryTotal;
+
+	CurrentSample.MaxActors = FMath::Max(CurrentSample.MaxActors, GetWorld()->GetActorCount());
+
+	// count both pooled projectile actors and projectiles simulated by the manager
+	int32 NumProjectiles = 0;
+
+	if (const UShooterProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UShooterProjectilePoolSubsystem>())
+	{
+		NumProjectiles += Pool->GetStats().NumActive;
+	}
+
+	if (const UShooterProjectileManager* ProjectileManager = GetWorld()->GetSubsystem<UShooterProjectileManager>())
+	{
+		NumProjectiles += ProjectileManager->GetNumProjectiles();
+	}
+
+	CurrentSample.MaxProjectiles = FMath::Max(CurrentSample.MaxProjectiles, NumProjectiles);
+
+	// once per second, replace the bots that died and close the sample
+	if (Now - SampleStartTime >= 1.0)
+	{
+		RefillBots();
+		FlushSample(Now);
+	}
+
+	if (Now - StartTime >= Duration)
+	{
+		FinishSoak();
+	}
+}
+
+bool UShooterSoakBenchmarkSubsystem::IsTickable() const
+{
+	return bRunning;
+}
+
+TStatId UShooterSoakBenchmarkSubsystem::GetStatId() const
+{
+	return GET_STATID(STAT_ShooterSoakBenchmark);
+}
+
+void UShooterSoakBenchmarkSubsystem::RefillBots()
+{
+	// dead bots go back to the NPC pool rather than being destroyed
+	Bots.RemoveAll([](const TWeakObjectPtr<AShooterNPC>& Bot) { return !Bot.IsValid() || Bot->IsDead(); });
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	UShooterCorpseSubsystem* CorpseSubsystem = GetWorld()->GetSubsystem<UShooterCorpseSubsystem>();
+
+	// cap the attempts so a crowded level can't stall the frame
+	for (int32 Attempt = 0; Bots.Num() < NumBots && Attempt < NumBots * 2; ++Attempt)
+	{
+		FVector SpawnLocation = SpawnOrigins[FMath::RandRange(0, SpawnOrigins.Num() - 1)];
+
+		FNavLocation NavLocation;
+
+		if (NavSys && NavSys->GetRandomReachablePointInRadius(SpawnLocation, SpawnRadius, NavLocation))
+		{
+			SpawnLocation = NavLocation.Location;
+		}
+
+		// nav points sit on the floor, so lift the capsule off it
+		SpawnLocation.Z += 100.0f;
+
+		// reuse dead bots from the NPC pool when possible
+		const FTransform SpawnTransform(FRotator(0.0f, FMath::FRandRange(-180.0f, 180.0f), 0.0f), SpawnLocation);
+
+		AShooterNPC* Bot = CorpseSubsystem ? CorpseSubsystem->AcquireNPC(NPCClass, SpawnTransform) : nullptr;
+
+		if (!Bot)
+		{
+			continue;
+		}
+
+		// alternate teams for scoring. NPCs sense targets by the player tag, so tag every bot with it to have them fight each other
+		Bot->SetTeamByte(static_cast<uint8>(1 + (NumSpawned % 2)));
+		Bot->Tags.AddUnique(FName("Player"));
+
+		Bots.Add(Bot);
+		++NumSpawned;
+	}
+}
+
+void UShooterSoakBenchmarkSubsystem::FlushSample(double Now)
+{
+	CurrentSample.Time = Now - StartTime;
+	CurrentSample.Bots = Bots.Num();
+
+	Samples.Add(CurrentSample);
+
+	CurrentSample = FShooterSoakSample();
+	SampleStartTime = Now;
+}
+
+void UShooterSoakBenchmarkSubsystem::FinishSoak()
+{
+	bRunning = false;
+
+	if (CurrentSample.Frames > 0)
+	{
+		FlushSample(FPlatformTime::Seconds());
+	}
+
+	WriteCSVReport(ReportPath + TEXT(".csv"));
+	const float P99Ms = WriteJSONReport(ReportPath + TEXT(".json"));
+
+	// fail the run if the frame time regressed past the budget
+	const bool bFailed = MaxP99Ms > 0.0f && P99Ms > MaxP99Ms;
+
+	if (bFailed)
+	{
+		UE_LOG(LogRevolution2, Error, TEXT("Shooter soak: p99 frame time %.2f ms exceeds the %.2f ms budget"), P99Ms, MaxP99Ms);
+	}
+
+	FPlatformMisc::RequestExitWithStatus(false, bFailed ? 1 : 0);
+}
+
+void UShooterSoakBenchmarkSubsystem::WriteCSVReport(const FString& Path) const
+{
+	FString CSV = TEXT("Time,Frames,FrameMsAvg,FrameMsMax,SceneQueriesPerFrame,Projectiles,Actors,Bots,GCMs,ScoreEvents\n");
+
+	for (const FShooterSoakSample& Sample : Samples)
+	{
+		const double Frames = FMath::Max(Sample.Frames, 1);
+
+		CSV += FString::Printf(TEXT("%.2f,%d,%.3f,%.3f,%.1f,%d,%d,%d,%.3f,%d\n"),
+			Sample.Time, Sample.Frames, Sample.FrameMsSum / Frames, Sample.FrameMsMax,
+			Sample.SceneQueries / Frames, Sample.MaxProjectiles, Sample.MaxActors, Sample.Bots, Sample.GCMs, Sample.ScoreEvents);
+	}
+
+	if (FFileHelper::SaveStringToFile(CSV, *Path))
+	{
+		UE_LOG(LogRevolution2, Display, TEXT("Shooter soak: wrote %s"), *Path);
+
+	} else {
+
+		UE_LOG(LogRevolution2, Error, TEXT("Shooter soak: couldn't write %s"), *Path);
+	}
+}
+
+float UShooterSoakBenchmarkSubsystem::WriteJSONReport(const FString& Path)
+{
+	FrameTimes.Sort();
+
+	auto Percentile = [this](float Fraction)
+	{
+		return FrameTimes.Num() > 0 ? FrameTimes[FMath::Clamp(FMath::CeilToInt32(Fraction * FrameTimes.Num()) - 1, 0, FrameTimes.Num() - 1)] : 0.0f;
+	};
+
+	int32 TotalQueries = 0;
+	int32 PeakProjectiles = 0;
+	int32 PeakActors = 0;
+	int32 TotalScoreEvents = 0;
+
+	for (const FShooterSoakSample& Sample : Samples)
+	{
+		TotalQueries += Sample.SceneQueries;
+		PeakProjectiles = FMath::Max(PeakProjectiles, Sample.MaxProjectiles);
+		PeakActors = FMath::Max(PeakActors, Sample.MaxActors);
+		TotalScoreEvents += Sample.ScoreEvents;
+	}
+
+	FString TeamScores;
+
+	for (const TPair<uint8, int32>& TeamScore : TeamScoreEvents)
+	{
+		TeamScores += FString::Printf(TEXT("%s\"%d\": %d"), TeamScores.IsEmpty() ? TEXT("") : TEXT(", "), TeamScore.Key, TeamScore.Value);
+	}
+
+	const float P99Ms = Percentile(0.99f);
+
+	const FString JSON = FString::Printf(TEXT("{\n")
+		TEXT("\t\"map\": \"%s\",\n")
+		TEXT("\t\"seconds\": %.2f,\n")
+		TEXT("\t\"bots\": %d,\n")
+		TEXT("\t\"botsSpawned\": %d,\n")
+		TEXT("\t\"frames\": %d,\n")
+		TEXT("\t\"frameMs\": { \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f },\n")
+		TEXT("\t\"sceneQueriesPerFrame\": %.2f,\n")
+		TEXT("\t\"peakProjectiles\": %d,\n")
+		TEXT("\t\"peakActors\": %d,\n")
+		TEXT("\t\"gc\": { \"count\": %d, \"totalMs\": %.3f, \"maxMs\": %.3f },\n")
+		TEXT("\t\"scoreEvents\": %d,\n")
+		TEXT("\t\"scoreEventsByTeam\": { %s }\n")
+		TEXT("}\n"),
+		*GetWorld()->GetMapName(), FPlatformTime::Seconds() - StartTime, NumBots, NumSpawned, FrameTimes.Num(),
+		Percentile(0.5f), Percentile(0.9f), P99Ms, FrameTimes.Num() > 0 ? FrameTimes.Last() : 0.0f,
+		static_cast<double>(TotalQueries) / FMath::Max(FrameTimes.Num(), 1), PeakProjectiles, PeakActors,
+		NumGCs, GCMsTotal, GCMsMax, TotalScoreEvents, *TeamScores);
+
+	if (FFileHelper::SaveStringToFile(JSON, *Path))
+	{
+		UE_LOG(LogRevolution2, Display, TEXT("Shooter soak: wrote %s. p50 %.2f ms, p99 %.2f ms, %d score events"), *Path, Percentile(0.5f), P99Ms, TotalScoreEvents);
+
+	} else {
+
+		UE_LOG(LogRevolution2, Error, TEXT("Shooter soak: couldn't write %s"), *Path);
+	}
+
+	return P99Ms;
+}
+
+void UShooterSoakBenchmarkSubsystem::OnPreGarbageCollect()
+{
+	GCStartTime = FPlatformTime::Seconds();
+}
+
+void UShooterSoakBenchmarkSubsystem::OnPostGarbageCollect()
+{
+	if (!bRunning || GCStartTime <= 0.0)
+	{
+		return;
+	}
+
+	const double GCMs = (FPlatformTime::Seconds() - GCStartTime) * 1000.0;
+	GCStartTime = 0.0;
+
+	++NumGCs;
+	GCMsTotal += GCMs;
+	GCMsMax = FMath::Max(GCMsMax, GCMs);
+
+	CurrentSample.GCMs += GCMs;
+}
+
+void UShooterSoakBenchmarkSubsystem::OnTeamScoreChanged(uint8 TeamByte, int32 Score)
+{
+	++CurrentSample.ScoreEvents;
+	++TeamScoreEvents.FindOrAdd(TeamByte);
+}
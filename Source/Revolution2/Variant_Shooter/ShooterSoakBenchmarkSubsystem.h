@@ -0,0 +1,159 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterSoakBenchmarkSubsystem.generated.h"
+
+class AShooterNPC;
+
+/**
+ *  Metrics gathered over one second of the soak
+ */
+struct FShooterSoakSample
+{
+	/** Time since the soak started */
+	double Time = 0.0;
+
+	/** Number of frames in this sample */
+	int32 Frames = 0;
+
+	/** Summed and worst wall clock frame time, in milliseconds */
+	double FrameMsSum = 0.0;
+	double FrameMsMax = 0.0;
+
+	/** Scene queries issued by gameplay code */
+	int32 SceneQueries = 0;
+
+	/** Peak number of projectiles in flight, pooled actors plus managed projectiles */
+	int32 MaxProjectiles = 0;
+
+	/** Peak number of actors in the world */
+	int32 MaxActors = 0;
+
+	/** Number of live bots at the end of the sample */
+	int32 Bots = 0;
+
+	/** Time spent in garbage collection */
+	double GCMs = 0.0;
+
+	/** Number of team score events */
+	int32 ScoreEvents = 0;
+};
+
+/**
+ *  Headless bot soak for the Shooter variant
+ *  Only created when the game runs with -ShooterSoak, e.g. a dedicated server with -nullrhi
+ *  Keeps a population of NPCs fighting each other, then writes CSV and JSON reports and exits
+ *
+ *  Options:
+ *  -ShooterSoakSeconds=N		how long to run, 60 by default
+ *  -ShooterSoakBots=N			number of NPCs to keep alive, 16 by default
+ *  -ShooterSoakNPCClass=Path	NPC class to spawn. Defaults to the class of the first NPC in the level
+ *  -ShooterSoakRadius=N		navigable radius around the player starts to spawn NPCs in
+ *  -ShooterSoakReport=Path		report path without extension. Defaults to Saved/Profiling/ShooterSoak
+ *  -ShooterSoakMaxP99Ms=N		exits with a non-zero code if the 99th percentile frame time exceeds this
+ */
+UCLASS()
+class REVOLUTION2_API UShooterSoakBenchmarkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Options parsed from the command line */
+	double Duration = 60.0;
+	int32 NumBots = 16;
+	float SpawnRadius = 3000.0f;
+	float MaxP99Ms = 0.0f;
+	FString ReportPath;
+
+	/** NPC class to spawn */
+	UPROPERTY()
+	TSubclassOf<AShooterNPC> NPCClass;
+
+	/** Bots spawned by the soak */
+	TArray<TWeakObjectPtr<AShooterNPC>> Bots;
+
+	/** Number of bots spawned so far, used to alternate teams */
+	int32 NumSpawned = 0;
+
+	/** Locations to spawn bots around */
+	TArray<FVector> SpawnOrigins;
+
+	/** Per second samples */
+	TArray<FShooterSoakSample> Samples;
+
+	/** Sample being gathered */
+	FShooterSoakSample CurrentSample;
+
+	/** Every frame time, in milliseconds, to compute percentiles */
+	TArray<float> FrameTimes;
+
+	/** Score events by team */
+	TMap<uint8, int32> TeamScoreEvents;
+
+	/** Wall clock time the soak started, the last frame started and the current sample started */
+	double StartTime = 0.0;
+	double LastFrameTime = 0.0;
+	double SampleStartTime = 0.0;
+
+	/** Wall clock time the current garbage collection started */
+	double GCStartTime = 0.0;
+
+	/** Garbage collection totals */
+	int32 NumGCs = 0;
+	double GCMsTotal = 0.0;
+	double GCMsMax = 0.0;
+
+	/** If true, the soak is running */
+	bool bRunning = false;
+
+	/** Delegate handles */
+	FDelegateHandle PreGCHandle;
+	FDelegateHandle PostGCHandle;
+	FDelegateHandle ScoreHandle;
+
+	/** Scene query total at the last tick */
+	uint64 LastSceneQueryTotal = 0;
+
+public:
+
+	/** Only create the subsystem for game worlds when the soak was requested */
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** Starts the soak */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+	//~Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~End FTickableGameObject interface
+
+protected:
+
+	/** Spawns bots until the population is back to the requested size */
+	void RefillBots();
+
+	/** Closes the current sample and starts a new one */
+	void FlushSample(double Now);
+
+	/** Writes the reports, then asks the engine to exit */
+	void FinishSoak();
+
+	/** Writes the per second CSV report */
+	void WriteCSVReport(const FString& Path) const;
+
+	/** Writes the JSON summary. Returns the 99th percentile frame time */
+	float WriteJSONReport(const FString& Path);
+
+	/** Garbage collection timing */
+	void OnPreGarbageCollect();
+	void OnPostGarbageCollect();
+
+	/** Called by the game mode whenever a team scores */
+	void OnTeamScoreChanged(uint8 TeamByte, int32 Score);
+};
@@ -0,0 +1,304 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterSpawnPointSubsystem.h"
+#include "GameFramework/PlayerStart.h"
+#include "GameFramework/Pawn.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Revolution2.h"
+
+DECLARE_CYCLE_STAT(TEXT("Find Spawn Point"), STAT_ShooterFindSpawnPoint, STATGROUP_Shooter);
+
+void UShooterSpawnPointSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// register the player starts already in the world. TActorIterator only visits player starts, not the whole actor list
+	for (TActorIterator<APlayerStart> It(&InWorld); It; ++It)
+	{
+		RegisterSpawnPoint(*It);
+	}
+
+	// listen for player starts added later
+	ActorSpawnedHandle = InWorld.AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UShooterSpawnPointSubsystem::OnActorSpawned));
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UShooterSpawnPointSubsystem::OnLevelAdded);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UShooterSpawnPointSubsystem::OnLevelRemoved);
+}
+
+void UShooterSpawnPointSubsystem::Deinitialize()
+{
+	if (ActorSpawnedHandle.IsValid())
+	{
+		GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	SpawnPoints.Empty();
+	RegisteredPlayerStarts.Empty();
+	CandidateOrder.Empty();
+
+	Super::Deinitialize();
+}
+
+void UShooterSpawnPointSubsystem::RegisterSpawnPoint(APlayerStart* PlayerStart)
+{
+	if (!IsValid(PlayerStart))
+	{
+		return;
+	}
+
+	// streamed levels register every actor they add, so skip the ones we already have
+	bool bAlreadyRegistered = false;
+	RegisteredPlayerStarts.Add(PlayerStart, &bAlreadyRegistered);
+
+	if (bAlreadyRegistered)
+	{
+		return;
+	}
+
+	FShooterSpawnPoint& SpawnPoint = SpawnPoints.AddDefaulted_GetRef();
+	SpawnPoint.PlayerStart = PlayerStart;
+	SpawnPoint.Location = PlayerStart->GetActorLocation();
+
+	CandidateOrder.Add(SpawnPoints.Num() - 1);
+}
+
+APlayerStart* UShooterSpawnPointSubsystem::FindSpawnPoint(FName EnemyTag, float SafeDistance, float RecentUseTime, bool bMarkUsed)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterFindSpawnPoint);
+
+	const int32 NumSpawnPoints = CandidateOrder.Num();
+
+	if (NumSpawnPoints == 0)
+	{
+		return nullptr;
+	}
+
+	SafeDistance = FMath::Max(SafeDistance, 1.0f);
+
+	BuildEnemyIndex(EnemyTag, SafeDistance);
+
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+
+	int32 BestIndex = INDEX_NONE;
+	float BestScore = -1.0f;
+	bool bFoundStale = false;
+
+	// sample candidates without replacement by partially shuffling the permutation
+	const int32 NumCandidates = FMath::Min(NumSpawnPoints, MaxCandidates);
+
+	for (int32 i = 0; i < NumCandidates; ++i)
+	{
+		CandidateOrder.Swap(i, FMath::RandRange(i, NumSpawnPoints - 1));
+
+		const FShooterSpawnPoint& SpawnPoint = SpawnPoints[CandidateOrder[i]];
+
+		if (!SpawnPoint.PlayerStart.IsValid())
+		{
+			bFoundStale = true;
+			continue;
+		}
+
+		// score the distance to the nearest enemy, up to the safe distance
+		const float SafetyScore = GetDistanceToNearestEnemy(SpawnPoint.Location, SafeDistance) / SafeDistance;
+
+		// score how long ago this spawn point was used
+		const float RecencyScore = RecentUseTime > 0.0f ? FMath::Min(static_cast<float>(CurrentTime - SpawnPoint.LastUseTime) / RecentUseTime, 1.0f) : 1.0f;
+
+		// safety matters most. Add a little noise to break ties between equally good spawn points
+		const float Score = SafetyScore * 2.0f + RecencyScore + FMath::FRand() * 0.01f;
+
+		if (Score > BestScore)
+		{
+			BestScore = Score;
+			BestIndex = CandidateOrder[i];
+		}
+	}
+
+	// pick the best one before pruning moves the indices around
+	APlayerStart* BestPlayerStart = BestIndex != INDEX_NONE ? SpawnPoints[BestIndex].PlayerStart.Get() : nullptr;
+
+	if (BestPlayerStart && bMarkUsed)
+	{
+		SpawnPoints[BestIndex].LastUseTime = CurrentTime;
+	}
+
+	// player starts destroyed without their level going away are only noticed when sampled
+	if (bFoundStale)
+	{
+		PruneSpawnPoints();
+	}
+
+	// every sample was stale, so take any start that's still around rather than failing the spawn
+	if (!BestPlayerStart && SpawnPoints.Num() > 0)
+	{
+		FShooterSpawnPoint& SpawnPoint = SpawnPoints[FMath::RandRange(0, SpawnPoints.Num() - 1)];
+
+		if (bMarkUsed)
+		{
+			SpawnPoint.LastUseTime = CurrentTime;
+		}
+
+		BestPlayerStart = SpawnPoint.PlayerStart.Get();
+	}
+
+	return BestPlayerStart;
+}
+
+void UShooterSpawnPointSubsystem::OnActorSpawned(AActor* SpawnedActor)
+{
+	if (APlayerStart* PlayerStart = Cast<APlayerStart>(SpawnedActor))
+	{
+		RegisterSpawnPoint(PlayerStart);
+	}
+}
+
+void UShooterSpawnPointSubsystem::OnLevelAdded(ULevel* InLevel, UWorld* InWorld)
+{
+	if (InWorld != GetWorld() || !InLevel)
+	{
+		return;
+	}
+
+	for (AActor* LevelActor : InLevel->Actors)
+	{
+		OnActorSpawned(LevelActor);
+	}
+}
+
+void UShooterSpawnPointSubsystem::OnLevelRemoved(ULevel* InLevel, UWorld* InWorld)
+{
+	if (InWorld != GetWorld() || !InLevel)
+	{
+		return;
+	}
+
+	// the level's actors may not be destroyed yet, so drop them by their level
+	SpawnPoints.RemoveAll([InLevel](const FShooterSpawnPoint& SpawnPoint) { return SpawnPoint.PlayerStart.IsValid() && SpawnPoint.PlayerStart->GetLevel() == InLevel; });
+
+	PruneSpawnPoints();
+}
+
+void UShooterSpawnPointSubsystem::PruneSpawnPoints()
+{
+	SpawnPoints.RemoveAll([](const FShooterSpawnPoint& SpawnPoint) { return !SpawnPoint.PlayerStart.IsValid(); });
+
+	// the permutation only needs to cover every index. The order is reshuffled by each query anyway
+	CandidateOrder.Reset();
+	RegisteredPlayerStarts.Reset();
+
+	for (int32 i = 0; i < SpawnPoints.Num(); ++i)
+	{
+		CandidateOrder.Add(i);
+		RegisteredPlayerStarts.Add(SpawnPoints[i].PlayerStart);
+	}
+}
+
+void UShooterSpawnPointSubsystem::BuildEnemyIndex(FName EnemyTag, float CellSize)
+{
+	EnemyCells.Reset();
+	EnemyCellSize = CellSize;
+
+	// only pawns can be enemies, so we don't need to walk the whole actor list
+	for (TActorIterator<APawn> It(GetWorld()); It; ++It)
+	{
+		if (It->ActorHasTag(EnemyTag))
+		{
+			EnemyCells.FindOrAdd(GetEnemyCell(It->GetActorLocation())).Add(It->GetActorLocation());
+		}
+	}
+}
+
+float UShooterSpawnPointSubsystem::GetDistanceToNearestEnemy(const FVector& Location, float MaxDistance) const
+{
+	// cells are as large as the max distance, so we only need to check the neighboring cells
+	const FIntPoint Cell = GetEnemyCell(Location);
+
+	float NearestDistanceSquared = FMath::Square(MaxDistance);
+
+	for (int32 X = Cell.X - 1; X <= Cell.X + 1; ++X)
+	{
+		for (int32 Y = Cell.Y - 1; Y <= Cell.Y + 1; ++Y)
+		{
+			if (const TArray<FVector, TInlineAllocator<4>>* Enemies = EnemyCells.Find(FIntPoint(X, Y)))
+			{
+				for (const FVector& EnemyLocation : *Enemies)
+				{
+					NearestDistanceSquared = FMath::Min(NearestDistanceSquared, static_cast<float>(FVector::DistSquared(Location, EnemyLocation)));
+				}
+			}
+		}
+	}
+
+	return FMath::Sqrt(NearestDistanceSquared);
+}
+
+FIntPoint UShooterSpawnPointSubsystem::GetEnemyCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / EnemyCellSize), FMath::FloorToInt32(Location.Y / EnemyCellSize));
+}
+
+/** Compares the spawn point registry against walking the actor list. Optionally pads the level with extra actors first */
+static FAutoConsoleCommandWithWorldAndArgs ShooterSpawnPointBenchmarkCommand(
+	TEXT("Shooter.SpawnPoints.Benchmark"),
+	TEXT("Times spawn point selection through the registry vs GetAllActorsOfClass. Usage: Shooter.SpawnPoints.Benchmark [Iterations=1000] [ExtraActors=0]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UShooterSpawnPointSubsystem* SpawnPointSubsystem = World ? World->GetSubsystem<UShooterSpawnPointSubsystem>() : nullptr;
+
+		if (!SpawnPointSubsystem)
+		{
+			return;
+		}
+
+		const int32 Iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000;
+		const int32 ExtraActors = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 0) : 0;
+
+		// pad the level to simulate a large map
+		TArray<AActor*> PaddingActors;
+
+		for (int32 i = 0; i < ExtraActors; ++i)
+		{
+			PaddingActors.Add(World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity));
+		}
+
+		// time walking the actor list
+		const double ActorListStart = FPlatformTime::Seconds();
+
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			TArray<AActor*> ActorList;
+			UGameplayStatics::GetAllActorsOfClass(World, APlayerStart::StaticClass(), ActorList);
+		}
+
+		const double ActorListTime = FPlatformTime::Seconds() - ActorListStart;
+
+		// time the registry. Don't flag the picks as used, so the benchmark doesn't skew the next real respawns
+		const double RegistryStart = FPlatformTime::Seconds();
+
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			SpawnPointSubsystem->FindSpawnPoint(FName("Enemy"), 2000.0f, 0.0f, false);
+		}
+
+		const double RegistryTime = FPlatformTime::Seconds() - RegistryStart;
+
+		UE_LOG(LogRevolution2, Display, TEXT("Spawn point benchmark: %d spawn points, %d actors, %d iterations. GetAllActorsOfClass: %.3f us/query, registry: %.3f us/query"),
+			SpawnPointSubsystem->GetNumSpawnPoints(), World->PersistentLevel->Actors.Num(), Iterations,
+			ActorListTime * 1000000.0 / Iterations, RegistryTime * 1000000.0 / Iterations);
+
+		// remove the padding actors
+		for (AActor* PaddingActor : PaddingActors)
+		{
+			if (PaddingActor)
+			{
+				PaddingActor->Destroy();
+			}
+		}
+	}));
@@ -0,0 +1,106 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterSpawnPointSubsystem.generated.h"
+
+class APlayerStart;
+class ULevel;
+
+/**
+ *  A registered spawn point
+ */
+struct FShooterSpawnPoint
+{
+	/** Player start actor */
+	TWeakObjectPtr<APlayerStart> PlayerStart;
+
+	/** Cached player start location */
+	FVector Location = FVector::ZeroVector;
+
+	/** Last time a player was spawned here */
+	double LastUseTime = -UE_BIG_NUMBER;
+};
+
+/**
+ *  Keeps a registry of player starts so respawns don't need to walk the actor list
+ *  Picks spawn points away from enemies and not recently used.
+ *  Each query scores a fixed number of sampled candidates against a grid of enemy locations, so its cost doesn't grow with the number of spawn points
+ */
+UCLASS()
+class REVOLUTION2_API UShooterSpawnPointSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Registered spawn points */
+	TArray<FShooterSpawnPoint> SpawnPoints;
+
+	/** Player starts in the registry, for constant time duplicate checks */
+	TSet<TWeakObjectPtr<APlayerStart>> RegisteredPlayerStarts;
+
+	/** Permutation of spawn point indices used to sample candidates without replacement */
+	TArray<int32> CandidateOrder;
+
+	/** Enemy locations bucketed in a 2D grid, rebuilt for each query */
+	TMap<FIntPoint, TArray<FVector, TInlineAllocator<4>>> EnemyCells;
+
+	/** Size of the enemy grid cells for the current query */
+	float EnemyCellSize = 1.0f;
+
+	/** Handle for the actor spawned delegate */
+	FDelegateHandle ActorSpawnedHandle;
+
+	/** Handle for the level added delegate */
+	FDelegateHandle LevelAddedHandle;
+
+	/** Handle for the level removed delegate */
+	FDelegateHandle LevelRemovedHandle;
+
+	/** Max number of spawn points scored per query */
+	static constexpr int32 MaxCandidates = 16;
+
+public:
+
+	/** Registers the player starts already in the world and listens for new ones */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+	/** Adds a player start to the registry */
+	void RegisterSpawnPoint(APlayerStart* PlayerStart);
+
+	/**
+	 *  Picks a spawn point and flags it as used, unless bMarkUsed is false.
+	 *  Prefers spawn points that are at least SafeDistance away from any pawn tagged with EnemyTag, and that haven't been used within RecentUseTime.
+	 */
+	APlayerStart* FindSpawnPoint(FName EnemyTag, float SafeDistance, float RecentUseTime, bool bMarkUsed = true);
+
+	/** Returns the number of registered spawn points */
+	int32 GetNumSpawnPoints() const { return SpawnPoints.Num(); }
+
+protected:
+
+	/** Registers any player start spawned at runtime */
+	void OnActorSpawned(AActor* SpawnedActor);
+
+	/** Registers the player starts in a streamed in level */
+	void OnLevelAdded(ULevel* InLevel, UWorld* InWorld);
+
+	/** Drops the player starts of a streamed out level */
+	void OnLevelRemoved(ULevel* InLevel, UWorld* InWorld);
+
+	/** Removes spawn points whose player start is gone and rebuilds the candidate permutation */
+	void PruneSpawnPoints();
+
+	/** Buckets the locations of every pawn with the enemy tag */
+	void BuildEnemyIndex(FName EnemyTag, float CellSize);
+
+	/** Returns the distance to the nearest enemy, or MaxDistance if there are none closer */
+	float GetDistanceToNearestEnemy(const FVector& Location, float MaxDistance) const;
+
+	/** Returns the enemy grid cell containing the location */
+	FIntPoint GetEnemyCell(const FVector& Location) const;
+};
@@ -0,0 +1,202 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterHUDModel.h"
+#include "ShooterBulletCounterUI.h"
+#include "ShooterUI.h"
+#include "ShooterPlayerController.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Revolution2.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("HUD Value Updates"), STAT_ShooterHUDValueUpdates, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("HUD Widget Updates"), STAT_ShooterHUDWidgetUpdates, STATGROUP_Shooter);
+
+void UShooterHUDModel::SetWidgets(UShooterBulletCounterUI* InBulletCounterUI, UShooterUI* InScoreboardUI)
+{
+	// new widgets start out knowing nothing
+	if (InBulletCounterUI && InBulletCounterUI != BulletCounterUI.Get())
+	{
+		bAmmoDirty = true;
+		bLifeDirty = true;
+	}
+
+	if (InScoreboardUI && InScoreboardUI != ScoreboardUI.Get())
+	{
+		for (int32 TeamIndex = 0; TeamIndex < MaxTeams; ++TeamIndex)
+		{
+			if (TeamScores[TeamIndex] != 0)
+			{
+				DirtyTeamMask |= 1u << TeamIndex;
+			}
+		}
+	}
+
+	BulletCounterUI = InBulletCounterUI;
+	ScoreboardUI = InScoreboardUI;
+
+	if (bAmmoDirty || bLifeDirty || DirtyTeamMask != 0)
+	{
+		SchedulePush();
+	}
+}
+
+void UShooterHUDModel::SetAmmo(int32 InMagazineSize, int32 InBullets)
+{
+	++NumValueUpdates;
+	INC_DWORD_STAT(STAT_ShooterHUDValueUpdates);
+
+	if (InMagazineSize == MagazineSize && InBullets == Bullets)
+	{
+		return;
+	}
+
+	MagazineSize = InMagazineSize;
+	Bullets = InBullets;
+	bAmmoDirty = true;
+
+	SchedulePush();
+}
+
+void UShooterHUDModel::SetLifePercent(float InLifePercent)
+{
+	++NumValueUpdates;
+	INC_DWORD_STAT(STAT_ShooterHUDValueUpdates);
+
+	if (InLifePercent == LifePercent)
+	{
+		return;
+	}
+
+	LifePercent = InLifePercent;
+	bLifeDirty = true;
+
+	SchedulePush();
+}
+
+void UShooterHUDModel::SetTeamScore(uint8 TeamByte, int32 Score)
+{
+	++NumValueUpdates;
+	INC_DWORD_STAT(STAT_ShooterHUDValueUpdates);
+
+	if (TeamByte >= MaxTeams || TeamScores[TeamByte] == Score)
+	{
+		return;
+	}
+
+	TeamScores[TeamByte] = Score;
+	DirtyTeamMask |= 1u << TeamByte;
+
+	SchedulePush();
+}
+
+void UShooterHUDModel::SchedulePush()
+{
+	if (bPushScheduled)
+	{
+		return;
+	}
+
+	UWorld* World = GetWorld();
+
+	if (!World)
+	{
+		PushToWidgets();
+		return;
+	}
+
+	bPushScheduled = true;
+
+	// wait out the rest of the update interval, or at least until the next frame
+	const double Delay = LastPushTime >= 0.0 ? LastPushTime + UpdateInterval - World->GetTimeSeconds() : 0.0;
+
+	if (Delay > 0.0)
+	{
+		World->GetTimerManager().SetTimer(PushTimer, this, &UShooterHUDModel::PushToWidgets, static_cast<float>(Delay), false);
+
+	} else {
+
+		PushTimer = World->GetTimerManager().SetTimerForNextTick(this, &UShooterHUDModel::PushToWidgets);
+
+	}
+}
+
+void UShooterHUDModel::PushToWidgets()
+{
+	bPushScheduled = false;
+
+	if (const UWorld* World = GetWorld())
+	{
+		LastPushTime = World->GetTimeSeconds();
+	}
+
+	if (UShooterBulletCounterUI* BulletCounter = BulletCounterUI.Get())
+	{
+		if (bAmmoDirty)
+		{
+			BulletCounter->BP_UpdateBulletCounter(MagazineSize, Bullets);
+			++NumWidgetUpdates;
+			INC_DWORD_STAT(STAT_ShooterHUDWidgetUpdates);
+		}
+
+		if (bLifeDirty)
+		{
+			BulletCounter->BP_Damaged(LifePercent);
+			++NumWidgetUpdates;
+			INC_DWORD_STAT(STAT_ShooterHUDWidgetUpdates);
+		}
+
+		bAmmoDirty = false;
+		bLifeDirty = false;
+	}
+
+	// scores wait for the scoreboard, which may be created late on clients
+	if (UShooterUI* Scoreboard = ScoreboardUI.Get())
+	{
+		while (DirtyTeamMask != 0)
+		{
+			const int32 TeamIndex = FMath::CountTrailingZeros(DirtyTeamMask);
+			DirtyTeamMask &= DirtyTeamMask - 1;
+
+			Scoreboard->BP_UpdateScore(static_cast<uint8>(TeamIndex), TeamScores[TeamIndex]);
+			++NumWidgetUpdates;
+			INC_DWORD_STAT(STAT_ShooterHUDWidgetUpdates);
+		}
+	}
+}
+
+void UShooterHUDModel::DumpStats(bool bVerbose) const
+{
+	if (bVerbose)
+	{
+		UE_LOG(LogRevolution2, Verbose, TEXT("HUD: %d value updates, %d widget updates, %d coalesced"), NumValueUpdates, NumWidgetUpdates, GetNumCoalescedUpdates());
+
+	} else {
+
+		UE_LOG(LogRevolution2, Display, TEXT("HUD: %d value updates, %d widget updates, %d coalesced"), NumValueUpdates, NumWidgetUpdates, GetNumCoalescedUpdates());
+
+	}
+}
+
+/** Prints the coalescing stats of every local player's HUD */
+static FAutoConsoleCommandWithWorld ShooterHUDStatsCommand(
+	TEXT("Shooter.HUD.Stats"),
+	TEXT("Logs how many HUD value updates were coalesced into fewer widget updates for each local player"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (!World)
+		{
+			return;
+		}
+
+		for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+		{
+			const AShooterPlayerController* PC = Cast<AShooterPlayerController>(It->Get());
+
+			if (const UShooterHUDModel* HUDModel = PC ? PC->GetHUDModel() : nullptr)
+			{
+				HUDModel->DumpStats();
+			}
+		}
+	}));
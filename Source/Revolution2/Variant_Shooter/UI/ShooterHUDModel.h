@@ -0,0 +1,89 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Engine/TimerHandle.h"
+#include "ShooterGameState.h"
+#include "ShooterHUDModel.generated.h"
+
+class UShooterBulletCounterUI;
+class UShooterUI;
+
+/**
+ *  Latest ammo, life and team score values shown on a local player's HUD
+ *  Values can change any number of times per frame. Widgets are only told about the ones that changed, at most once per update interval
+ */
+UCLASS()
+class REVOLUTION2_API UShooterHUDModel : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Number of teams with a score slot, same as the game state */
+	static constexpr int32 MaxTeams = AShooterGameState::MaxTeams;
+
+protected:
+
+	/** Widget showing ammo and life */
+	TWeakObjectPtr<UShooterBulletCounterUI> BulletCounterUI;
+
+	/** Widget showing team scores */
+	TWeakObjectPtr<UShooterUI> ScoreboardUI;
+
+	/** Min time between widget updates. Zero updates at most once per frame */
+	float UpdateInterval = 0.0f;
+
+	/** Latest values */
+	int32 MagazineSize = 0;
+	int32 Bullets = 0;
+	float LifePercent = 1.0f;
+	int32 TeamScores[MaxTeams] = {};
+
+	/** What changed since the last push */
+	bool bAmmoDirty = false;
+	bool bLifeDirty = false;
+	uint32 DirtyTeamMask = 0;
+
+	/** Timer to push the changes to the widgets */
+	FTimerHandle PushTimer;
+
+	/** If true, a push is already scheduled */
+	bool bPushScheduled = false;
+
+	/** Time of the last push to the widgets */
+	double LastPushTime = -1.0;
+
+	/** Values set, and widget updates actually made */
+	int32 NumValueUpdates = 0;
+	int32 NumWidgetUpdates = 0;
+
+public:
+
+	/** Sets the widgets to push to. A new scoreboard gets every score so far */
+	void SetWidgets(UShooterBulletCounterUI* InBulletCounterUI, UShooterUI* InScoreboardUI);
+
+	/** Sets the min time between widget updates */
+	void SetUpdateInterval(float InUpdateInterval) { UpdateInterval = FMath::Max(0.0f, InUpdateInterval); }
+
+	/** Value setters. Unchanged values are ignored */
+	void SetAmmo(int32 InMagazineSize, int32 InBullets);
+	void SetLifePercent(float InLifePercent);
+	void SetTeamScore(uint8 TeamByte, int32 Score);
+
+	/** Number of value updates that didn't need a widget update of their own */
+	int32 GetNumCoalescedUpdates() const { return FMath::Max(0, NumValueUpdates - NumWidgetUpdates); }
+
+	/** Logs how many updates were coalesced. Verbose logging is only shown when LogRevolution2 is turned up */
+	void DumpStats(bool bVerbose = false) const;
+
+protected:
+
+	/** Schedules a push if there isn't one already */
+	void SchedulePush();
+
+	/** Pushes every changed value to the widgets */
+	void PushToWidgets();
+};
@@ -0,0 +1,237 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterExplosionSubsystem.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/Character.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/World.h"
+#include "Revolution2.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosion Candidates"), STAT_ShooterExplosionCandidates, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosion Actors Processed"), STAT_ShooterExplosionActors, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosion Actors Damaged"), STAT_ShooterExplosionDamaged, STATGROUP_Shooter);
+
+void UShooterExplosionSubsystem::Deinitialize()
+{
+	UE_LOG(LogRevolution2, Log, TEXT("Explosions: %d resolved, %d candidates, %d actors processed, %d actors damaged, %d capped"), Stats.Explosions, Stats.Candidates, Stats.ActorsProcessed, Stats.ActorsDamaged, Stats.CappedExplosions);
+
+	Damageables.Empty();
+	Cells.Empty();
+	MaxDamageableRadius = 0.0f;
+
+	Super::Deinitialize();
+}
+
+void UShooterExplosionSubsystem::RegisterDamageable(AActor* Actor)
+{
+	if (IsValid(Actor))
+	{
+		Damageables.AddUnique(Actor);
+
+		MaxDamageableRadius = FMath::Max(MaxDamageableRadius, Actor->GetSimpleCollisionRadius());
+
+		// force the hash to rebuild on the next query
+		CellsBuiltFrame = 0;
+	}
+}
+
+void UShooterExplosionSubsystem::UnregisterDamageable(AActor* Actor)
+{
+	if (Damageables.RemoveSwap(Actor) > 0)
+	{
+		CellsBuiltFrame = 0;
+	}
+}
+
+void UShooterExplosionSubsystem::FindExplosionTargets(const FVector& ExplosionCenter, float Radius, const TArray<const AActor*>& IgnoredActors, int32 MaxTargets, bool bUseSpatialHash, TArray<FShooterExplosionTarget>& OutTargets)
+{
+	OutTargets.Reset();
+
+	bool bCapped = false;
+
+	if (bUseSpatialHash)
+	{
+		bCapped = FindTargetsWithSpatialHash(ExplosionCenter, Radius, IgnoredActors, MaxTargets, OutTargets);
+
+	} else {
+
+		bCapped = FindTargetsWithOverlap(ExplosionCenter, Radius, IgnoredActors, MaxTargets, OutTargets);
+
+	}
+
+	++Stats.Explosions;
+	Stats.ActorsProcessed += OutTargets.Num();
+
+	// exactly MaxTargets actors in range isn't capped. Only count explosions that actually dropped someone
+	if (bCapped)
+	{
+		++Stats.CappedExplosions;
+	}
+
+	INC_DWORD_STAT_BY(STAT_ShooterExplosionActors, OutTargets.Num());
+}
+
+void UShooterExplosionSubsystem::RecordDamagedActors(int32 NumDamaged)
+{
+	Stats.ActorsDamaged += NumDamaged;
+
+	INC_DWORD_STAT_BY(STAT_ShooterExplosionDamaged, NumDamaged);
+}
+
+bool UShooterExplosionSubsystem::FindTargetsWithOverlap(const FVector& ExplosionCenter, float Radius, const TArray<const AActor*>& IgnoredActors, int32 MaxTargets, TArray<FShooterExplosionTarget>& OutTargets)
+{
+	// do a sphere overlap check look for nearby actors to damage
+	TArray<FOverlapResult> Overlaps;
+
+	FCollisionShape OverlapShape;
+	OverlapShape.SetSphere(Radius);
+
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+	ObjectParams.AddObjectTypesToQuery(ECC_PhysicsBody);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShooterExplosion));
+	QueryParams.AddIgnoredActors(IgnoredActors);
+
+	RecordShooterSceneQueries();
+
+	GetWorld()->OverlapMultiByObjectType(Overlaps, ExplosionCenter, FQuat::Identity, ObjectParams, OverlapShape, QueryParams);
+
+	Stats.Candidates += Overlaps.Num();
+	INC_DWORD_STAT_BY(STAT_ShooterExplosionCandidates, Overlaps.Num());
+
+	// overlaps may return the same actor multiple times per each component overlapped
+	// ensure we only process each actor once
+	TSet<AActor*, DefaultKeyFuncs<AActor*>, TInlineSetAllocator<32>> SeenActors;
+
+	for (const FOverlapResult& CurrentOverlap : Overlaps)
+	{
+		AActor* OverlapActor = CurrentOverlap.GetActor();
+
+		if (!OverlapActor)
+		{
+			continue;
+		}
+
+		bool bAlreadySeen = false;
+		SeenActors.Add(OverlapActor, &bAlreadySeen);
+
+		if (!bAlreadySeen)
+		{
+			// stop at the first actor past the cap
+			if (OutTargets.Num() >= MaxTargets)
+			{
+				return true;
+			}
+
+			OutTargets.Add({ OverlapActor, CurrentOverlap.GetComponent() });
+		}
+	}
+
+	return false;
+}
+
+bool UShooterExplosionSubsystem::FindTargetsWithSpatialHash(const FVector& ExplosionCenter, float Radius, const TArray<const AActor*>& IgnoredActors, int32 MaxTargets, TArray<FShooterExplosionTarget>& OutTargets)
+{
+	UpdateCells();
+
+	// each damageable lives in a single cell, so we don't need to deduplicate.
+	// Actors are hashed by their center, so widen the range to catch the ones that only overlap the radius with their collision
+	const float QueryRadius = Radius + MaxDamageableRadius;
+	const FIntVector MinCell = GetCell(ExplosionCenter - FVector(QueryRadius));
+	const FIntVector MaxCell = GetCell(ExplosionCenter + FVector(QueryRadius));
+
+	int32 NumCandidates = 0;
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				const TArray<int32, TInlineAllocator<4>>* Cell = Cells.Find(FIntVector(X, Y, Z));
+
+				if (!Cell)
+				{
+					continue;
+				}
+
+				for (const int32 DamageableIndex : *Cell)
+				{
+					AActor* Damageable = Damageables[DamageableIndex].Get();
+
+					if (!IsValid(Damageable) || IgnoredActors.Contains(Damageable))
+					{
+						continue;
+					}
+
+					++NumCandidates;
+
+					// is the actor within the explosion radius?
+					const float MaxDistance = Radius + Damageable->GetSimpleCollisionRadius();
+
+					if (FVector::DistSquared(Damageable->GetActorLocation(), ExplosionCenter) > FMath::Square(MaxDistance))
+					{
+						continue;
+					}
+
+					// push the ragdoll if the character is simulating physics, otherwise the root
+					UPrimitiveComponent* Component = Cast<UPrimitiveComponent>(Damageable->GetRootComponent());
+
+					if (const ACharacter* Character = Cast<ACharacter>(Damageable))
+					{
+						if (Character->GetMesh() && Character->GetMesh()->IsSimulatingPhysics())
+						{
+							Component = Character->GetMesh();
+						}
+					}
+
+					// stop at the first actor in range past the cap
+					if (OutTargets.Num() >= MaxTargets)
+					{
+						Stats.Candidates += NumCandidates;
+						INC_DWORD_STAT_BY(STAT_ShooterExplosionCandidates, NumCandidates);
+						return true;
+					}
+
+					OutTargets.Add({ Damageable, Component });
+				}
+			}
+		}
+	}
+
+	Stats.Candidates += NumCandidates;
+	INC_DWORD_STAT_BY(STAT_ShooterExplosionCandidates, NumCandidates);
+
+	return false;
+}
+
+void UShooterExplosionSubsystem::UpdateCells()
+{
+	if (CellsBuiltFrame == GFrameCounter)
+	{
+		return;
+	}
+
+	CellsBuiltFrame = GFrameCounter;
+	Cells.Reset();
+
+	// drop any actors that were destroyed without unregistering
+	Damageables.RemoveAllSwap([](const TWeakObjectPtr<AActor>& Damageable) { return !Damageable.IsValid(); });
+
+	for (int32 i = 0; i < Damageables.Num(); ++i)
+	{
+		Cells.FindOrAdd(GetCell(Damageables[i]->GetActorLocation())).Add(i);
+	}
+}
+
+FIntVector UShooterExplosionSubsystem::GetCell(const FVector& Location)
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize),
+		FMath::FloorToInt32(Location.Z / CellSize));
+}
@@ -0,0 +1,107 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterExplosionSubsystem.generated.h"
+
+class UPrimitiveComponent;
+
+/**
+ *  An actor affected by an explosion, along with the component that should receive the impulse
+ */
+struct FShooterExplosionTarget
+{
+	/** Actor to damage */
+	AActor* Actor = nullptr;
+
+	/** Component to push */
+	UPrimitiveComponent* Component = nullptr;
+};
+
+/**
+ *  Cumulative explosion counters
+ */
+struct FShooterExplosionStats
+{
+	/** Number of explosions resolved */
+	int32 Explosions = 0;
+
+	/** Number of candidates returned by overlaps or the spatial hash, before deduplication */
+	int32 Candidates = 0;
+
+	/** Number of unique actors processed */
+	int32 ActorsProcessed = 0;
+
+	/** Number of actors that received damage */
+	int32 ActorsDamaged = 0;
+
+	/** Number of explosions that left out targets in range because of the cap */
+	int32 CappedExplosions = 0;
+};
+
+/**
+ *  Resolves which actors are affected by an explosion
+ *  Can either query the physics scene, or a spatial hash of registered damageable actors to skip physics overlaps entirely
+ */
+UCLASS()
+class REVOLUTION2_API UShooterExplosionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Actors registered as damageable for the spatial hash */
+	TArray<TWeakObjectPtr<AActor>> Damageables;
+
+	/** Spatial hash cells, mapping a cell coordinate to indices in the damageables array */
+	TMap<FIntVector, TArray<int32, TInlineAllocator<4>>> Cells;
+
+	/** Frame the spatial hash was last built on. Damageables move, so the hash is rebuilt once per frame on demand */
+	uint64 CellsBuiltFrame = 0;
+
+	/** Largest collision radius of the registered damageables. Actors are hashed by their center, so queries reach this far past the explosion radius */
+	float MaxDamageableRadius = 0.0f;
+
+	/** Size of each spatial hash cell */
+	static constexpr float CellSize = 500.0f;
+
+	/** Cumulative explosion counters */
+	FShooterExplosionStats Stats;
+
+public:
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+	/** Adds an actor to the damageable spatial hash */
+	void RegisterDamageable(AActor* Actor);
+
+	/** Removes an actor from the damageable spatial hash */
+	void UnregisterDamageable(AActor* Actor);
+
+	/**
+	 *  Finds the unique actors within the explosion radius, up to MaxTargets.
+	 *  If bUseSpatialHash is true, only registered damageable actors are considered and the physics scene isn't queried.
+	 */
+	void FindExplosionTargets(const FVector& ExplosionCenter, float Radius, const TArray<const AActor*>& IgnoredActors, int32 MaxTargets, bool bUseSpatialHash, TArray<FShooterExplosionTarget>& OutTargets);
+
+	/** Records how many of an explosion's targets were damaged */
+	void RecordDamagedActors(int32 NumDamaged);
+
+	/** Returns the cumulative explosion counters */
+	const FShooterExplosionStats& GetStats() const { return Stats; }
+
+protected:
+
+	/** Finds candidates through a physics overlap. Returns true if targets in range were left out because of the cap */
+	bool FindTargetsWithOverlap(const FVector& ExplosionCenter, float Radius, const TArray<const AActor*>& IgnoredActors, int32 MaxTargets, TArray<FShooterExplosionTarget>& OutTargets);
+
+	/** Finds candidates through the damageable spatial hash. Returns true if targets in range were left out because of the cap */
+	bool FindTargetsWithSpatialHash(const FVector& ExplosionCenter, float Radius, const TArray<const AActor*>& IgnoredActors, int32 MaxTargets, TArray<FShooterExplosionTarget>& OutTargets);
+
+	/** Rebuilds the spatial hash if it's out of date for this frame */
+	void UpdateCells();
+
+	/** Returns the spatial hash cell containing the location */
+	static FIntVector GetCell(const FVector& Location);
+};
@@ -0,0 +1,115 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterHitboxHistoryComponent.h"
+#include "ShooterLagCompensationSubsystem.h"
+#include "GameFramework/Character.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+
+void FShooterHitboxHistory::Record(float Time, const FVector& Location, float HalfHeight)
+{
+	Times[Head] = Time;
+	Locations[Head] = FVector3f(Location);
+	HalfHeights[Head] = HalfHeight;
+
+	Head = (Head + 1) % MaxSamples;
+	NumSamples = FMath::Min(NumSamples + 1, MaxSamples);
+}
+
+bool FShooterHitboxHistory::Sample(float Time, FVector& OutLocation, float& OutHalfHeight) const
+{
+	if (NumSamples == 0)
+	{
+		return false;
+	}
+
+	// walk back from the newest sample until we find one at or before the requested time
+	int32 Newer = (Head + MaxSamples - 1) % MaxSamples;
+
+	if (Time >= Times[Newer])
+	{
+		OutLocation = FVector(Locations[Newer]);
+		OutHalfHeight = HalfHeights[Newer];
+		return true;
+	}
+
+	for (int32 i = 1; i < NumSamples; ++i)
+	{
+		const int32 Older = (Newer + MaxSamples - 1) % MaxSamples;
+
+		if (Times[Older] <= Time)
+		{
+			// interpolate between the two samples around the requested time
+			const float Alpha = (Time - Times[Older]) / FMath::Max(Times[Newer] - Times[Older], UE_KINDA_SMALL_NUMBER);
+
+			OutLocation = FVector(FMath::Lerp(Locations[Older], Locations[Newer], Alpha));
+			OutHalfHeight = FMath::Lerp(HalfHeights[Older], HalfHeights[Newer], Alpha);
+			return true;
+		}
+
+		Newer = Older;
+	}
+
+	// older than the whole history, so clamp to the oldest sample
+	OutLocation = FVector(Locations[Newer]);
+	OutHalfHeight = HalfHeights[Newer];
+	return true;
+}
+
+UShooterHitboxHistoryComponent::UShooterHitboxHistoryComponent()
+{
+	// samples are recorded by the lag compensation subsystem in a single pass
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UShooterHitboxHistoryComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (const ACharacter* CharacterOwner = Cast<ACharacter>(GetOwner()))
+	{
+		Capsule = CharacterOwner->GetCapsuleComponent();
+	}
+
+	// only the server confirms hits, and standalone games have no latency to compensate for
+	if (Capsule && GetOwnerRole() == ROLE_Authority && GetNetMode() != NM_Standalone)
+	{
+		if (UShooterLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UShooterLagCompensationSubsystem>())
+		{
+			LagCompensation->RegisterHistory(this);
+		}
+	}
+}
+
+void UShooterHitboxHistoryComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	if (UShooterLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UShooterLagCompensationSubsystem>())
+	{
+		LagCompensation->UnregisterHistory(this);
+	}
+}
+
+void UShooterHitboxHistoryComponent::RecordSample(float Time)
+{
+	// dead and pooled pawns can't be hit, so drop their history
+	if (!GetOwner()->GetActorEnableCollision() || !Capsule->IsQueryCollisionEnabled())
+	{
+		History.Reset();
+		return;
+	}
+
+	History.Record(Time, Capsule->GetComponentLocation(), Capsule->GetScaledCapsuleHalfHeight());
+}
+
+bool UShooterHitboxHistoryComponent::GetCapsuleAtTime(float Time, FVector& OutLocation, float& OutHalfHeight) const
+{
+	return History.Sample(Time, OutLocation, OutHalfHeight);
+}
+
+float UShooterHitboxHistoryComponent::GetCapsuleRadius() const
+{
+	return Capsule ? Capsule->GetScaledCapsuleRadius() : 0.0f;
+}
@@ -0,0 +1,84 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ShooterHitboxHistoryComponent.generated.h"
+
+class UCapsuleComponent;
+
+/**
+ *  Fixed size ring buffer of capsule samples
+ *  Stored as separate arrays for each field so rewinding only touches the sample times until it finds the ones it needs
+ */
+struct REVOLUTION2_API FShooterHitboxHistory
+{
+	/** Number of samples kept. About a second of history at 60Hz */
+	static constexpr int32 MaxSamples = 64;
+
+	/** Server time of each sample */
+	TStaticArray<float, MaxSamples> Times;
+
+	/** Capsule center at each sample */
+	TStaticArray<FVector3f, MaxSamples> Locations;
+
+	/** Capsule half height at each sample, so crouching is rewound too */
+	TStaticArray<float, MaxSamples> HalfHeights;
+
+	/** Index the next sample will be written to */
+	int32 Head = 0;
+
+	/** Number of valid samples */
+	int32 NumSamples = 0;
+
+	/** Adds a sample, overwriting the oldest one once the buffer is full */
+	void Record(float Time, const FVector& Location, float HalfHeight);
+
+	/** Interpolates the capsule at the given time. Times outside the history are clamped to the oldest or newest sample. Returns false if there are no samples */
+	bool Sample(float Time, FVector& OutLocation, float& OutHalfHeight) const;
+
+	/** Discards every sample */
+	void Reset() { Head = 0; NumSamples = 0; }
+};
+
+/**
+ *  Records the owner's capsule every server frame so hits can be confirmed against where targets were when the shooter fired
+ *  Memory per pawn is bounded by the fixed history size
+ */
+UCLASS(ClassGroup=(Shooter), meta=(BlueprintSpawnableComponent))
+class REVOLUTION2_API UShooterHitboxHistoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+	/** Recorded capsule samples */
+	FShooterHitboxHistory History;
+
+	/** Owner capsule being recorded */
+	TObjectPtr<UCapsuleComponent> Capsule;
+
+public:
+
+	/** Constructor */
+	UShooterHitboxHistoryComponent();
+
+	/** Records the current capsule state. Clears the history while the owner can't be hit, so it's never rewound into a stale pose */
+	void RecordSample(float Time);
+
+	/** Returns the rewound capsule at the given time. Returns false if there's nothing to rewind */
+	bool GetCapsuleAtTime(float Time, FVector& OutLocation, float& OutHalfHeight) const;
+
+	/** Returns the recorded capsule */
+	UCapsuleComponent* GetCapsule() const { return Capsule; }
+
+	/** Returns the recorded capsule radius */
+	float GetCapsuleRadius() const;
+
+protected:
+
+	/** Registers with the lag compensation subsystem on the server */
+	virtual void BeginPlay() override;
+
+	/** Unregisters from the lag compensation subsystem */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
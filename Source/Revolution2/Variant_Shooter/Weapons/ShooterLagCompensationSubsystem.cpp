@@ -0,0 +1,246 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterLagCompensationSubsystem.h"
+#include "ShooterHitboxHistoryComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Revolution2.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hitbox History Record"), STAT_ShooterHitboxRecord, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Rewind"), STAT_ShooterRewind, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rewound Traces"), STAT_ShooterRewinds, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rewound Hits"), STAT_ShooterRewoundHits, STATGROUP_Shooter);
+
+void UShooterLagCompensationSubsystem::RegisterHistory(UShooterHitboxHistoryComponent* History)
+{
+	if (IsValid(History))
+	{
+		Histories.AddUnique(History);
+	}
+}
+
+void UShooterLagCompensationSubsystem::UnregisterHistory(UShooterHitboxHistoryComponent* History)
+{
+	Histories.RemoveSwap(History, EAllowShrinking::No);
+}
+
+void UShooterLagCompensationSubsystem::GetTrackedActors(TArray<AActor*>& OutActors) const
+{
+	for (const UShooterHitboxHistoryComponent* History : Histories)
+	{
+		OutActors.Add(History->GetOwner());
+	}
+}
+
+bool UShooterLagCompensationSubsystem::RewindTrace(const FVector& Start, const FVector& End, float Time, const AActor* IgnoredActor, FHitResult& OutHit)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterRewind);
+
+	++NumRewinds;
+	INC_DWORD_STAT(STAT_ShooterRewinds);
+
+	// never rewind further than the history is meant to cover
+	const float RewindTime = FMath::Max(Time, GetWorld()->GetTimeSeconds() - MaxRewindTime);
+
+	UShooterHitboxHistoryComponent* NearestHistory = nullptr;
+	float NearestHitTime = 1.0f;
+
+	for (UShooterHitboxHistoryComponent* History : Histories)
+	{
+		if (History->GetOwner() == IgnoredActor)
+		{
+			continue;
+		}
+
+		FVector CapsuleCenter;
+		float HalfHeight;
+
+		if (!History->GetCapsuleAtTime(RewindTime, CapsuleCenter, HalfHeight))
+		{
+			continue;
+		}
+
+		float HitTime;
+
+		if (IntersectCapsule(Start, End, CapsuleCenter, HalfHeight, History->GetCapsuleRadius(), HitTime) && HitTime < NearestHitTime)
+		{
+			NearestHitTime = HitTime;
+			NearestHistory = History;
+		}
+	}
+
+	if (!NearestHistory)
+	{
+		return false;
+	}
+
+	++NumRewoundHits;
+	INC_DWORD_STAT(STAT_ShooterRewoundHits);
+
+	// build a blocking hit on the target's capsule at the rewound impact point
+	const FVector ShotDir = (End - Start).GetSafeNormal();
+	const FVector ImpactPoint = FMath::Lerp(Start, End, NearestHitTime);
+
+	OutHit = FHitResult(NearestHistory->GetOwner(), NearestHistory->GetCapsule(), ImpactPoint, -ShotDir);
+	OutHit.TraceStart = Start;
+	OutHit.TraceEnd = End;
+	OutHit.Time = NearestHitTime;
+	OutHit.Distance = FVector::Dist(Start, ImpactPoint);
+	OutHit.bBlockingHit = true;
+
+	return true;
+}
+
+bool UShooterLagCompensationSubsystem::IntersectCapsule(const FVector& Start, const FVector& End, const FVector& CapsuleCenter, float HalfHeight, float Radius, float& OutHitTime)
+{
+	// find the closest points between the shot and the capsule's inner segment
+	const FVector AxisOffset(0.0f, 0.0f, FMath::Max(HalfHeight - Radius, 0.0f));
+
+	FVector CapsulePoint;
+	FVector ShotPoint;
+	FMath::SegmentDistToSegmentSafe(CapsuleCenter - AxisOffset, CapsuleCenter + AxisOffset, Start, End, CapsulePoint, ShotPoint);
+
+	if (FVector::DistSquared(CapsulePoint, ShotPoint) > FMath::Square(Radius))
+	{
+		return false;
+	}
+
+	// approximate the entry point with the sphere around the closest capsule point
+	const FVector Delta = End - Start;
+	const double Length = Delta.Size();
+
+	if (Length <= UE_KINDA_SMALL_NUMBER)
+	{
+		OutHitTime = 0.0f;
+		return true;
+	}
+
+	const FVector Dir = Delta / Length;
+	const FVector ToStart = Start - CapsulePoint;
+	const double B = FVector::DotProduct(ToStart, Dir);
+	const double C = ToStart.SizeSquared() - FMath::Square(Radius);
+	const double Discriminant = FMath::Max(B * B - C, 0.0);
+
+	OutHitTime = static_cast<float>(FMath::Clamp((-B - FMath::Sqrt(Discriminant)) / Length, 0.0, 1.0));
+	return true;
+}
+
+void UShooterLagCompensationSubsystem::Deinitialize()
+{
+	if (NumRewinds > 0)
+	{
+		UE_LOG(LogRevolution2, Log, TEXT("Lag compensation: %d rewound traces, %d confirmed hits"), NumRewinds, NumRewoundHits);
+	}
+
+	Histories.Empty();
+
+	Super::Deinitialize();
+}
+
+void UShooterLagCompensationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterHitboxRecord);
+
+	// on the server, world time is the server world time the clients estimate
+	const float Time = GetWorld()->GetTimeSeconds();
+
+	for (UShooterHitboxHistoryComponent* History : Histories)
+	{
+		History->RecordSample(Time);
+	}
+}
+
+bool UShooterLagCompensationSubsystem::IsTickable() const
+{
+	return Histories.Num() > 0;
+}
+
+TStatId UShooterLagCompensationSubsystem::GetStatId() const
+{
+	return GET_STATID(STAT_ShooterHitboxRecord);
+}
+
+/** Times recording and rewinding synthetic hitbox histories for a number of pawns */
+static FAutoConsoleCommand ShooterLagCompensationBenchmarkCommand(
+	TEXT("Shooter.LagCompensation.Benchmark"),
+	TEXT("Times hitbox history recording and rewound shot traces against synthetic pawns. Usage: Shooter.LagCompensation.Benchmark [Pawns=64] [Shots=10000]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumPawns = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 64;
+		const int32 NumShots = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 10000;
+
+		constexpr float FrameTime = 1.0f / 60.0f;
+		constexpr float Radius = 34.0f;
+		constexpr float HalfHeight = 88.0f;
+
+		FRandomStream Random(1234);
+
+		// fill every history with pawns wandering around a 100m square
+		TArray<FShooterHitboxHistory> Histories;
+		Histories.SetNum(NumPawns);
+
+		TArray<FVector> Locations;
+		Locations.SetNum(NumPawns);
+
+		for (FVector& Location : Locations)
+		{
+			Location = FVector(Random.FRandRange(-5000.0f, 5000.0f), Random.FRandRange(-5000.0f, 5000.0f), HalfHeight);
+		}
+
+		const double RecordStart = FPlatformTime::Seconds();
+
+		for (int32 Frame = 0; Frame < FShooterHitboxHistory::MaxSamples; ++Frame)
+		{
+			for (int32 i = 0; i < NumPawns; ++i)
+			{
+				Locations[i] += FVector(Random.FRandRange(-10.0f, 10.0f), Random.FRandRange(-10.0f, 10.0f), 0.0f);
+				Histories[i].Record(Frame * FrameTime, Locations[i], HalfHeight);
+			}
+		}
+
+		const double RecordTime = FPlatformTime::Seconds() - RecordStart;
+
+		// fire shots from random points at random pawns, rewound to random times within the history
+		const float HistoryLength = (FShooterHitboxHistory::MaxSamples - 1) * FrameTime;
+
+		int32 NumHits = 0;
+
+		const double RewindStart = FPlatformTime::Seconds();
+
+		for (int32 Shot = 0; Shot < NumShots; ++Shot)
+		{
+			const FVector Start(Random.FRandRange(-5000.0f, 5000.0f), Random.FRandRange(-5000.0f, 5000.0f), HalfHeight);
+			const FVector End = Start + (Locations[Random.RandHelper(NumPawns)] - Start).GetSafeNormal() * 10000.0f;
+			const float Time = Random.FRandRange(0.0f, HistoryLength);
+
+			float NearestHitTime = 1.0f;
+			bool bHit = false;
+
+			for (const FShooterHitboxHistory& History : Histories)
+			{
+				FVector CapsuleCenter;
+				float CapsuleHalfHeight;
+				float HitTime;
+
+				if (History.Sample(Time, CapsuleCenter, CapsuleHalfHeight)
+					&& UShooterLagCompensationSubsystem::IntersectCapsule(Start, End, CapsuleCenter, CapsuleHalfHeight, Radius, HitTime)
+					&& HitTime < NearestHitTime)
+				{
+					NearestHitTime = HitTime;
+					bHit = true;
+				}
+			}
+
+			NumHits += bHit ? 1 : 0;
+		}
+
+		const double RewindTime = FPlatformTime::Seconds() - RewindStart;
+
+		UE_LOG(LogRevolution2, Display, TEXT("Lag compensation benchmark: %d pawns, %d samples each (%d bytes per pawn). Record: %.3f us/frame. Rewind: %.3f us/shot, %d/%d shots hit"),
+			NumPawns, FShooterHitboxHistory::MaxSamples, static_cast<int32>(sizeof(FShooterHitboxHistory)),
+			RecordTime * 1000000.0 / FShooterHitboxHistory::MaxSamples, RewindTime * 1000000.0 / NumShots, NumHits, NumShots);
+	}));
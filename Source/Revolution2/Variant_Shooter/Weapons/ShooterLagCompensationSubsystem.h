@@ -0,0 +1,61 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterLagCompensationSubsystem.generated.h"
+
+class UShooterHitboxHistoryComponent;
+
+/**
+ *  Server side lag compensation for shots fired by remote clients
+ *  Records every registered hitbox history once per server frame, and traces shots against the capsules rewound to the time the shooter fired at
+ */
+UCLASS()
+class REVOLUTION2_API UShooterLagCompensationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Registered hitbox histories */
+	UPROPERTY()
+	TArray<TObjectPtr<UShooterHitboxHistoryComponent>> Histories;
+
+	/** Number of rewound traces */
+	int32 NumRewinds = 0;
+
+	/** Number of rewound traces that confirmed a hit */
+	int32 NumRewoundHits = 0;
+
+public:
+
+	/** Max time shots can be rewound by. Older shots are traced against the oldest sample */
+	static constexpr float MaxRewindTime = 0.5f;
+
+	/** Adds a hitbox history to be recorded every frame */
+	void RegisterHistory(UShooterHitboxHistoryComponent* History);
+
+	/** Removes a hitbox history */
+	void UnregisterHistory(UShooterHitboxHistoryComponent* History);
+
+	/** Adds the owners of every registered history to the list, so world traces can skip their current capsules */
+	void GetTrackedActors(TArray<AActor*>& OutActors) const;
+
+	/**
+	 *  Traces a segment against every registered capsule rewound to the given server time.
+	 *  Returns true and fills the hit result with the nearest rewound capsule hit, ignoring the given actor.
+	 */
+	bool RewindTrace(const FVector& Start, const FVector& End, float Time, const AActor* IgnoredActor, FHitResult& OutHit);
+
+	/** Tests a segment against a vertical capsule. Returns true and the hit time along the segment if they intersect */
+	static bool IntersectCapsule(const FVector& Start, const FVector& End, const FVector& CapsuleCenter, float HalfHeight, float Radius, float& OutHitTime);
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+	//~Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~End FTickableGameObject interface
+};
@@ -0,0 +1,138 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterNoiseSubsystem.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "Revolution2.h"
+
+DECLARE_CYCLE_STAT(TEXT("Noise Aggregation"), STAT_ShooterNoise, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Noise Events Reported"), STAT_ShooterNoiseRaw, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Noise Events Emitted"), STAT_ShooterNoiseEmitted, STATGROUP_Shooter);
+
+void UShooterNoiseSubsystem::MakeNoise(AActor* NoiseMaker, float Loudness, APawn* NoiseInstigator, const FVector& NoiseLocation, float MaxRange, FName Tag)
+{
+	if (!NoiseMaker)
+	{
+		return;
+	}
+
+	if (UShooterNoiseSubsystem* NoiseSubsystem = NoiseMaker->GetWorld()->GetSubsystem<UShooterNoiseSubsystem>())
+	{
+		NoiseSubsystem->ReportNoise(NoiseMaker, Loudness, NoiseInstigator, NoiseLocation, MaxRange, Tag);
+
+	} else {
+
+		NoiseMaker->MakeNoise(Loudness, NoiseInstigator, NoiseLocation, MaxRange, Tag);
+	}
+}
+
+void UShooterNoiseSubsystem::ReportNoise(AActor* NoiseMaker, float Loudness, APawn* NoiseInstigator, const FVector& NoiseLocation, float MaxRange, FName Tag)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterNoise);
+
+	++NumRawEvents;
+	INC_DWORD_STAT(STAT_ShooterNoiseRaw);
+
+	// try to merge into an open window from the same instigator
+	for (FShooterNoiseWindow& Window : Windows)
+	{
+		if (Window.NoiseInstigator == NoiseInstigator && Window.Tag == Tag && FVector::DistSquared(Window.Location, NoiseLocation) <= FMath::Square(MergeRadius))
+		{
+			Window.NoiseMaker = NoiseMaker;
+			Window.MergedLoudness += Loudness;
+			Window.MaxRange = FMath::Max(Window.MaxRange, MaxRange);
+			++Window.NumMerged;
+
+			// the merged noise comes from the loudest event
+			if (Loudness > Window.PeakLoudness)
+			{
+				Window.PeakLoudness = Loudness;
+				Window.Location = NoiseLocation;
+			}
+
+			return;
+		}
+	}
+
+	// nothing to merge with, so report this noise right away and open a window for the ones that follow
+	EmitNoise(NoiseMaker, Loudness, NoiseInstigator, NoiseLocation, MaxRange, Tag);
+
+	FShooterNoiseWindow& Window = Windows.AddDefaulted_GetRef();
+	Window.NoiseMaker = NoiseMaker;
+	Window.NoiseInstigator = NoiseInstigator;
+	Window.Tag = Tag;
+	Window.Location = NoiseLocation;
+	Window.PeakLoudness = Loudness;
+	Window.MaxRange = MaxRange;
+	Window.OpenTime = GetWorld()->GetTimeSeconds();
+}
+
+void UShooterNoiseSubsystem::Deinitialize()
+{
+	if (NumRawEvents > 0)
+	{
+		UE_LOG(LogRevolution2, Log, TEXT("Noise: %d events reported, %d passed to AI perception, %d collapsed"), NumRawEvents, NumEmittedEvents, GetNumCollapsedEvents());
+	}
+
+	Windows.Empty();
+
+	Super::Deinitialize();
+}
+
+void UShooterNoiseSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterNoise);
+
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+
+	for (int32 i = Windows.Num() - 1; i >= 0; --i)
+	{
+		if (CurrentTime - Windows[i].OpenTime >= WindowTime)
+		{
+			CloseWindow(Windows[i]);
+			Windows.RemoveAtSwap(i, EAllowShrinking::No);
+		}
+	}
+}
+
+bool UShooterNoiseSubsystem::IsTickable() const
+{
+	return Windows.Num() > 0;
+}
+
+TStatId UShooterNoiseSubsystem::GetStatId() const
+{
+	return GET_STATID(STAT_ShooterNoise);
+}
+
+void UShooterNoiseSubsystem::EmitNoise(AActor* NoiseMaker, float Loudness, APawn* NoiseInstigator, const FVector& NoiseLocation, float MaxRange, FName Tag)
+{
+	++NumEmittedEvents;
+	INC_DWORD_STAT(STAT_ShooterNoiseEmitted);
+
+	NoiseMaker->MakeNoise(Loudness, NoiseInstigator, NoiseLocation, MaxRange, Tag);
+}
+
+void UShooterNoiseSubsystem::CloseWindow(const FShooterNoiseWindow& Window)
+{
+	if (Window.NumMerged == 0)
+	{
+		return;
+	}
+
+	// pooled projectiles may have been reused by now, so fall back to the instigator
+	AActor* NoiseMaker = Window.NoiseMaker.IsValid() ? Window.NoiseMaker.Get() : Window.NoiseInstigator.Get();
+
+	if (!NoiseMaker)
+	{
+		return;
+	}
+
+	// the merged events become a single noise, louder than any one of them but capped
+	const float Loudness = FMath::Min(Window.MergedLoudness, Window.PeakLoudness * MaxLoudnessScale);
+
+	EmitNoise(NoiseMaker, Loudness, Window.NoiseInstigator.Get(), Window.Location, Window.MaxRange, Window.Tag);
+}
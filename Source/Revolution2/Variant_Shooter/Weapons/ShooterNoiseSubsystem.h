@@ -0,0 +1,98 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterNoiseSubsystem.generated.h"
+
+/**
+ *  Noise events from the same instigator merged within a short time window
+ */
+struct FShooterNoiseWindow
+{
+	/** Actor that made the last merged noise */
+	TWeakObjectPtr<AActor> NoiseMaker;
+
+	/** Pawn responsible for the noise */
+	TWeakObjectPtr<APawn> NoiseInstigator;
+
+	/** Noise tag shared by every merged event */
+	FName Tag;
+
+	/** Location of the loudest merged event */
+	FVector Location = FVector::ZeroVector;
+
+	/** Loudness of the loudest merged event */
+	float PeakLoudness = 0.0f;
+
+	/** Summed loudness of the events merged since the window opened */
+	float MergedLoudness = 0.0f;
+
+	/** Max range of the merged events */
+	float MaxRange = 0.0f;
+
+	/** Number of events merged since the window opened, not counting the one that opened it */
+	int32 NumMerged = 0;
+
+	/** Time the window opened */
+	double OpenTime = 0.0;
+};
+
+/**
+ *  Merges AI perception noise from weapons and projectiles
+ *  The first noise from an instigator is reported right away and opens a window.
+ *  Noises with the same instigator and tag close to it within the window are merged into a single louder noise reported when the window closes,
+ *  so sustained fire doesn't flood the hearing sense with near duplicate events
+ */
+UCLASS()
+class REVOLUTION2_API UShooterNoiseSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Open noise windows */
+	TArray<FShooterNoiseWindow> Windows;
+
+	/** Number of noise events reported by gameplay code */
+	int32 NumRawEvents = 0;
+
+	/** Number of noise events passed on to AI perception */
+	int32 NumEmittedEvents = 0;
+
+public:
+
+	/** Time noises are merged for after the first one */
+	static constexpr float WindowTime = 0.25f;
+
+	/** Max distance between noises to merge them */
+	static constexpr float MergeRadius = 500.0f;
+
+	/** Cap for merged loudness, as a multiple of the loudest merged noise */
+	static constexpr float MaxLoudnessScale = 2.0f;
+
+	/** Reports a noise through the world's noise subsystem, or straight to AI perception if there isn't one */
+	static void MakeNoise(AActor* NoiseMaker, float Loudness, APawn* NoiseInstigator, const FVector& NoiseLocation, float MaxRange, FName Tag);
+
+	/** Merges the noise into an open window, or reports it and opens a new one */
+	void ReportNoise(AActor* NoiseMaker, float Loudness, APawn* NoiseInstigator, const FVector& NoiseLocation, float MaxRange, FName Tag);
+
+	/** Returns the number of raw noise events collapsed into merged ones */
+	int32 GetNumCollapsedEvents() const { return NumRawEvents - NumEmittedEvents; }
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+	//~Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~End FTickableGameObject interface
+
+protected:
+
+	/** Passes a noise on to AI perception */
+	void EmitNoise(AActor* NoiseMaker, float Loudness, APawn* NoiseInstigator, const FVector& NoiseLocation, float MaxRange, FName Tag);
+
+	/** Reports the merged noise for a window, if it merged anything */
+	void CloseWindow(const FShooterNoiseWindow& Window);
+};
@@ -7,8 +7,11 @@
 #include "Components/StaticMeshComponent.h"
 #include "ShooterWeaponHolder.h"
 #include "ShooterWeapon.h"
+#include "ShooterWeaponNetComponent.h"
+#include "ShooterPickupStreamingSubsystem.h"
 #include "Engine/World.h"
 #include "TimerManager.h"
+#include "Net/UnrealNetwork.h"
 
 AShooterPickup::AShooterPickup()
 {
@@ -36,12 +39,22 @@ AShooterPickup::AShooterPickup()
 	Mesh->SetupAttachment(SphereCollision);
 
 	Mesh->SetCollisionProfileName(FName("NoCollision"));
+
+	// pickups only replicate when they're collected or respawn. Clients already have the placed pickup from the level
+	bReplicates = true;
+	NetDormancy = DORM_Initial;
 }
 
 void AShooterPickup::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
 
+	// in game worlds, the mesh is loaded on BeginPlay
+	if (GetWorld() && GetWorld()->IsGameWorld())
+	{
+		return;
+	}
+
 	if (FWeaponTableRow* WeaponData = WeaponType.GetRow<FWeaponTableRow>(FString()))
 	{
 		// set the mesh
@@ -53,10 +66,44 @@ void AShooterPickup::BeginPlay()
 {
 	Super::BeginPlay();
 
-	if (FWeaponTableRow* WeaponData = WeaponType.GetRow<FWeaponTableRow>(FString()))
+	FWeaponTableRow* WeaponData = WeaponType.GetRow<FWeaponTableRow>(FString());
+
+	if (!WeaponData)
 	{
-		// copy the weapon class
-		WeaponClass = WeaponData->WeaponToSpawn;
+		return;
+	}
+
+	// are the assets already in memory?
+	if ((WeaponData->StaticMesh.IsNull() || WeaponData->StaticMesh.IsValid()) && (WeaponData->WeaponToSpawn.IsNull() || WeaponData->WeaponToSpawn.IsValid()))
+	{
+		ApplyWeaponData();
+		return;
+	}
+
+	UShooterPickupStreamingSubsystem* StreamingSubsystem = GetWorld()->GetSubsystem<UShooterPickupStreamingSubsystem>();
+
+	if (bStreamAssetsAsync && StreamingSubsystem)
+	{
+		// show the placeholder until the assets arrive
+		Mesh->SetStaticMesh(PlaceholderMesh);
+
+		// queue the assets. Every pickup requesting this frame shares the same streaming request
+		StreamingSubsystem->RequestPickupAssets(this, { WeaponData->StaticMesh.ToSoftObjectPath(), WeaponData->WeaponToSpawn.ToSoftObjectPath() });
+
+	} else {
+
+		// load the assets right away and measure how long we blocked for
+		const double LoadStartTime = FPlatformTime::Seconds();
+
+		WeaponData->StaticMesh.LoadSynchronous();
+		WeaponData->WeaponToSpawn.LoadSynchronous();
+
+		if (StreamingSubsystem)
+		{
+			StreamingSubsystem->RecordSyncLoad(FPlatformTime::Seconds() - LoadStartTime);
+		}
+
+		ApplyWeaponData();
 	}
 }
 
@@ -68,21 +115,41 @@ void AShooterPickup::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	GetWorld()->GetTimerManager().ClearTimer(RespawnTimer);
 }
 
+void AShooterPickup::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AShooterPickup, bIsAvailable);
+}
+
 void AShooterPickup::OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
+	// ignore overlaps until the weapon class has streamed in
+	if (!WeaponClass)
+	{
+		return;
+	}
+
+	// only the server decides when the pickup is collected
+	if (!HasAuthority() || !bIsAvailable)
+	{
+		return;
+	}
+
 	// have we collided against a weapon holder?
 	if (IShooterWeaponHolder* WeaponHolder = Cast<IShooterWeaponHolder>(OtherActor))
 	{
-		WeaponHolder->AddWeaponClass(WeaponClass);
+		// replicate the weapon to the owner's clients when possible
+		if (UShooterWeaponNetComponent* WeaponNet = OtherActor->FindComponentByClass<UShooterWeaponNetComponent>())
+		{
+			WeaponNet->GrantWeaponClass(WeaponClass);
 
-		// hide this mesh
-		SetActorHiddenInGame(true);
+		} else {
 
-		// disable collision
-		SetActorEnableCollision(false);
+			WeaponHolder->AddWeaponClass(WeaponClass);
+		}
 
-		// disable ticking
-		SetActorTickEnabled(false);
+		SetAvailable(false);
 
 		// schedule the respawn
 		GetWorld()->GetTimerManager().SetTimer(RespawnTimer, this, &AShooterPickup::RespawnPickup, RespawnTime, false);
@@ -91,11 +158,41 @@ void AShooterPickup::OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor*
 
 void AShooterPickup::RespawnPickup()
 {
-	// unhide this pickup
-	SetActorHiddenInGame(false);
+	SetAvailable(true);
+}
+
+void AShooterPickup::SetAvailable(bool bAvailable)
+{
+	// replicate the change once, then go back to sleep
+	FlushNetDormancy();
+
+	bIsAvailable = bAvailable;
+
+	// the server doesn't get rep notifies
+	OnRep_IsAvailable();
+}
+
+void AShooterPickup::OnRep_IsAvailable()
+{
+	if (bIsAvailable)
+	{
+		// unhide this pickup
+		SetActorHiddenInGame(false);
+
+		// call the BP handler
+		BP_OnRespawn();
+
+	} else {
 
-	// call the BP handler
-	BP_OnRespawn();
+		// hide this mesh
+		SetActorHiddenInGame(true);
+
+		// disable collision
+		SetActorEnableCollision(false);
+
+		// disable ticking
+		SetActorTickEnabled(false);
+	}
 }
 
 void AShooterPickup::FinishRespawn()
@@ -106,3 +203,41 @@ void AShooterPickup::FinishRespawn()
 	// enable tick
 	SetActorTickEnabled(true);
 }
+
+void AShooterPickup::ApplyWeaponData()
+{
+	if (FWeaponTableRow* WeaponData = WeaponType.GetRow<FWeaponTableRow>(FString()))
+	{
+		// set the mesh
+		if (UStaticMesh* LoadedMesh = WeaponData->StaticMesh.Get())
+		{
+			Mesh->SetStaticMesh(LoadedMesh);
+		}
+
+		// copy the weapon class
+		WeaponClass = WeaponData->WeaponToSpawn.Get();
+	}
+}
+
+void AShooterPickup::OnPickupAssetsLoaded()
+{
+	ApplyWeaponData();
+
+	if (!WeaponClass || !bIsAvailable)
+	{
+		return;
+	}
+
+	// overlaps that began while streaming were ignored, so give the weapon to anyone already standing on the pickup
+	TArray<AActor*> OverlappingActors;
+	SphereCollision->GetOverlappingActors(OverlappingActors);
+
+	for (AActor* OverlappingActor : OverlappingActors)
+	{
+		if (Cast<IShooterWeaponHolder>(OverlappingActor))
+		{
+			OnOverlap(SphereCollision, OverlappingActor, nullptr, INDEX_NONE, false, FHitResult());
+			break;
+		}
+	}
+}
\ No newline at end of file
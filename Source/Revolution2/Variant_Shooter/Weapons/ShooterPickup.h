@@ -24,9 +24,9 @@ struct FWeaponTableRow : public FTableRowBase
 	UPROPERTY(EditAnywhere)
 	TSoftObjectPtr<UStaticMesh> StaticMesh;
 
-	/** Weapon class to grant on pickup */
+	/** Weapon class to grant on pickup. Soft so it can be streamed in along with the mesh */
 	UPROPERTY(EditAnywhere)
-	TSubclassOf<AShooterWeapon> WeaponToSpawn;
+	TSoftClassPtr<AShooterWeapon> WeaponToSpawn;
 };
 
 /**
@@ -54,6 +54,14 @@ protected:
 	/** Type to weapon to grant on pickup. Set from the weapon data table. */
 	TSubclassOf<AShooterWeapon> WeaponClass;
 	
+	/** If true, the pickup mesh and weapon class are streamed in asynchronously at level start. Otherwise they're loaded synchronously */
+	UPROPERTY(EditAnywhere, Category="Pickup|Streaming")
+	bool bStreamAssetsAsync = true;
+
+	/** Mesh displayed while the pickup assets are streaming in */
+	UPROPERTY(EditAnywhere, Category="Pickup|Streaming")
+	TObjectPtr<UStaticMesh> PlaceholderMesh;
+
 	/** Time to wait before respawning this pickup */
 	UPROPERTY(EditAnywhere, Category="Pickup", meta = (ClampMin = 0, ClampMax = 120, Units = "s"))
 	float RespawnTime = 4.0f;
@@ -61,6 +69,10 @@ protected:
 	/** Timer to respawn the pickup */
 	FTimerHandle RespawnTimer;
 
+	/** If true, the pickup can be collected. Owned by the server, which wakes the pickup from dormancy only when this changes */
+	UPROPERTY(ReplicatedUsing=OnRep_IsAvailable)
+	bool bIsAvailable = true;
+
 public:	
 	
 	/** Constructor */
@@ -77,6 +89,9 @@ protected:
 	/** Gameplay cleanup */
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+	/** Sets up replicated properties */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	/** Handles collision overlap */
 	UFUNCTION()
 	virtual void OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
@@ -86,6 +101,13 @@ protected:
 	/** Called when it's time to respawn this pickup */
 	void RespawnPickup();
 
+	/** Sets whether the pickup can be collected and replicates it to clients */
+	void SetAvailable(bool bAvailable);
+
+	/** Updates the pickup visuals and collision for its availability */
+	UFUNCTION()
+	void OnRep_IsAvailable();
+
 	/** Passes control to Blueprint to animate the pickup respawn. Should end by calling FinishRespawn */
 	UFUNCTION(BlueprintImplementableEvent, Category="Pickup", meta = (DisplayName = "OnRespawn"))
 	void BP_OnRespawn();
@@ -93,4 +115,12 @@ protected:
 	/** Enables this pickup after respawning */
 	UFUNCTION(BlueprintCallable, Category="Pickup")
 	void FinishRespawn();
+
+	/** Copies the mesh and weapon class from the weapon data table row, if they're loaded */
+	void ApplyWeaponData();
+
+public:
+
+	/** Called by the streaming subsystem when this pickup's assets have been loaded */
+	void OnPickupAssetsLoaded();
 };
@@ -0,0 +1,110 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterPickupStreamingSubsystem.h"
+#include "ShooterPickup.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "Revolution2.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pickup Streaming Request"), STAT_ShooterPickupStreamingRequest, STATGROUP_Shooter);
+
+void UShooterPickupStreamingSubsystem::Deinitialize()
+{
+	if (NumSyncLoads > 0)
+	{
+		UE_LOG(LogRevolution2, Log, TEXT("Pickup streaming: %d synchronous loads blocked the game thread for %.2f ms"), NumSyncLoads, SyncLoadSeconds * 1000.0);
+	}
+
+	// release the loaded assets
+	for (const TSharedPtr<FStreamableHandle>& Handle : LoadHandles)
+	{
+		if (Handle.IsValid())
+		{
+			Handle->CancelHandle();
+		}
+	}
+
+	LoadHandles.Empty();
+	PendingPickups.Empty();
+	PendingAssets.Empty();
+
+	Super::Deinitialize();
+}
+
+void UShooterPickupStreamingSubsystem::RequestPickupAssets(AShooterPickup* Pickup, const TArray<FSoftObjectPath>& Assets)
+{
+	PendingPickups.Add(Pickup);
+
+	for (const FSoftObjectPath& Asset : Assets)
+	{
+		if (!Asset.IsNull())
+		{
+			PendingAssets.AddUnique(Asset);
+		}
+	}
+
+	// gather every request made this frame into a single batch
+	if (!FlushTimer.IsValid())
+	{
+		FlushTimer = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UShooterPickupStreamingSubsystem::FlushPendingRequests);
+	}
+}
+
+void UShooterPickupStreamingSubsystem::RecordSyncLoad(double Seconds)
+{
+	SyncLoadSeconds += Seconds;
+	++NumSyncLoads;
+}
+
+void UShooterPickupStreamingSubsystem::FlushPendingRequests()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterPickupStreamingRequest);
+
+	FlushTimer.Invalidate();
+
+	if (PendingPickups.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<TWeakObjectPtr<AShooterPickup>> Pickups = MoveTemp(PendingPickups);
+	TArray<FSoftObjectPath> Assets = MoveTemp(PendingAssets);
+
+	PendingPickups.Reset();
+	PendingAssets.Reset();
+
+	const int32 NumAssets = Assets.Num();
+	const double RequestTime = FPlatformTime::Seconds();
+
+	// request every asset in one go
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(Assets),
+		FStreamableDelegate::CreateUObject(this, &UShooterPickupStreamingSubsystem::OnBatchLoaded, Pickups, NumAssets, RequestTime));
+
+	if (Handle.IsValid())
+	{
+		LoadHandles.Add(Handle);
+
+	} else {
+
+		// nothing to load, so notify the pickups right away
+		OnBatchLoaded(Pickups, NumAssets, RequestTime);
+	}
+
+	UE_LOG(LogRevolution2, Log, TEXT("Pickup streaming: requested %d assets for %d pickups, game thread blocked for %.2f ms"), NumAssets, Pickups.Num(), (FPlatformTime::Seconds() - RequestTime) * 1000.0);
+}
+
+void UShooterPickupStreamingSubsystem::OnBatchLoaded(TArray<TWeakObjectPtr<AShooterPickup>> Pickups, int32 NumAssets, double RequestTime)
+{
+	UE_LOG(LogRevolution2, Log, TEXT("Pickup streaming: %d assets arrived after %.2f ms"), NumAssets, (FPlatformTime::Seconds() - RequestTime) * 1000.0);
+
+	for (const TWeakObjectPtr<AShooterPickup>& Pickup : Pickups)
+	{
+		if (Pickup.IsValid())
+		{
+			Pickup->OnPickupAssetsLoaded();
+		}
+	}
+}
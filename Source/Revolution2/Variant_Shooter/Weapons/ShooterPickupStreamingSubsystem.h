@@ -0,0 +1,58 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/TimerHandle.h"
+#include "ShooterPickupStreamingSubsystem.generated.h"
+
+class AShooterPickup;
+struct FStreamableHandle;
+
+/**
+ *  Streams the assets for weapon pickups
+ *  Requests made during the same frame are batched into a single async load, so a level full of pickups only issues one streaming request at start
+ */
+UCLASS()
+class REVOLUTION2_API UShooterPickupStreamingSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Pickups waiting for the next batch */
+	TArray<TWeakObjectPtr<AShooterPickup>> PendingPickups;
+
+	/** Assets requested for the next batch */
+	TArray<FSoftObjectPath> PendingAssets;
+
+	/** Handles for the batches loaded so far. Keeps the assets loaded while the world is alive */
+	TArray<TSharedPtr<FStreamableHandle>> LoadHandles;
+
+	/** Timer to flush the pending batch on the next tick */
+	FTimerHandle FlushTimer;
+
+	/** Total time the game thread was blocked by synchronous pickup loads */
+	double SyncLoadSeconds = 0.0;
+
+	/** Number of synchronous pickup loads */
+	int32 NumSyncLoads = 0;
+
+public:
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+	/** Queues the assets for the pickup. The pickup is notified through OnPickupAssetsLoaded once the batch completes */
+	void RequestPickupAssets(AShooterPickup* Pickup, const TArray<FSoftObjectPath>& Assets);
+
+	/** Records the time spent on a synchronous pickup load, so it can be compared against the async path */
+	void RecordSyncLoad(double Seconds);
+
+protected:
+
+	/** Issues a single async load for every pending request */
+	void FlushPendingRequests();
+
+	/** Called when a batch finishes loading */
+	void OnBatchLoaded(TArray<TWeakObjectPtr<AShooterPickup>> Pickups, int32 NumAssets, double RequestTime);
+};
@@ -9,9 +9,11 @@
 #include "GameFramework/DamageType.h"
 #include "GameFramework/Pawn.h"
 #include "GameFramework/Controller.h"
-#include "Engine/OverlapResult.h"
 #include "Engine/World.h"
 #include "TimerManager.h"
+#include "ShooterProjectilePool.h"
+#include "ShooterExplosionSubsystem.h"
+#include "ShooterNoiseSubsystem.h"
 
 AShooterProjectile::AShooterProjectile()
 {
@@ -34,11 +36,17 @@ AShooterProjectile::AShooterProjectile()
 
 	// set the default damage type
 	HitDamageType = UDamageType::StaticClass();
+
+	// projectiles are simulated locally from replicated shots, never replicated themselves
+	bReplicates = false;
 }
 
 void AShooterProjectile::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// save the collision state so we can restore it if the projectile is reused
+	DefaultCollisionEnabled = CollisionComponent->GetCollisionEnabled();
 	
 	// ignore the pawn that shot this projectile
 	CollisionComponent->IgnoreActorWhenMoving(GetInstigator(), true);
@@ -53,6 +61,11 @@ void AShooterProjectile::EndPlay(EEndPlayReason::Type EndPlayReason)
 }
 
 void AShooterProjectile::NotifyHit(class UPrimitiveComponent* MyComp, AActor* Other, class UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit)
+{
+	ResolveHit(Other, OtherComp, Hit);
+}
+
+void AShooterProjectile::ResolveHit(AActor* Other, UPrimitiveComponent* OtherComp, const FHitResult& Hit)
 {
 	// ignore if we've already hit something else
 	if (bHit)
@@ -65,19 +78,19 @@ void AShooterProjectile::NotifyHit(class UPrimitiveComponent* MyComp, AActor* Ot
 	// disable collision on the projectile
 	CollisionComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
-	// make AI perception noise
-	MakeNoise(NoiseLoudness, GetInstigator(), GetActorLocation(), NoiseRange, NoiseTag);
+	// make AI perception noise. Impacts close together are merged into a single noise
+	UShooterNoiseSubsystem::MakeNoise(this, NoiseLoudness, GetInstigator(), GetActorLocation(), NoiseRange, NoiseTag);
 
 	if (bExplodeOnHit)
 	{
 		
 		// apply explosion damage centered on the projectile
-		ExplosionCheck(GetActorLocation());
+		ExplosionCheck(GetActorLocation(), this);
 
 	} else {
 
 		// single hit projectile. Process the collided actor
-		ProcessHit(Other, OtherComp, Hit.ImpactPoint, -Hit.ImpactNormal);
+		ProcessHit(Other, OtherComp, Hit.ImpactPoint, -Hit.ImpactNormal, this);
 
 	}
 
@@ -92,76 +105,199 @@ void AShooterProjectile::NotifyHit(class UPrimitiveComponent* MyComp, AActor* Ot
 	} else {
 
 		// destroy the projectile right away
-		Destroy();
+		DestroyOrRelease();
 	}
 }
 
-void AShooterProjectile::ExplosionCheck(const FVector& ExplosionCenter)
+void AShooterProjectile::ResolveSimulatedHit(const FHitResult& Hit, const FVector& ImpactVelocity)
 {
-	// do a sphere overlap check look for nearby actors to damage
-	TArray<FOverlapResult> Overlaps;
+	if (ProjectileMovement->bShouldBounce)
+	{
+		// bounce off the surface the same way the movement component would, keeping the impact effects moving
+		const FVector NormalVelocity = Hit.Normal * FVector::DotProduct(ImpactVelocity, Hit.Normal);
+		const FVector TangentVelocity = ImpactVelocity - NormalVelocity;
+
+		ProjectileMovement->Velocity = TangentVelocity * (1.0f - ProjectileMovement->Friction) - NormalVelocity * ProjectileMovement->Bounciness;
+		ProjectileMovement->UpdateComponentVelocity();
 
-	FCollisionShape OverlapShape;
-	OverlapShape.SetSphere(ExplosionRadius);
+	} else {
 
+		// the projectile only exists to represent the impact, so it shouldn't keep flying
+		ProjectileMovement->StopMovementImmediately();
+
+	}
+
+	ResolveHit(Hit.GetActor(), Hit.GetComponent(), Hit);
+}
+
+FCollisionObjectQueryParams AShooterProjectile::GetImpactObjectQueryParams()
+{
 	FCollisionObjectQueryParams ObjectParams;
-	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldStatic);
 	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
 	ObjectParams.AddObjectTypesToQuery(ECC_PhysicsBody);
 
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
+	return ObjectParams;
+}
+
+void AShooterProjectile::ExplosionCheck(const FVector& ExplosionCenter, AActor* DamageCauser) const
+{
+	UShooterExplosionSubsystem* ExplosionSubsystem = DamageCauser->GetWorld()->GetSubsystem<UShooterExplosionSubsystem>();
+
+	if (!ExplosionSubsystem)
+	{
+		return;
+	}
+
+	TArray<const AActor*> IgnoredActors;
+	IgnoredActors.Add(DamageCauser);
+
 	if (!bDamageOwner)
 	{
-		QueryParams.AddIgnoredActor(GetInstigator());
+		IgnoredActors.Add(DamageCauser->GetInstigator());
 	}
 
-	GetWorld()->OverlapMultiByObjectType(Overlaps, ExplosionCenter, FQuat::Identity, ObjectParams, OverlapShape, QueryParams);
+	// find the unique actors in range. The subsystem deduplicates and caps the results
+	TArray<FShooterExplosionTarget> Targets;
+	ExplosionSubsystem->FindExplosionTargets(ExplosionCenter, ExplosionRadius, IgnoredActors, MaxExplosionTargets, bUseDamageableSpatialHash, Targets);
 
-	TArray<AActor*> DamagedActors;
+	int32 NumDamaged = 0;
 
-	// process the overlap results
-	for (const FOverlapResult& CurrentOverlap : Overlaps)
+	for (const FShooterExplosionTarget& Target : Targets)
 	{
-		// overlaps may return the same actor multiple times per each component overlapped
-		// ensure we only damage each actor once by adding it to a damaged list
-		if (DamagedActors.Find(CurrentOverlap.GetActor()) == INDEX_NONE)
-		{
-			DamagedActors.Add(CurrentOverlap.GetActor());
-
-			// apply physics force away from the explosion
-			const FVector& ExplosionDir = CurrentOverlap.GetActor()->GetActorLocation() - GetActorLocation();
+		// apply physics force away from the explosion
+		const FVector ExplosionDir = Target.Actor->GetActorLocation() - ExplosionCenter;
 
-			// push and/or damage the overlapped actor
-			ProcessHit(CurrentOverlap.GetActor(), CurrentOverlap.GetComponent(), GetActorLocation(), ExplosionDir.GetSafeNormal());
+		// push and/or damage the actor
+		if (ProcessHit(Target.Actor, Target.Component, ExplosionCenter, ExplosionDir.GetSafeNormal(), DamageCauser))
+		{
+			++NumDamaged;
 		}
-			
 	}
+
+	ExplosionSubsystem->RecordDamagedActors(NumDamaged);
 }
 
-void AShooterProjectile::ProcessHit(AActor* HitActor, UPrimitiveComponent* HitComp, const FVector& HitLocation, const FVector& HitDirection)
+bool AShooterProjectile::ProcessHit(AActor* HitActor, UPrimitiveComponent* HitComp, const FVector& HitLocation, const FVector& HitDirection, AActor* DamageCauser) const
 {
+	bool bDamaged = false;
+
 	// have we hit a character?
 	if (ACharacter* HitCharacter = Cast<ACharacter>(HitActor))
 	{
-		// ignore the owner of this projectile
-		if (HitCharacter != GetOwner() || bDamageOwner)
+		// ignore the owner of this projectile. Clients only simulate shots, so damage is left to the server
+		if ((HitCharacter != DamageCauser->GetOwner() || bDamageOwner) && DamageCauser->GetNetMode() != NM_Client)
 		{
 			// apply damage to the character
-			UGameplayStatics::ApplyDamage(HitCharacter, HitDamage, GetInstigator()->GetController(), this, HitDamageType);
+			UGameplayStatics::ApplyDamage(HitCharacter, HitDamage, DamageCauser->GetInstigatorController(), DamageCauser, HitDamageType);
+			bDamaged = true;
 		}
 	}
 
 	// have we hit a physics object?
-	if (HitComp->IsSimulatingPhysics())
+	if (HitComp && HitComp->IsSimulatingPhysics())
 	{
 		// give some physics impulse to the object
 		HitComp->AddImpulseAtLocation(HitDirection * PhysicsForce, HitLocation);
 	}
+
+	return bDamaged;
+}
+
+void AShooterProjectile::ApplyImpact(const FHitResult& Hit, AActor* DamageCauser) const
+{
+	if (!DamageCauser)
+	{
+		return;
+	}
+
+	if (bExplodeOnHit)
+	{
+		// apply explosion damage centered on the impact
+		ExplosionCheck(Hit.ImpactPoint, DamageCauser);
+
+	} else {
+
+		// single hit. Process the hit actor
+		ProcessHit(Hit.GetActor(), Hit.GetComponent(), Hit.ImpactPoint, -Hit.ImpactNormal, DamageCauser);
+
+	}
 }
 
 void AShooterProjectile::OnDeferredDestruction()
 {
 	// destroy this actor
+	DestroyOrRelease();
+}
+
+void AShooterProjectile::DestroyOrRelease()
+{
+	// return pooled projectiles to the pool so they can be reused
+	if (bPooled)
+	{
+		if (UShooterProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UShooterProjectilePoolSubsystem>())
+		{
+			Pool->ReleaseProjectile(this);
+			return;
+		}
+	}
+
 	Destroy();
 }
+
+void AShooterProjectile::ResetForPool(const FTransform& SpawnTransform, AActor* NewOwner, APawn* NewInstigator)
+{
+	// flag the projectile as pooled so it's released instead of destroyed
+	bPooled = true;
+	bInPool = false;
+
+	// clear the hit state and any pending destruction
+	bHit = false;
+	GetWorld()->GetTimerManager().ClearTimer(DestructionTimer);
+
+	// update the owner and instigator for damage attribution
+	SetOwner(NewOwner);
+	SetInstigator(NewInstigator);
+
+	// move to the new spawn transform
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	// ignore the pawn that shot this projectile
+	CollisionComponent->ClearMoveIgnoreActors();
+	CollisionComponent->IgnoreActorWhenMoving(NewInstigator, true);
+
+	// restore collision
+	CollisionComponent->SetCollisionEnabled(DefaultCollisionEnabled);
+
+	// restart the movement along the new facing. The component may have stopped simulating on a previous hit
+	ProjectileMovement->SetUpdatedComponent(CollisionComponent);
+	ProjectileMovement->Velocity = SpawnTransform.GetRotation().Vector() * ProjectileMovement->InitialSpeed;
+	ProjectileMovement->Activate(true);
+
+	// show the projectile and resume ticking
+	SetActorHiddenInGame(false);
+	SetActorTickEnabled(true);
+
+	// pass control to BP to reset any effects
+	BP_OnPoolReset();
+}
+
+void AShooterProjectile::DeactivateForPool()
+{
+	bInPool = true;
+
+	// clear any pending destruction
+	GetWorld()->GetTimerManager().ClearTimer(DestructionTimer);
+
+	// stop moving
+	ProjectileMovement->StopMovementImmediately();
+	ProjectileMovement->Deactivate();
+
+	// disable collision
+	CollisionComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	// hide the projectile and stop ticking
+	SetActorHiddenInGame(true);
+	SetActorTickEnabled(false);
+}
@@ -10,6 +10,8 @@ class USphereComponent;
 class UProjectileMovementComponent;
 class ACharacter;
 class UPrimitiveComponent;
+class APawn;
+class UStaticMesh;
 
 /**
  *  Simple projectile class for a first person shooter game
@@ -65,9 +67,25 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Projectile|Explosion", meta = (ClampMin = 0, ClampMax = 5000, Units = "cm"))
 	float ExplosionRadius = 500.0f;	
 
+	/** Max number of unique actors a single explosion can affect. Caps the cost of explosions in crowded areas */
+	UPROPERTY(EditAnywhere, Category="Projectile|Explosion", meta = (ClampMin = 1, ClampMax = 256))
+	int32 MaxExplosionTargets = 32;
+
+	/** If true, the explosion only looks up registered damageable characters through a spatial hash instead of doing a physics overlap. Physics props won't be pushed */
+	UPROPERTY(EditAnywhere, Category="Projectile|Explosion")
+	bool bUseDamageableSpatialHash = false;
+
 	/** If true, this projectile has already hit another surface */
 	bool bHit = false;
 
+	/** Max time this projectile can fly when simulated by the projectile manager before it's discarded */
+	UPROPERTY(EditAnywhere, Category="Projectile|Simulation", meta = (ClampMin = 0, ClampMax = 30, Units = "s"))
+	float SimulatedLifetime = 3.0f;
+
+	/** Optional mesh used to draw this projectile while it's simulated by the projectile manager. If unset, simulated projectiles are invisible until they hit */
+	UPROPERTY(EditAnywhere, Category="Projectile|Simulation")
+	TObjectPtr<UStaticMesh> SimulatedProxyMesh;
+
 	/** How long to wait after a hit before destroying this projectile */
 	UPROPERTY(EditAnywhere, Category="Projectile|Destruction", meta = (ClampMin = 0, ClampMax = 10, Units = "s"))
 	float DeferredDestructionTime = 5.0f;
@@ -75,6 +93,15 @@ protected:
 	/** Timer to handle deferred destruction of this projectile */
 	FTimerHandle DestructionTimer;
 
+	/** If true, this projectile was acquired from the projectile pool and will be returned to it instead of destroyed */
+	bool bPooled = false;
+
+	/** If true, this projectile is deactivated and waiting in the projectile pool */
+	bool bInPool = false;
+
+	/** Collision state set up by the class defaults. Restored when the projectile is reused from the pool */
+	ECollisionEnabled::Type DefaultCollisionEnabled = ECollisionEnabled::QueryAndPhysics;
+
 public:	
 
 	/** Constructor */
@@ -93,11 +120,14 @@ protected:
 
 protected:
 
-	/** Looks up actors within the explosion radius and damages them */
-	void ExplosionCheck(const FVector& ExplosionCenter);
+	/** Applies noise, damage and hit effects for a hit against the given actor, then schedules destruction */
+	void ResolveHit(AActor* Other, UPrimitiveComponent* OtherComp, const FHitResult& Hit);
+
+	/** Looks up actors within the explosion radius and damages them on behalf of the damage causer */
+	void ExplosionCheck(const FVector& ExplosionCenter, AActor* DamageCauser) const;
 
-	/** Processes a projectile hit for the given actor */
-	void ProcessHit(AActor* HitActor, UPrimitiveComponent* HitComp, const FVector& HitLocation, const FVector& HitDirection);
+	/** Processes a projectile hit for the given actor on behalf of the damage causer. Returns true if damage was applied */
+	bool ProcessHit(AActor* HitActor, UPrimitiveComponent* HitComp, const FVector& HitLocation, const FVector& HitDirection, AActor* DamageCauser) const;
 
 	/** Passes control to Blueprint to implement any effects on hit. */
 	UFUNCTION(BlueprintImplementableEvent, Category="Projectile", meta = (DisplayName = "On Projectile Hit"))
@@ -106,4 +136,56 @@ protected:
 	/** Called from the destruction timer to destroy this projectile */
 	void OnDeferredDestruction();
 
+	/** Destroys this projectile, or returns it to the projectile pool if it came from one */
+	void DestroyOrRelease();
+
+	/** Passes control to Blueprint to reset any effects when the projectile is reused from the pool */
+	UFUNCTION(BlueprintImplementableEvent, Category="Projectile", meta = (DisplayName = "On Projectile Pool Reset"))
+	void BP_OnPoolReset();
+
+public:
+
+	/** Resets hit state, collision, movement and timers so the projectile can be fired again from the given transform */
+	void ResetForPool(const FTransform& SpawnTransform, AActor* NewOwner, APawn* NewInstigator);
+
+	/** Stops, hides and disables collision on the projectile while it waits in the pool */
+	void DeactivateForPool();
+
+	/**
+	 *  Applies this projectile's hit logic for an impact that didn't come from a projectile actor, such as a hitscan shot.
+	 *  Damage is attributed to the damage causer's owner and instigator. Safe to call on the class default object.
+	 */
+	void ApplyImpact(const FHitResult& Hit, AActor* DamageCauser) const;
+
+	/** Resolves a hit computed by the projectile manager and runs the regular hit logic.
+	 *  Bouncing projectiles carry on from the impact like an actor projectile would. Others stop where they are */
+	void ResolveSimulatedHit(const FHitResult& Hit, const FVector& ImpactVelocity);
+
+	/** Returns the object types projectiles collide with when they're resolved through traces instead of the collision component */
+	static FCollisionObjectQueryParams GetImpactObjectQueryParams();
+
+	/** Returns the collision component */
+	USphereComponent* GetCollisionComponent() const { return CollisionComponent; }
+
+	/** Returns the projectile movement component */
+	UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
+
+	/** Returns the max flight time when simulated by the projectile manager */
+	float GetSimulatedLifetime() const { return SimulatedLifetime; }
+
+	/** Returns the mesh used to draw this projectile while simulated */
+	UStaticMesh* GetSimulatedProxyMesh() const { return SimulatedProxyMesh; }
+
+	/** Returns true if this projectile is waiting in the projectile pool */
+	bool IsInPool() const { return bInPool; }
+
+	/** Returns the loudness of the AI perception noise done on hit */
+	float GetNoiseLoudness() const { return NoiseLoudness; }
+
+	/** Returns the range of the AI perception noise done on hit */
+	float GetNoiseRange() const { return NoiseRange; }
+
+	/** Returns the tag of the AI perception noise done on hit */
+	FName GetNoiseTag() const { return NoiseTag; }
+
 };
@@ -0,0 +1,275 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterProjectileManager.h"
+#include "ShooterProjectile.h"
+#include "ShooterProjectilePool.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/SphereComponent.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "Revolution2.h"
+
+DECLARE_CYCLE_STAT(TEXT("Projectile Manager Tick"), STAT_ShooterProjectileManager, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Simulated Projectiles"), STAT_ShooterSimulatedProjectiles, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Simulated Projectile Impacts"), STAT_ShooterSimulatedImpacts, STATGROUP_Shooter);
+
+void UShooterProjectileManager::AddProjectile(TSubclassOf<AShooterProjectile> ProjectileClass, const FTransform& SpawnTransform, AActor* NewOwner, APawn* NewInstigator, AActor* FiringWeapon)
+{
+	const int32 TypeIndex = FindOrAddType(ProjectileClass);
+
+	if (TypeIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	const FShooterSimulatedProjectileType& Type = Types[TypeIndex];
+
+	// add the projectile state to the end of every array
+	Positions.Add(SpawnTransform.GetLocation());
+	Velocities.Add(SpawnTransform.GetRotation().Vector() * Type.InitialSpeed);
+	Lifetimes.Add(Type.Lifetime);
+	TypeIndices.Add(TypeIndex);
+	Owners.Add(NewOwner);
+	Instigators.Add(NewInstigator);
+	Weapons.Add(FiringWeapon);
+}
+
+void UShooterProjectileManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UWorld* World = GetWorld();
+
+	const int32 NumProjectiles = Positions.Num();
+	const float GravityZ = World->GetGravityZ();
+
+	NextPositions.SetNumUninitialized(NumProjectiles, EAllowShrinking::No);
+	Removals.Reset();
+	Impacts.Reset();
+
+	// integrate every projectile in one pass
+	for (int32 i = 0; i < NumProjectiles; ++i)
+	{
+		const FShooterSimulatedProjectileType& Type = Types[TypeIndices[i]];
+
+		FVector& Velocity = Velocities[i];
+
+		// apply gravity and clamp to the max speed
+		Velocity.Z += GravityZ * Type.GravityScale * DeltaTime;
+
+		if (Type.MaxSpeed > 0.0f)
+		{
+			Velocity = Velocity.GetClampedToMaxSize(Type.MaxSpeed);
+		}
+
+		NextPositions[i] = Positions[i] + (Velocity * DeltaTime);
+		Lifetimes[i] -= DeltaTime;
+	}
+
+	// sweep every projectile along this frame's movement
+	const FCollisionObjectQueryParams ObjectParams = AShooterProjectile::GetImpactObjectQueryParams();
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShooterProjectileSweep));
+
+	RecordShooterSceneQueries(NumProjectiles);
+
+	for (int32 i = 0; i < NumProjectiles; ++i)
+	{
+		// ignore the pawn that shot the projectile and its weapon, which the muzzle may still be inside of
+		QueryParams.ClearIgnoredActors();
+		QueryParams.AddIgnoredActor(Instigators[i].Get());
+		QueryParams.AddIgnoredActor(Weapons[i].Get());
+
+		const FCollisionShape SweepShape = FCollisionShape::MakeSphere(Types[TypeIndices[i]].CollisionRadius);
+
+		FHitResult OutHit;
+
+		if (World->SweepSingleByObjectType(OutHit, Positions[i], NextPositions[i], FQuat::Identity, ObjectParams, SweepShape, QueryParams))
+		{
+			// queue the impact. We resolve them after the sweep so hit logic can't change the arrays while we iterate
+			Impacts.Emplace(i, OutHit);
+			Removals.Add(i);
+
+		} else if (Lifetimes[i] <= 0.0f) {
+
+			// the projectile expired without hitting anything
+			Removals.Add(i);
+
+		} else {
+
+			Positions[i] = NextPositions[i];
+		}
+	}
+
+	// resolve the impacts
+	for (const TPair<int32, FHitResult>& Impact : Impacts)
+	{
+		ResolveImpact(Impact.Key, Impact.Value);
+	}
+
+	// remove from the back so swapped projectiles are never pending removal
+	for (int32 i = Removals.Num() - 1; i >= 0; --i)
+	{
+		RemoveProjectileAtSwap(Removals[i]);
+	}
+
+	UpdateProxies();
+
+	SET_DWORD_STAT(STAT_ShooterSimulatedProjectiles, Positions.Num());
+	SET_DWORD_STAT(STAT_ShooterSimulatedImpacts, Impacts.Num());
+}
+
+bool UShooterProjectileManager::IsTickable() const
+{
+	return Positions.Num() > 0;
+}
+
+TStatId UShooterProjectileManager::GetStatId() const
+{
+	return GET_STATID(STAT_ShooterProjectileManager);
+}
+
+int32 UShooterProjectileManager::FindOrAddType(TSubclassOf<AShooterProjectile> ProjectileClass)
+{
+	if (!ProjectileClass)
+	{
+		return INDEX_NONE;
+	}
+
+	// have we already cached this class?
+	if (const int32* FoundIndex = TypeLookup.Find(ProjectileClass))
+	{
+		return *FoundIndex;
+	}
+
+	// read the movement and collision parameters from the class defaults
+	const AShooterProjectile* Defaults = GetDefault<AShooterProjectile>(ProjectileClass);
+
+	FShooterSimulatedProjectileType& Type = Types.AddDefaulted_GetRef();
+	Type.ProjectileClass = ProjectileClass;
+	Type.InitialSpeed = Defaults->GetProjectileMovement()->InitialSpeed;
+	Type.MaxSpeed = Defaults->GetProjectileMovement()->MaxSpeed;
+	Type.GravityScale = Defaults->GetProjectileMovement()->ProjectileGravityScale;
+	Type.CollisionRadius = Defaults->GetCollisionComponent()->GetScaledSphereRadius();
+	Type.Lifetime = Defaults->GetSimulatedLifetime();
+	Type.ProxyIndex = Defaults->GetSimulatedProxyMesh() ? FindOrAddProxy(Defaults->GetSimulatedProxyMesh()) : INDEX_NONE;
+
+	return TypeLookup.Add(ProjectileClass, Types.Num() - 1);
+}
+
+int32 UShooterProjectileManager::FindOrAddProxy(UStaticMesh* Mesh)
+{
+	// reuse the component if another projectile type already uses this mesh
+	for (int32 i = 0; i < ProxyComponents.Num(); ++i)
+	{
+		if (ProxyComponents[i]->GetStaticMesh() == Mesh)
+		{
+			return i;
+		}
+	}
+
+	// spawn the actor that holds the proxy components
+	if (!ProxyActor)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+
+		ProxyActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+
+		USceneComponent* ProxyRoot = NewObject<USceneComponent>(ProxyActor, TEXT("Root"));
+		ProxyActor->SetRootComponent(ProxyRoot);
+		ProxyRoot->RegisterComponent();
+	}
+
+	// create the instanced mesh component
+	UInstancedStaticMeshComponent* Proxy = NewObject<UInstancedStaticMeshComponent>(ProxyActor);
+	Proxy->SetStaticMesh(Mesh);
+	Proxy->SetMobility(EComponentMobility::Movable);
+	Proxy->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Proxy->SetCastShadow(false);
+	Proxy->SetupAttachment(ProxyActor->GetRootComponent());
+	Proxy->RegisterComponent();
+
+	ProxyComponents.Add(Proxy);
+	ProxyTransforms.AddDefaulted();
+
+	return ProxyComponents.Num() - 1;
+}
+
+void UShooterProjectileManager::RemoveProjectileAtSwap(int32 Index)
+{
+	Positions.RemoveAtSwap(Index, EAllowShrinking::No);
+	Velocities.RemoveAtSwap(Index, EAllowShrinking::No);
+	Lifetimes.RemoveAtSwap(Index, EAllowShrinking::No);
+	TypeIndices.RemoveAtSwap(Index, EAllowShrinking::No);
+	Owners.RemoveAtSwap(Index, EAllowShrinking::No);
+	Instigators.RemoveAtSwap(Index, EAllowShrinking::No);
+	Weapons.RemoveAtSwap(Index, EAllowShrinking::No);
+}
+
+void UShooterProjectileManager::ResolveImpact(int32 Index, const FHitResult& Hit)
+{
+	UShooterProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UShooterProjectilePoolSubsystem>();
+
+	if (!Pool)
+	{
+		return;
+	}
+
+	// build a projectile actor at the impact so it can run the regular hit logic and Blueprint effects
+	const FTransform ImpactTransform(Velocities[Index].Rotation(), Hit.Location);
+
+	if (AShooterProjectile* Projectile = Pool->AcquireProjectile(Types[TypeIndices[Index]].ProjectileClass, ImpactTransform, Owners[Index].Get(), Instigators[Index].Get()))
+	{
+		Projectile->ResolveSimulatedHit(Hit, Velocities[Index]);
+	}
+}
+
+void UShooterProjectileManager::UpdateProxies()
+{
+	if (ProxyComponents.Num() == 0)
+	{
+		return;
+	}
+
+	// gather the transforms for each proxy component
+	for (TArray<FTransform>& Transforms : ProxyTransforms)
+	{
+		Transforms.Reset();
+	}
+
+	for (int32 i = 0; i < Positions.Num(); ++i)
+	{
+		const int32 ProxyIndex = Types[TypeIndices[i]].ProxyIndex;
+
+		if (ProxyIndex != INDEX_NONE)
+		{
+			ProxyTransforms[ProxyIndex].Emplace(Velocities[i].Rotation(), Positions[i]);
+		}
+	}
+
+	// push the transforms to the instanced mesh components
+	for (int32 i = 0; i < ProxyComponents.Num(); ++i)
+	{
+		UInstancedStaticMeshComponent* Proxy = ProxyComponents[i];
+		const TArray<FTransform>& Transforms = ProxyTransforms[i];
+
+		// match the instance count to the number of projectiles
+		for (int32 InstanceIndex = Proxy->GetInstanceCount() - 1; InstanceIndex >= Transforms.Num(); --InstanceIndex)
+		{
+			Proxy->RemoveInstance(InstanceIndex);
+		}
+
+		for (int32 InstanceIndex = Proxy->GetInstanceCount(); InstanceIndex < Transforms.Num(); ++InstanceIndex)
+		{
+			Proxy->AddInstance(Transforms[InstanceIndex], true);
+		}
+
+		if (Transforms.Num() > 0)
+		{
+			Proxy->BatchUpdateInstancesTransforms(0, Transforms, true, true, true);
+		}
+	}
+}
@@ -0,0 +1,129 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterProjectileManager.generated.h"
+
+class AShooterProjectile;
+class APawn;
+class UStaticMesh;
+class UInstancedStaticMeshComponent;
+
+/**
+ *  Movement and collision parameters shared by every simulated projectile of the same class
+ *  Read once from the projectile class defaults
+ */
+struct FShooterSimulatedProjectileType
+{
+	/** Projectile class used to resolve impacts */
+	TSubclassOf<AShooterProjectile> ProjectileClass;
+
+	/** Initial speed along the firing direction */
+	float InitialSpeed = 0.0f;
+
+	/** Max speed. Zero means unlimited */
+	float MaxSpeed = 0.0f;
+
+	/** Multiplier for the world gravity */
+	float GravityScale = 1.0f;
+
+	/** Radius of the collision sweep */
+	float CollisionRadius = 0.0f;
+
+	/** Max flight time */
+	float Lifetime = 0.0f;
+
+	/** Index of the visual proxy component, or INDEX_NONE if the projectile is invisible in flight */
+	int32 ProxyIndex = INDEX_NONE;
+};
+
+/**
+ *  Simulates in-flight projectiles in batch without spawning an actor per shot
+ *  Projectile state is kept in parallel arrays that are integrated and swept in one pass per frame
+ *  A pooled projectile actor is only acquired when a projectile hits something, so it can run the regular hit logic and Blueprint effects
+ */
+UCLASS()
+class REVOLUTION2_API UShooterProjectileManager : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Position of each simulated projectile */
+	TArray<FVector> Positions;
+
+	/** Velocity of each simulated projectile */
+	TArray<FVector> Velocities;
+
+	/** Remaining flight time of each simulated projectile */
+	TArray<float> Lifetimes;
+
+	/** Index into the projectile types array for each simulated projectile */
+	TArray<int32> TypeIndices;
+
+	/** Owner of each simulated projectile */
+	TArray<TWeakObjectPtr<AActor>> Owners;
+
+	/** Instigator of each simulated projectile */
+	TArray<TWeakObjectPtr<APawn>> Instigators;
+
+	/** Weapon that fired each simulated projectile */
+	TArray<TWeakObjectPtr<AActor>> Weapons;
+
+	/** Scratch array with the end of this frame's movement for each projectile */
+	TArray<FVector> NextPositions;
+
+	/** Scratch array of projectiles to remove this frame, in ascending order */
+	TArray<int32> Removals;
+
+	/** Scratch array of impacts to resolve this frame */
+	TArray<TPair<int32, FHitResult>> Impacts;
+
+	/** Cached parameters for each projectile class we've simulated */
+	TArray<FShooterSimulatedProjectileType> Types;
+
+	/** Maps projectile classes to their index in the types array */
+	TMap<TSubclassOf<AShooterProjectile>, int32> TypeLookup;
+
+	/** Actor that holds the visual proxy components */
+	UPROPERTY()
+	TObjectPtr<AActor> ProxyActor;
+
+	/** Instanced mesh components used to draw simulated projectiles, one per proxy mesh */
+	UPROPERTY()
+	TArray<TObjectPtr<UInstancedStaticMeshComponent>> ProxyComponents;
+
+	/** Scratch array of instance transforms for each proxy component */
+	TArray<TArray<FTransform>> ProxyTransforms;
+
+public:
+
+	/** Adds a projectile of the given class fired from the given transform to the simulation. The firing weapon and the instigator are never hit */
+	void AddProjectile(TSubclassOf<AShooterProjectile> ProjectileClass, const FTransform& SpawnTransform, AActor* NewOwner, APawn* NewInstigator, AActor* FiringWeapon);
+
+	/** Returns the number of projectiles currently in flight */
+	int32 GetNumProjectiles() const { return Positions.Num(); }
+
+	//~Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~End FTickableGameObject interface
+
+protected:
+
+	/** Returns the type index for the given projectile class, caching its parameters on first use */
+	int32 FindOrAddType(TSubclassOf<AShooterProjectile> ProjectileClass);
+
+	/** Returns the proxy component index for the given mesh, creating the component on first use */
+	int32 FindOrAddProxy(UStaticMesh* Mesh);
+
+	/** Removes the projectile at the given index by swapping the last projectile into its place */
+	void RemoveProjectileAtSwap(int32 Index);
+
+	/** Acquires a projectile actor to resolve an impact */
+	void ResolveImpact(int32 Index, const FHitResult& Hit);
+
+	/** Updates the visual proxy instances to match the simulated projectiles */
+	void UpdateProxies();
+};
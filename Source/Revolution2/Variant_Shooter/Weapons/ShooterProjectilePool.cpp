@@ -0,0 +1,151 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterProjectilePool.h"
+#include "ShooterProjectile.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "Revolution2.h"
+
+void UShooterProjectilePoolSubsystem::Deinitialize()
+{
+	UE_LOG(LogRevolution2, Log, TEXT("Projectile pool: %d hits, %d misses, %d releases, high water %d"), Stats.Hits, Stats.Misses, Stats.Releases, Stats.HighWater);
+
+	// the pooled actors are destroyed along with the world
+	Pools.Empty();
+
+	Super::Deinitialize();
+}
+
+void UShooterProjectilePoolSubsystem::Prewarm(TSubclassOf<AShooterProjectile> ProjectileClass, int32 Count)
+{
+	if (!ProjectileClass)
+	{
+		return;
+	}
+
+	FShooterProjectilePoolEntry& Pool = Pools.FindOrAdd(ProjectileClass);
+
+	// spawn inactive projectiles until we reach the requested count
+	while (Pool.Available.Num() < Count)
+	{
+		AShooterProjectile* Projectile = SpawnProjectile(ProjectileClass, FTransform::Identity, nullptr, nullptr);
+
+		if (!Projectile)
+		{
+			return;
+		}
+
+		Projectile->DeactivateForPool();
+		Pool.Available.Add(Projectile);
+	}
+}
+
+AShooterProjectile* UShooterProjectilePoolSubsystem::AcquireProjectile(TSubclassOf<AShooterProjectile> ProjectileClass, const FTransform& SpawnTransform, AActor* NewOwner, APawn* NewInstigator)
+{
+	if (!ProjectileClass)
+	{
+		return nullptr;
+	}
+
+	AShooterProjectile* Projectile = nullptr;
+
+	// try to reuse a pooled projectile first
+	if (FShooterProjectilePoolEntry* Pool = Pools.Find(ProjectileClass))
+	{
+		while (!Projectile && Pool->Available.Num() > 0)
+		{
+			// pooled actors may have been destroyed from outside the pool, so skip any invalid ones
+			AShooterProjectile* Candidate = Pool->Available.Pop(EAllowShrinking::No);
+
+			if (IsValid(Candidate))
+			{
+				Projectile = Candidate;
+			}
+		}
+	}
+
+	if (Projectile)
+	{
+		++Stats.Hits;
+
+	} else {
+
+		// the pool is empty, so we need a new projectile
+		Projectile = SpawnProjectile(ProjectileClass, SpawnTransform, NewOwner, NewInstigator);
+
+		if (!Projectile)
+		{
+			return nullptr;
+		}
+
+		++Stats.Misses;
+	}
+
+	// get the projectile ready to fly
+	Projectile->ResetForPool(SpawnTransform, NewOwner, NewInstigator);
+
+	// update the active counters
+	++Stats.NumActive;
+	Stats.HighWater = FMath::Max(Stats.HighWater, Stats.NumActive);
+
+	return Projectile;
+}
+
+void UShooterProjectilePoolSubsystem::ReleaseProjectile(AShooterProjectile* Projectile)
+{
+	// a projectile can be released twice, e.g. by a hit and its deferred destruction in the same frame
+	if (!IsValid(Projectile) || Projectile->IsInPool())
+	{
+		return;
+	}
+
+	// disable the projectile until it's acquired again
+	Projectile->DeactivateForPool();
+
+	Pools.FindOrAdd(Projectile->GetClass()).Available.Add(Projectile);
+
+	++Stats.Releases;
+	Stats.NumActive = FMath::Max(Stats.NumActive - 1, 0);
+}
+
+AShooterProjectile* UShooterProjectilePoolSubsystem::SpawnProjectile(TSubclassOf<AShooterProjectile> ProjectileClass, const FTransform& SpawnTransform, AActor* NewOwner, APawn* NewInstigator)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.TransformScaleMethod = ESpawnActorScaleMethod::OverrideRootScale;
+	SpawnParams.Owner = NewOwner;
+	SpawnParams.Instigator = NewInstigator;
+
+	AShooterProjectile* Projectile = GetWorld()->SpawnActor<AShooterProjectile>(ProjectileClass, SpawnTransform, SpawnParams);
+
+	if (Projectile)
+	{
+		Projectile->OnDestroyed.AddDynamic(this, &UShooterProjectilePoolSubsystem::OnProjectileDestroyed);
+	}
+
+	return Projectile;
+}
+
+void UShooterProjectilePoolSubsystem::OnProjectileDestroyed(AActor* DestroyedActor)
+{
+	AShooterProjectile* Projectile = Cast<AShooterProjectile>(DestroyedActor);
+
+	if (!Projectile)
+	{
+		return;
+	}
+
+	// pooled ones just leave the pool. Active ones will never be released, so stop counting them
+	if (Projectile->IsInPool())
+	{
+		if (FShooterProjectilePoolEntry* Pool = Pools.Find(Projectile->GetClass()))
+		{
+			Pool->Available.RemoveSingleSwap(Projectile, EAllowShrinking::No);
+		}
+
+	} else {
+
+		Stats.NumActive = FMath::Max(Stats.NumActive - 1, 0);
+	}
+}
@@ -0,0 +1,87 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterProjectilePool.generated.h"
+
+class AShooterProjectile;
+class APawn;
+
+/**
+ *  List of inactive projectiles of a single class waiting to be reused
+ */
+USTRUCT()
+struct FShooterProjectilePoolEntry
+{
+	GENERATED_BODY()
+
+	/** Projectiles currently sitting in the pool */
+	UPROPERTY()
+	TArray<TObjectPtr<AShooterProjectile>> Available;
+};
+
+/**
+ *  Usage counters for the projectile pool
+ */
+struct FShooterProjectilePoolStats
+{
+	/** Number of acquires served from an already pooled projectile */
+	int32 Hits = 0;
+
+	/** Number of acquires that had to spawn a new projectile */
+	int32 Misses = 0;
+
+	/** Number of projectiles returned to the pool */
+	int32 Releases = 0;
+
+	/** Number of projectiles currently in flight or waiting for deferred release */
+	int32 NumActive = 0;
+
+	/** Highest number of simultaneously active projectiles */
+	int32 HighWater = 0;
+};
+
+/**
+ *  Keeps pools of inactive projectiles so weapons don't have to spawn and destroy an actor per shot
+ *  Projectiles acquired from the pool return to it instead of being destroyed
+ */
+UCLASS()
+class REVOLUTION2_API UShooterProjectilePoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Inactive projectiles by class */
+	UPROPERTY()
+	TMap<TSubclassOf<AShooterProjectile>, FShooterProjectilePoolEntry> Pools;
+
+	/** Pool usage counters */
+	FShooterProjectilePoolStats Stats;
+
+public:
+
+	/** Subsystem cleanup */
+	virtual void Deinitialize() override;
+
+	/** Ensures at least the given number of inactive projectiles of this class are ready in the pool */
+	void Prewarm(TSubclassOf<AShooterProjectile> ProjectileClass, int32 Count);
+
+	/** Returns a projectile of the given class fired from the given transform. Spawns a new one if the pool is empty */
+	AShooterProjectile* AcquireProjectile(TSubclassOf<AShooterProjectile> ProjectileClass, const FTransform& SpawnTransform, AActor* NewOwner, APawn* NewInstigator);
+
+	/** Deactivates the projectile and returns it to the pool. Projectiles already in the pool are ignored */
+	void ReleaseProjectile(AShooterProjectile* Projectile);
+
+	/** Returns the pool usage counters */
+	const FShooterProjectilePoolStats& GetStats() const { return Stats; }
+
+protected:
+
+	/** Spawns a new projectile of the given class */
+	AShooterProjectile* SpawnProjectile(TSubclassOf<AShooterProjectile> ProjectileClass, const FTransform& SpawnTransform, AActor* NewOwner, APawn* NewInstigator);
+
+	/** Keeps the counters right when a projectile spawned by the pool is destroyed from outside it */
+	UFUNCTION()
+	void OnProjectileDestroyed(AActor* DestroyedActor);
+};
@@ -5,12 +5,22 @@
 #include "Kismet/KismetMathLibrary.h"
 #include "Engine/World.h"
 #include "ShooterProjectile.h"
+#include "ShooterProjectilePool.h"
+#include "ShooterProjectileManager.h"
 #include "ShooterWeaponHolder.h"
 #include "Components/SceneComponent.h"
 #include "TimerManager.h"
 #include "Animation/AnimInstance.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "GameFramework/Pawn.h"
+#include "ShooterNoiseSubsystem.h"
+#include "ShooterWeaponNetComponent.h"
+#include "ShooterLagCompensationSubsystem.h"
+#include "GameFramework/GameStateBase.h"
+#include "Revolution2.h"
+
+DECLARE_CYCLE_STAT(TEXT("Fire Projectile"), STAT_ShooterFireProjectile, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Fire Hitscan"), STAT_ShooterFireHitscan, STATGROUP_Shooter);
 
 AShooterWeapon::AShooterWeapon()
 {
@@ -34,6 +44,9 @@ AShooterWeapon::AShooterWeapon()
 	ThirdPersonMesh->SetCollisionProfileName(FName("NoCollision"));
 	ThirdPersonMesh->SetFirstPersonPrimitiveType(EFirstPersonPrimitiveType::WorldSpaceRepresentation);
 	ThirdPersonMesh->bOwnerNoSee = true;
+
+	// weapons are spawned on every machine. Their shots replicate through the owner's weapon net component
+	bReplicates = false;
 }
 
 void AShooterWeapon::BeginPlay()
@@ -47,9 +60,21 @@ void AShooterWeapon::BeginPlay()
 	WeaponOwner = Cast<IShooterWeaponHolder>(GetOwner());
 	PawnOwner = Cast<APawn>(GetOwner());
 
+	// find the owner's shot replication component, if any
+	NetComponent = GetOwner()->FindComponentByClass<UShooterWeaponNetComponent>();
+
 	// fill the first ammo clip
 	CurrentBullets = MagazineSize;
 
+	// get some projectiles ready in the pool. Hitscan weapons don't need them
+	if (FireMode != EShooterFireMode::Hitscan)
+	{
+		if (UShooterProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UShooterProjectilePoolSubsystem>())
+		{
+			Pool->Prewarm(ProjectileClass, ProjectilePoolPrewarmCount);
+		}
+	}
+
 	// attach the meshes to the owner
 	WeaponOwner->AttachWeaponMeshes(this);
 }
@@ -137,8 +162,8 @@ void AShooterWeapon::Fire()
 	// update the time of our last shot
 	TimeOfLastShot = GetWorld()->GetTimeSeconds();
 
-	// make noise so the AI perception system can hear us
-	MakeNoise(ShotLoudness, PawnOwner, PawnOwner->GetActorLocation(), ShotNoiseRange, ShotNoiseTag);
+	// make noise so the AI perception system can hear us. Sustained fire is merged into a single noise
+	UShooterNoiseSubsystem::MakeNoise(this, ShotLoudness, PawnOwner, PawnOwner->GetActorLocation(), ShotNoiseRange, ShotNoiseTag);
 
 	// are we full auto?
 	if (bFullAuto)
@@ -163,15 +188,9 @@ void AShooterWeapon::FireProjectile(const FVector& TargetLocation)
 {
 	// get the projectile transform
 	FTransform ProjectileTransform = CalculateProjectileSpawnTransform(TargetLocation);
-	
-	// spawn the projectile
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-	SpawnParams.TransformScaleMethod = ESpawnActorScaleMethod::OverrideRootScale;
-	SpawnParams.Owner = GetOwner();
-	SpawnParams.Instigator = PawnOwner;
 
-	AShooterProjectile* Projectile = GetWorld()->SpawnActor<AShooterProjectile>(ProjectileClass, ProjectileTransform, SpawnParams);
+	// resolve the shot
+	FireShot(ProjectileTransform);
 
 	// play the firing montage
 	WeaponOwner->PlayFiringMontage(FiringMontage);
@@ -180,6 +199,53 @@ void AShooterWeapon::FireProjectile(const FVector& TargetLocation)
 	WeaponOwner->AddWeaponRecoil(FiringRecoil);
 
 	// consume bullets
+	ConsumeBullet();
+
+	// update the weapon HUD
+	WeaponOwner->UpdateWeaponHUD(CurrentBullets, MagazineSize);
+
+	// in multiplayer, send the shot to the server or forward it to the other clients
+	if (NetComponent)
+	{
+		NetComponent->QueueShot(this, ProjectileTransform, GetServerWorldTime());
+	}
+}
+
+void AShooterWeapon::FireShot(const FTransform& ShotTransform, float RewindTime)
+{
+	switch (FireMode)
+	{
+	case EShooterFireMode::Projectile:
+		{
+			SCOPE_CYCLE_COUNTER(STAT_ShooterFireProjectile);
+
+			// get a projectile from the pool. It will spawn a new one if needed
+			if (UShooterProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UShooterProjectilePoolSubsystem>())
+			{
+				Pool->AcquireProjectile(ProjectileClass, ShotTransform, GetOwner(), PawnOwner);
+			}
+		}
+		break;
+
+	case EShooterFireMode::Simulated:
+
+		// hand the projectile over to the projectile manager
+		if (UShooterProjectileManager* ProjectileManager = GetWorld()->GetSubsystem<UShooterProjectileManager>())
+		{
+			ProjectileManager->AddProjectile(ProjectileClass, ShotTransform, GetOwner(), PawnOwner, this);
+		}
+		break;
+
+	case EShooterFireMode::Hitscan:
+
+		// resolve the shot right away without a projectile actor
+		FireHitscan(ShotTransform, RewindTime);
+		break;
+	}
+}
+
+void AShooterWeapon::ConsumeBullet()
+{
 	--CurrentBullets;
 
 	// if the clip is depleted, reload it
@@ -187,6 +253,101 @@ void AShooterWeapon::FireProjectile(const FVector& TargetLocation)
 	{
 		CurrentBullets = MagazineSize;
 	}
+}
+
+float AShooterWeapon::GetServerWorldTime() const
+{
+	if (const AGameStateBase* GameState = GetWorld()->GetGameState())
+	{
+		return GameState->GetServerWorldTimeSeconds();
+	}
+
+	return GetWorld()->GetTimeSeconds();
+}
+
+int32 AShooterWeapon::FireValidatedShots(const TArray<FShooterShotRecord>& Shots)
+{
+	const float ServerTime = GetServerWorldTime();
+	const FVector OwnerLocation = GetOwner()->GetActorLocation();
+
+	// shots arrive in batches and with jitter, so allow one refire of slack. The magazine refills instantly, so it doesn't limit the rate
+	const int32 MaxShotsInWindow = FMath::FloorToInt32((ShotRateWindow + RefireTolerance) / FMath::Max(RefireRate, UE_KINDA_SMALL_NUMBER)) + 1;
+
+	// the window runs on the server's clock, so forged shot times can't widen it
+	AcceptedShotTimes.RemoveAll([ServerTime, this](float AcceptedTime) { return ServerTime - AcceptedTime > ShotRateWindow; });
+
+	int32 NumAccepted = 0;
+
+	for (const FShooterShotRecord& Shot : Shots)
+	{
+		// reject shots fired faster than the refire rate allows
+		if (LastValidatedShotTime >= 0.0f && Shot.ShotTime - LastValidatedShotTime < RefireRate - RefireTolerance)
+		{
+			continue;
+		}
+
+		// reject stale shots and shots from the future
+		if (ServerTime - Shot.ShotTime > MaxShotAge || Shot.ShotTime - ServerTime > RefireTolerance)
+		{
+			continue;
+		}
+
+		// reject shots that didn't come from near the owner
+		if (FVector::DistSquared(Shot.Origin, OwnerLocation) > FMath::Square(MaxShotOriginError))
+		{
+			continue;
+		}
+
+		// reject shots past what the weapon could have fired over the window
+		if (AcceptedShotTimes.Num() >= MaxShotsInWindow)
+		{
+			continue;
+		}
+
+		AcceptedShotTimes.Add(ServerTime);
+
+		LastValidatedShotTime = Shot.ShotTime;
+		TimeOfLastShot = GetWorld()->GetTimeSeconds();
+
+		// fire the authoritative shot. This also queues it for the other clients
+		const FTransform ShotTransform(Shot.Direction.Rotation(), Shot.Origin);
+
+		// hitscan shots are confirmed against the targets where the shooter saw them
+		FireShot(ShotTransform, Shot.ShotTime);
+		WeaponOwner->PlayFiringMontage(FiringMontage);
+		ConsumeBullet();
+
+		if (NetComponent)
+		{
+			NetComponent->QueueShot(this, ShotTransform, Shot.ShotTime);
+		}
+
+		// make noise so the AI perception system can hear the shot
+		UShooterNoiseSubsystem::MakeNoise(this, ShotLoudness, PawnOwner, OwnerLocation, ShotNoiseRange, ShotNoiseTag);
+
+		++NumAccepted;
+	}
+
+	return NumAccepted;
+}
+
+void AShooterWeapon::FireCosmeticShots(const TArray<FShooterShotRecord>& Shots)
+{
+	for (const FShooterShotRecord& Shot : Shots)
+	{
+		FireShot(FTransform(Shot.Direction.Rotation(), Shot.Origin));
+	}
+
+	// one montage is enough for the whole batch
+	if (Shots.Num() > 0)
+	{
+		WeaponOwner->PlayFiringMontage(FiringMontage);
+	}
+}
+
+void AShooterWeapon::ReconcileAmmo(int32 ServerBullets)
+{
+	CurrentBullets = FMath::Clamp(ServerBullets, 0, MagazineSize);
 
 	// update the weapon HUD
 	WeaponOwner->UpdateWeaponHUD(CurrentBullets, MagazineSize);
@@ -207,6 +368,71 @@ FTransform AShooterWeapon::CalculateProjectileSpawnTransform(const FVector& Targ
 	return FTransform(AimRot, SpawnLoc, FVector::OneVector);
 }
 
+void AShooterWeapon::FireHitscan(const FTransform& ShotTransform, float RewindTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterFireHitscan);
+
+	// we use the projectile class defaults for damage, impulse and noise
+	const AShooterProjectile* ProjectileDefaults = ProjectileClass ? ProjectileClass->GetDefaultObject<AShooterProjectile>() : nullptr;
+
+	if (!ProjectileDefaults)
+	{
+		return;
+	}
+
+	// trace along the projectile direction
+	const FVector Start = ShotTransform.GetLocation();
+	const FVector End = Start + (ShotTransform.GetRotation().Vector() * HitscanRange);
+
+	// ignore the shooter and the weapon, same as a projectile ignores its instigator
+	FCollisionQueryParams QueryParams;
+	QueryParams.AddIgnoredActor(this);
+	QueryParams.AddIgnoredActor(GetOwner());
+
+	// when lag compensating, pawns are traced at their rewound location instead of their current one
+	UShooterLagCompensationSubsystem* LagCompensation = RewindTime >= 0.0f ? GetWorld()->GetSubsystem<UShooterLagCompensationSubsystem>() : nullptr;
+
+	if (LagCompensation)
+	{
+		TArray<AActor*> TrackedActors;
+		LagCompensation->GetTrackedActors(TrackedActors);
+		QueryParams.AddIgnoredActors(TrackedActors);
+	}
+
+	FHitResult OutHit;
+
+	RecordShooterSceneQueries();
+
+	// query the same object types a projectile would collide with
+	bool bHit = GetWorld()->LineTraceSingleByObjectType(OutHit, Start, End, AShooterProjectile::GetImpactObjectQueryParams(), QueryParams);
+
+	// a rewound pawn in front of the world hit takes the shot
+	if (LagCompensation)
+	{
+		FHitResult RewoundHit;
+
+		if (LagCompensation->RewindTrace(Start, bHit ? OutHit.ImpactPoint : End, RewindTime, GetOwner(), RewoundHit))
+		{
+			OutHit = RewoundHit;
+			bHit = true;
+		}
+	}
+
+	if (!bHit)
+	{
+		return;
+	}
+
+	// make AI perception noise at the impact, same as a projectile hit
+	UShooterNoiseSubsystem::MakeNoise(this, ProjectileDefaults->GetNoiseLoudness(), PawnOwner, OutHit.ImpactPoint, ProjectileDefaults->GetNoiseRange(), ProjectileDefaults->GetNoiseTag());
+
+	// apply damage and impulse through the projectile hit logic
+	ProjectileDefaults->ApplyImpact(OutHit, this);
+
+	// pass control to BP for any extra effects
+	BP_OnHitscanImpact(OutHit);
+}
+
 const TSubclassOf<UAnimInstance>& AShooterWeapon::GetFirstPersonAnimInstanceClass() const
 {
 	return FirstPersonAnimInstanceClass;
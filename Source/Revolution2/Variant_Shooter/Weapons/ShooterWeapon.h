@@ -13,6 +13,24 @@ class AShooterProjectile;
 class USkeletalMeshComponent;
 class UAnimMontage;
 class UAnimInstance;
+class UShooterWeaponNetComponent;
+struct FShooterShotRecord;
+
+/**
+ *  How shots fired by a weapon are resolved
+ */
+UENUM(BlueprintType)
+enum class EShooterFireMode : uint8
+{
+	/** Each shot is a pooled projectile actor with its own collision and movement */
+	Projectile,
+
+	/** Each shot is simulated in batch by the projectile manager. An actor is only used to resolve the impact */
+	Simulated,
+
+	/** Each shot is resolved instantly with a single trace */
+	Hitscan
+};
 
 /**
  *  Base class for a simple first person shooter weapon
@@ -42,6 +60,18 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Ammo")
 	TSubclassOf<AShooterProjectile> ProjectileClass;
 
+	/** Number of projectiles to spawn into the projectile pool ahead of time, so the first shots don't need to spawn actors */
+	UPROPERTY(EditAnywhere, Category="Ammo", meta = (ClampMin = 0, ClampMax = 200, EditCondition = "FireMode != EShooterFireMode::Hitscan"))
+	int32 ProjectilePoolPrewarmCount = 0;
+
+	/** How shots are resolved. Simulated and hitscan shots take damage, impulse and noise from the projectile class defaults */
+	UPROPERTY(EditAnywhere, Category="Ammo")
+	EShooterFireMode FireMode = EShooterFireMode::Projectile;
+
+	/** Max distance for hitscan shot traces */
+	UPROPERTY(EditAnywhere, Category="Ammo", meta = (ClampMin = 0, ClampMax = 100000, Units = "cm", EditCondition = "FireMode == EShooterFireMode::Hitscan"))
+	float HitscanRange = 10000.0f;
+
 	/** Number of bullets in a magazine */
 	UPROPERTY(EditAnywhere, Category="Ammo", meta = (ClampMin = 0, ClampMax = 100))
 	int32 MagazineSize = 10;
@@ -109,6 +139,31 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Perception")
 	FName ShotNoiseTag = FName("Shot");
 
+	/** Owner component that replicates our shots in multiplayer games */
+	TObjectPtr<UShooterWeaponNetComponent> NetComponent;
+
+	/** Server world time of the last shot accepted from the owning client */
+	float LastValidatedShotTime = -1.0f;
+
+	/** Slack allowed under the refire rate between shots sent by the owning client, to absorb network jitter */
+	UPROPERTY(EditAnywhere, Category="Refire|Replication", meta = (ClampMin = 0, ClampMax = 1, Units = "s"))
+	float RefireTolerance = 0.05f;
+
+	/** Max age of a shot sent by the owning client. Older shots are rejected */
+	UPROPERTY(EditAnywhere, Category="Refire|Replication", meta = (ClampMin = 0, ClampMax = 5, Units = "s"))
+	float MaxShotAge = 0.5f;
+
+	/** Max distance between a shot origin sent by the owning client and the owner's location on the server */
+	UPROPERTY(EditAnywhere, Category="Refire|Replication", meta = (ClampMin = 0, ClampMax = 1000, Units = "cm"))
+	float MaxShotOriginError = 150.0f;
+
+	/** Window the server counts accepted shots over. The refire rate bounds how many fit in it, whatever times the client claims */
+	UPROPERTY(EditAnywhere, Category="Refire|Replication", meta = (ClampMin = 0.1, ClampMax = 5, Units = "s"))
+	float ShotRateWindow = 1.0f;
+
+	/** Server times the shots accepted within the last window arrived at, oldest first */
+	TArray<float> AcceptedShotTimes;
+
 public:	
 
 	/** Constructor */
@@ -136,6 +191,18 @@ public:
 	/** Deactivates this weapon */
 	void DeactivateWeapon();
 
+	/** Refills the magazine, e.g. when a pooled owner is reused */
+	void RefillAmmo() { CurrentBullets = MagazineSize; }
+
+	/** Validates shots predicted by the owning client and fires the valid ones on the server. Returns the number of shots accepted */
+	int32 FireValidatedShots(const TArray<FShooterShotRecord>& Shots);
+
+	/** Replays shots fired on the server by a remote owner. Only spawns effects, damage stays with the server */
+	void FireCosmeticShots(const TArray<FShooterShotRecord>& Shots);
+
+	/** Snaps the predicted ammo count back to the server's after some shots were rejected */
+	void ReconcileAmmo(int32 ServerBullets);
+
 	/** Start firing this weapon */
 	void StartFiring();
 
@@ -153,9 +220,25 @@ protected:
 	/** Fire a projectile towards the target location */
 	virtual void FireProjectile(const FVector& TargetLocation);
 
+	/** Resolves a single shot along the given transform according to the fire mode. Hitscan shots with a rewind time are confirmed against the targets at that server time */
+	void FireShot(const FTransform& ShotTransform, float RewindTime = -1.0f);
+
+	/** Consumes a bullet, reloading the magazine when it runs out */
+	void ConsumeBullet();
+
+	/** Returns the current server world time, as estimated by this machine */
+	float GetServerWorldTime() const;
+
 	/** Calculates the spawn transform for projectiles shot by this weapon */
 	FTransform CalculateProjectileSpawnTransform(const FVector& TargetLocation) const;
 
+	/** Resolves a hitscan shot along the given projectile transform. If the rewind time is set, pawns are lag compensated to that server time */
+	virtual void FireHitscan(const FTransform& ShotTransform, float RewindTime = -1.0f);
+
+	/** Passes control to Blueprint to implement any effects on a hitscan impact, such as tracers and impact decals */
+	UFUNCTION(BlueprintImplementableEvent, Category="Weapon", meta = (DisplayName = "On Hitscan Impact"))
+	void BP_OnHitscanImpact(const FHitResult& Hit);
+
 public:
 
 	/** Returns the first person mesh */
@@ -0,0 +1,221 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterWeaponNetComponent.h"
+#include "ShooterWeapon.h"
+#include "ShooterWeaponHolder.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "Net/UnrealNetwork.h"
+#include "Revolution2.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shot Batches Sent"), STAT_ShooterShotBatches, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shots Sent"), STAT_ShooterShotsSent, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shots Rejected"), STAT_ShooterShotsRejected, STATGROUP_Shooter);
+
+UShooterWeaponNetComponent::UShooterWeaponNetComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	SetIsReplicatedByDefault(true);
+}
+
+void UShooterWeaponNetComponent::QueueShot(AShooterWeapon* Weapon, const FTransform& ShotTransform, float ShotTime)
+{
+	// standalone games have nobody to send shots to
+	if (GetNetMode() == NM_Standalone || !Weapon)
+	{
+		return;
+	}
+
+	// only the server and the owning client send shots
+	if (GetOwnerRole() < ROLE_Authority && !IsPredictingClient())
+	{
+		return;
+	}
+
+	FShooterPendingShots* Pending = PendingShots.FindByPredicate([Weapon](const FShooterPendingShots& Entry) { return Entry.WeaponClass == Weapon->GetClass(); });
+
+	if (!Pending)
+	{
+		Pending = &PendingShots.AddDefaulted_GetRef();
+		Pending->WeaponClass = Weapon->GetClass();
+	}
+
+	FShooterShotRecord& Shot = Pending->Shots.AddDefaulted_GetRef();
+	Shot.Origin = ShotTransform.GetLocation();
+	Shot.Direction = ShotTransform.GetRotation().GetForwardVector();
+	Shot.ShotTime = ShotTime;
+
+	// don't grow a batch past what the server accepts
+	if (Pending->Shots.Num() >= MaxShotsPerBatch)
+	{
+		GetWorld()->GetTimerManager().ClearTimer(FlushTimer);
+		FlushShots();
+		return;
+	}
+
+	// gather the shots fired over the batch interval into a single RPC
+	if (!GetWorld()->GetTimerManager().IsTimerActive(FlushTimer))
+	{
+		GetWorld()->GetTimerManager().SetTimer(FlushTimer, this, &UShooterWeaponNetComponent::FlushShots, FMath::Max(ShotBatchInterval, UE_KINDA_SMALL_NUMBER), false);
+	}
+}
+
+bool UShooterWeaponNetComponent::IsPredictingClient() const
+{
+	const APawn* PawnOwner = Cast<APawn>(GetOwner());
+	return PawnOwner && PawnOwner->IsLocallyControlled() && GetOwnerRole() < ROLE_Authority;
+}
+
+void UShooterWeaponNetComponent::GrantWeaponClass(TSubclassOf<AShooterWeapon> WeaponClass)
+{
+	if (GetOwnerRole() < ROLE_Authority || !WeaponClass)
+	{
+		return;
+	}
+
+	IShooterWeaponHolder* WeaponHolder = Cast<IShooterWeaponHolder>(GetOwner());
+
+	if (!WeaponHolder)
+	{
+		return;
+	}
+
+	WeaponHolder->AddWeaponClass(WeaponClass);
+
+	// clients spawn their own copy of the weapon when the grant replicates
+	GrantedWeaponClasses.AddUnique(WeaponClass);
+}
+
+void UShooterWeaponNetComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	GetWorld()->GetTimerManager().ClearTimer(FlushTimer);
+}
+
+void UShooterWeaponNetComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UShooterWeaponNetComponent, GrantedWeaponClasses);
+}
+
+void UShooterWeaponNetComponent::OnRep_GrantedWeaponClasses()
+{
+	IShooterWeaponHolder* WeaponHolder = Cast<IShooterWeaponHolder>(GetOwner());
+
+	if (!WeaponHolder)
+	{
+		return;
+	}
+
+	// weapons the owner already has are skipped by the holder
+	for (const TSubclassOf<AShooterWeapon>& WeaponClass : GrantedWeaponClasses)
+	{
+		if (WeaponClass && !FindWeapon(WeaponClass))
+		{
+			WeaponHolder->AddWeaponClass(WeaponClass);
+		}
+	}
+}
+
+void UShooterWeaponNetComponent::FlushShots()
+{
+	TArray<FShooterPendingShots> Batches = MoveTemp(PendingShots);
+	PendingShots.Reset();
+
+	const bool bIsServer = GetOwnerRole() == ROLE_Authority;
+
+	for (const FShooterPendingShots& Batch : Batches)
+	{
+		INC_DWORD_STAT(STAT_ShooterShotBatches);
+		INC_DWORD_STAT_BY(STAT_ShooterShotsSent, Batch.Shots.Num());
+
+		if (bIsServer)
+		{
+			MulticastShots(Batch.WeaponClass, Batch.Shots);
+
+		} else {
+
+			ServerFireShots(Batch.WeaponClass, Batch.Shots);
+		}
+	}
+}
+
+AShooterWeapon* UShooterWeaponNetComponent::FindWeapon(TSubclassOf<AShooterWeapon> WeaponClass) const
+{
+	// weapons attach themselves to their owner
+	TArray<AActor*> AttachedActors;
+	GetOwner()->GetAttachedActors(AttachedActors, false);
+
+	for (AActor* AttachedActor : AttachedActors)
+	{
+		if (AttachedActor->GetClass() == WeaponClass)
+		{
+			return Cast<AShooterWeapon>(AttachedActor);
+		}
+	}
+
+	return nullptr;
+}
+
+void UShooterWeaponNetComponent::ServerFireShots_Implementation(TSubclassOf<AShooterWeapon> WeaponClass, const TArray<FShooterShotRecord>& Shots)
+{
+	AShooterWeapon* Weapon = FindWeapon(WeaponClass);
+
+	if (!Weapon)
+	{
+		ClientRejectShots(WeaponClass, Shots.Num(), 0);
+		return;
+	}
+
+	// the RPC is reliable and its array unbounded, so cap the work a single call can cause
+	if (Shots.Num() > MaxShotsPerBatch)
+	{
+		UE_LOG(LogRevolution2, Warning, TEXT("Weapon net: rejected a batch of %d shots from %s, the limit is %d"), Shots.Num(), *GetNameSafe(GetOwner()), MaxShotsPerBatch);
+
+		INC_DWORD_STAT_BY(STAT_ShooterShotsRejected, Shots.Num());
+
+		ClientRejectShots(WeaponClass, Shots.Num(), Weapon->GetBulletCount());
+		return;
+	}
+
+	// fire the valid shots on the server. They're forwarded to the other clients in the next batch
+	const int32 NumRejected = Shots.Num() - Weapon->FireValidatedShots(Shots);
+
+	if (NumRejected > 0)
+	{
+		INC_DWORD_STAT_BY(STAT_ShooterShotsRejected, NumRejected);
+
+		ClientRejectShots(WeaponClass, NumRejected, Weapon->GetBulletCount());
+	}
+}
+
+void UShooterWeaponNetComponent::ClientRejectShots_Implementation(TSubclassOf<AShooterWeapon> WeaponClass, int32 NumRejected, int32 ServerBullets)
+{
+	UE_LOG(LogRevolution2, Verbose, TEXT("Weapon net: server rejected %d shots from %s"), NumRejected, *GetNameSafe(WeaponClass));
+
+	if (AShooterWeapon* Weapon = FindWeapon(WeaponClass))
+	{
+		Weapon->ReconcileAmmo(ServerBullets);
+	}
+}
+
+void UShooterWeaponNetComponent::MulticastShots_Implementation(TSubclassOf<AShooterWeapon> WeaponClass, const TArray<FShooterShotRecord>& Shots)
+{
+	// the server already fired these, and the owning client predicted them
+	const APawn* PawnOwner = Cast<APawn>(GetOwner());
+
+	if (GetOwnerRole() == ROLE_Authority || (PawnOwner && PawnOwner->IsLocallyControlled()))
+	{
+		return;
+	}
+
+	if (AShooterWeapon* Weapon = FindWeapon(WeaponClass))
+	{
+		Weapon->FireCosmeticShots(Shots);
+	}
+}
@@ -0,0 +1,118 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/NetSerialization.h"
+#include "ShooterWeaponNetComponent.generated.h"
+
+class AShooterWeapon;
+
+/**
+ *  A single shot in a replicated batch
+ */
+USTRUCT()
+struct FShooterShotRecord
+{
+	GENERATED_BODY()
+
+	/** Shot origin, rounded to the nearest centimeter */
+	UPROPERTY()
+	FVector_NetQuantize Origin;
+
+	/** Shot direction, quantized as a unit vector */
+	UPROPERTY()
+	FVector_NetQuantizeNormal Direction;
+
+	/** Server world time the shot was fired at, as estimated by the shooter */
+	UPROPERTY()
+	float ShotTime = 0.0f;
+};
+
+/**
+ *  Shots queued for the next batch for a single weapon class
+ */
+struct FShooterPendingShots
+{
+	/** Weapon that fired the shots */
+	TSubclassOf<AShooterWeapon> WeaponClass;
+
+	/** Shots fired since the last flush */
+	TArray<FShooterShotRecord> Shots;
+};
+
+/**
+ *  Replicates weapon fire for the owning pawn
+ *  Weapons exist on every machine, so shots are replicated as compact batches of origin and direction instead of one replicated projectile actor per shot.
+ *  Owning clients predict their shots and send them to the server in batches. The server validates them, fires the authoritative shots
+ *  and forwards them to the other clients, which spawn cosmetic projectiles. Rejected shots are reported back so the client can reconcile its ammo.
+ */
+UCLASS(ClassGroup=(Shooter), meta=(BlueprintSpawnableComponent))
+class REVOLUTION2_API UShooterWeaponNetComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+	/** Shots waiting for the next batch, by weapon class */
+	TArray<FShooterPendingShots> PendingShots;
+
+	/** Timer to flush the pending shots */
+	FTimerHandle FlushTimer;
+
+protected:
+
+	/** Time shots are gathered for before they're sent as one batch. Bounds the RPC rate for fast firing weapons */
+	UPROPERTY(EditAnywhere, Category="Network", meta = (ClampMin = 0, ClampMax = 0.5, Units = "s"))
+	float ShotBatchInterval = 0.05f;
+
+	/** Weapon classes the server has given the owner, such as from pickups. Each machine spawns its own copy of these weapons */
+	UPROPERTY(ReplicatedUsing = OnRep_GrantedWeaponClasses)
+	TArray<TSubclassOf<AShooterWeapon>> GrantedWeaponClasses;
+
+public:
+
+	/** Max shots in a single batch. Clients send full batches early, and the server rejects anything larger */
+	static constexpr int32 MaxShotsPerBatch = 32;
+
+	/** Constructor */
+	UShooterWeaponNetComponent();
+
+	/** Queues a shot fired by the given weapon for the next batch */
+	void QueueShot(AShooterWeapon* Weapon, const FTransform& ShotTransform, float ShotTime);
+
+	/** Returns true if shots fired locally by the owner need to be sent to the server */
+	bool IsPredictingClient() const;
+
+	/** Gives the owner a weapon on the server and replicates it to every client */
+	void GrantWeaponClass(TSubclassOf<AShooterWeapon> WeaponClass);
+
+protected:
+
+	/** Cleanup */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Set up replicated properties */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Adds the weapons granted by the server on clients */
+	UFUNCTION()
+	void OnRep_GrantedWeaponClasses();
+
+	/** Sends the pending shots. Clients send them to the server, the server forwards them to everyone else */
+	void FlushShots();
+
+	/** Returns the owner's weapon of the given class, if any */
+	AShooterWeapon* FindWeapon(TSubclassOf<AShooterWeapon> WeaponClass) const;
+
+	/** Sends a batch of predicted shots to the server for validation */
+	UFUNCTION(Server, Reliable)
+	void ServerFireShots(TSubclassOf<AShooterWeapon> WeaponClass, const TArray<FShooterShotRecord>& Shots);
+
+	/** Tells the owning client some of its shots were rejected, along with the server's ammo count */
+	UFUNCTION(Client, Reliable)
+	void ClientRejectShots(TSubclassOf<AShooterWeapon> WeaponClass, int32 NumRejected, int32 ServerBullets);
+
+	/** Sends a batch of validated shots to every client so they can spawn cosmetic projectiles */
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastShots(TSubclassOf<AShooterWeapon> WeaponClass, const TArray<FShooterShotRecord>& Shots);
+};